@@ -0,0 +1,178 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.cpp
+    Created: 18 Oct 2026 9:12:40am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+
+#if UIDESIGNER_COUNT_ALLOCATIONS
+ #if JUCE_MAC
+  #include <malloc/malloc.h>
+
+// libmalloc calls this after every allocation and free in any zone
+extern "C"
+{
+    typedef void (malloc_logger_t)(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3,
+                                   uintptr_t result, uint32_t numHotFramesToSkip);
+    extern malloc_logger_t* malloc_logger;
+}
+ #elif JUCE_WINDOWS
+  #include <crtdbg.h>
+ #endif
+
+namespace
+{
+    // Threads are never removed again, only a few ever ask for their count
+    constexpr int maxCountedThreads = 16;
+
+    struct CountedThread
+    {
+        std::atomic<juce::Thread::ThreadID> id { nullptr };
+        std::atomic<juce::uint64> allocations { 0 };
+    };
+
+    CountedThread countedThreads[maxCountedThreads];
+
+    // Called from inside the allocator, so it must neither allocate nor lock.
+    // Slots are taken in order, the first empty one ends the search.
+    CountedThread* findCountedThread(juce::Thread::ThreadID thread) noexcept
+    {
+        for (auto& counted : countedThreads)
+        {
+            const auto id = counted.id.load(std::memory_order_acquire);
+
+            if (id == thread)
+                return &counted;
+
+            if (id == nullptr)
+                break;
+        }
+
+        return nullptr;
+    }
+
+    CountedThread* addCountedThread(juce::Thread::ThreadID thread) noexcept
+    {
+        for (auto& counted : countedThreads)
+        {
+            juce::Thread::ThreadID expected = nullptr;
+
+            if (counted.id.compare_exchange_strong(expected, thread, std::memory_order_acq_rel) || expected == thread)
+                return &counted;
+        }
+
+        // More threads want counting than there are slots
+        jassertfalse;
+        return nullptr;
+    }
+
+   #if JUCE_MAC
+    // MALLOC_LOG_TYPE_ALLOCATE, set for malloc, calloc and realloc
+    constexpr uint32_t mallocLogTypeAllocate = 2;
+
+    malloc_logger_t* previousMallocLogger = nullptr;
+
+    void logMallocEvent(uint32_t type, uintptr_t arg1, uintptr_t arg2, uintptr_t arg3,
+                        uintptr_t result, uint32_t numHotFramesToSkip)
+    {
+        if ((type & mallocLogTypeAllocate) != 0)
+            AllocationCounter::noteAllocation();
+
+        if (previousMallocLogger != nullptr)
+            previousMallocLogger(type, arg1, arg2, arg3, result, numHotFramesToSkip + 1);
+    }
+   #elif JUCE_WINDOWS
+    _CRT_ALLOC_HOOK previousAllocHook = nullptr;
+
+    int __cdecl allocHook(int allocType, void* userData, size_t size, int blockType,
+                          long requestNumber, const unsigned char* fileName, int lineNumber)
+    {
+        // The CRT's own blocks have to be left alone, see _CrtSetAllocHook
+        if (allocType != _HOOK_FREE && blockType != _CRT_BLOCK)
+            AllocationCounter::noteAllocation();
+
+        if (previousAllocHook != nullptr)
+            return previousAllocHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber);
+
+        return TRUE;
+    }
+   #endif
+
+    // Installed while the plugin binary is loaded, so the hook never points
+    // into unloaded code
+    struct HeapHook
+    {
+        HeapHook()
+        {
+           #if JUCE_MAC
+            previousMallocLogger = malloc_logger;
+            malloc_logger = logMallocEvent;
+           #elif JUCE_WINDOWS
+            previousAllocHook = _CrtSetAllocHook(allocHook);
+           #endif
+        }
+
+        ~HeapHook()
+        {
+           #if JUCE_MAC
+            malloc_logger = previousMallocLogger;
+           #elif JUCE_WINDOWS
+            _CrtSetAllocHook(previousAllocHook);
+           #endif
+        }
+    };
+
+    const HeapHook heapHook;
+}
+#endif
+
+juce::uint64 AllocationCounter::getNumAllocationsOnThisThread() noexcept
+{
+   #if UIDESIGNER_COUNT_ALLOCATIONS
+    const auto thread = juce::Thread::getCurrentThreadId();
+    auto* counted = findCountedThread(thread);
+
+    if (counted == nullptr)
+        counted = addCountedThread(thread);
+
+    return counted != nullptr ? counted->allocations.load(std::memory_order_relaxed) : 0;
+   #else
+    return 0;
+   #endif
+}
+
+void AllocationCounter::noteAllocation() noexcept
+{
+   #if UIDESIGNER_COUNT_ALLOCATIONS
+    if (auto* counted = findCountedThread(juce::Thread::getCurrentThreadId()))
+        counted->allocations.fetch_add(1, std::memory_order_relaxed);
+   #endif
+}
+
+AllocationCounter::ScopedCheck::ScopedCheck(const char* scopeName) noexcept
+    : name(scopeName), allocationsAtStart(getNumAllocationsOnThisThread())
+{
+}
+
+AllocationCounter::ScopedCheck::~ScopedCheck()
+{
+    auto allocations = getNumAllocationsOnThisThread() - allocationsAtStart;
+
+    if (allocations != 0)
+    {
+        DBG(juce::String(allocations) + " heap allocation(s) in " + name);
+        jassertfalse;
+    }
+}
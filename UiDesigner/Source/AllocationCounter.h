@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    AllocationCounter.h
+    Created: 18 Oct 2026 9:12:40am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// AllocationCounter.h
+#pragma once
+#include <JuceHeader.h>
+
+// Hooks the C runtime's heap so that allocations can be counted, including
+// those juce::HeapBlock (and with it juce::Array, juce::Path and juce::String)
+// makes with std::malloc and std::realloc. On macOS this is the malloc logger,
+// on Windows the debug CRT's allocation hook, so counting needs the debug CRT
+// there. Enabled in debug builds by default, define
+// UIDESIGNER_COUNT_ALLOCATIONS=0/1 in the Projucer preprocessor definitions
+// to override.
+#ifndef UIDESIGNER_COUNT_ALLOCATIONS
+ #if JUCE_DEBUG && (JUCE_MAC || (JUCE_WINDOWS && defined (_DEBUG)))
+  #define UIDESIGNER_COUNT_ALLOCATIONS 1
+ #else
+  #define UIDESIGNER_COUNT_ALLOCATIONS 0
+ #endif
+#endif
+
+// Per-thread count of heap allocations: malloc, calloc, realloc and
+// everything built on them, such as operator new.
+//
+// Only threads that have asked for their count are counted, from the first
+// call on, so the hook never has to create per-thread state itself.
+class AllocationCounter
+{
+public:
+    static constexpr bool isEnabled() { return UIDESIGNER_COUNT_ALLOCATIONS != 0; }
+
+    // Number of allocations made by the calling thread since it first called
+    // this. Always returns 0 when counting is compiled out.
+    static juce::uint64 getNumAllocationsOnThisThread() noexcept;
+
+    // Called by the heap hooks
+    static void noteAllocation() noexcept;
+
+    // Asserts in debug builds if the enclosing scope allocates on this thread.
+    // Used on the interaction hot path, which has to stay allocation free.
+    class ScopedCheck
+    {
+    public:
+        explicit ScopedCheck(const char* scopeName) noexcept;
+        ~ScopedCheck();
+
+    private:
+        const char* name;
+        juce::uint64 allocationsAtStart;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedCheck)
+    };
+};
+
+#define UIDESIGNER_ASSERT_NO_ALLOCATIONS(scopeName) AllocationCounter::ScopedCheck JUCE_JOIN_MACRO(allocationCheck_, __LINE__)(scopeName)
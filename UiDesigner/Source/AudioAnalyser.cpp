@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.cpp
+    Created: 18 Oct 2026 9:05:47pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "AudioAnalyser.h"
+
+AudioAnalyser::AudioAnalyser()
+    : levelBuffer((size_t) levelFifoSize),
+      sampleBuffer((size_t) sampleFifoSize),
+      spectrumBuffer((size_t) spectrumFifoSize),
+      fftInput((size_t) fftSize),
+      fftData((size_t) fftSize * 2)     // the frequency-only transform works in place on twice the size
+{
+}
+
+void AudioAnalyser::prepare(double)
+{
+    // Leftovers from before would be glued onto the new stream
+    fftInputSize = 0;
+}
+
+//==================================================================
+
+void AudioAnalyser::process(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    numChannels = juce::jmin(numChannels, buffer.getNumChannels());
+
+    if (numChannels <= 0 || buffer.getNumSamples() <= 0)
+        return;
+
+    pushLevels(buffer, numChannels);
+    pushScope(buffer, numChannels);
+    addToFft(buffer, numChannels);
+}
+
+float AudioAnalyser::getSumOfSquares(const float* samples, int numSamples)
+{
+    using Register = juce::dsp::SIMDRegister<float>;
+
+    // Scalar up to the first aligned sample, then whole registers, then the rest
+    auto* aligned = Register::getNextSIMDAlignedPtr(const_cast<float*>(samples));
+    const int head = juce::jmin(numSamples, (int) (aligned - samples));
+    float sum = 0.0f;
+    int i = 0;
+
+    for (; i < head; ++i)
+        sum += samples[i] * samples[i];
+
+    auto registerSum = Register::expand(0.0f);
+
+    for (; i + (int) Register::size() <= numSamples; i += (int) Register::size())
+    {
+        auto values = Register::fromRawArray(samples + i);
+        registerSum += values * values;
+    }
+
+    sum += registerSum.sum();
+
+    for (; i < numSamples; ++i)
+        sum += samples[i] * samples[i];
+
+    return sum;
+}
+
+void AudioAnalyser::mixToMono(float* dest, const juce::AudioBuffer<float>& buffer, int numChannels,
+                              int startSample, int numSamples)
+{
+    const float gain = 1.0f / (float) numChannels;
+    juce::FloatVectorOperations::copyWithMultiply(dest, buffer.getReadPointer(0, startSample), gain, numSamples);
+
+    for (int channel = 1; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::addWithMultiply(dest, buffer.getReadPointer(channel, startSample), gain, numSamples);
+}
+
+void AudioAnalyser::pushLevels(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    const int numSamples = buffer.getNumSamples();
+    BlockLevels levels;
+    levels.numSamples = numSamples * numChannels;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        auto* samples = buffer.getReadPointer(channel);
+        auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+        levels.peak = juce::jmax(levels.peak, -range.getStart(), range.getEnd());
+        levels.sumOfSquares += getSumOfSquares(samples, numSamples);
+    }
+
+    if (levelFifo.getFreeSpace() < 1)
+        return;
+
+    const auto writer = levelFifo.write(1);
+    levelBuffer[(size_t) writer.startIndex1] = levels;
+}
+
+void AudioAnalyser::pushScope(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    // The scope only ever shows the latest samples, so a full FIFO drops the whole block
+    const int numSamples = buffer.getNumSamples();
+
+    if (sampleFifo.getFreeSpace() < numSamples)
+        return;
+
+    const auto writer = sampleFifo.write(numSamples);
+
+    if (writer.blockSize1 > 0)
+        mixToMono(sampleBuffer.data() + writer.startIndex1, buffer, numChannels, 0, writer.blockSize1);
+
+    if (writer.blockSize2 > 0)
+        mixToMono(sampleBuffer.data() + writer.startIndex2, buffer, numChannels, writer.blockSize1, writer.blockSize2);
+}
+
+void AudioAnalyser::addToFft(const juce::AudioBuffer<float>& buffer, int numChannels)
+{
+    int position = 0;
+
+    while (position < buffer.getNumSamples())
+    {
+        const int numToCopy = juce::jmin(buffer.getNumSamples() - position, fftSize - fftInputSize);
+        mixToMono(fftInput.data() + fftInputSize, buffer, numChannels, position, numToCopy);
+        fftInputSize += numToCopy;
+        position += numToCopy;
+
+        if (fftInputSize == fftSize)
+        {
+            pushSpectrum();
+
+            // Half overlap, so a transient isn't lost at the edge of the window
+            std::copy(fftInput.begin() + numBins, fftInput.end(), fftInput.begin());
+            fftInputSize = numBins;
+        }
+    }
+}
+
+void AudioAnalyser::pushSpectrum()
+{
+    if (spectrumFifo.getFreeSpace() < 1)
+        return;
+
+    std::copy(fftInput.begin(), fftInput.end(), fftData.begin());
+    window.multiplyWithWindowingTable(fftData.data(), (size_t) fftSize);
+
+    // At this size the transform's scratch space lives on the stack
+    fft.performFrequencyOnlyForwardTransform(fftData.data());
+
+    const auto writer = spectrumFifo.write(1);
+    auto& frame = spectrumBuffer[(size_t) writer.startIndex1];
+
+    // Full-scale sine == 1 after the Hann window's gain of one half
+    juce::FloatVectorOperations::copyWithMultiply(frame.data(), fftData.data(), 4.0f / (float) fftSize, numBins);
+}
+
+//==================================================================
+
+bool AudioAnalyser::collect()
+{
+    bool changed = false;
+
+    // Levels: everything since the last frame counts as one measurement
+    if (levelFifo.getNumReady() > 0)
+    {
+        float peak = 0.0f;
+        float sumOfSquares = 0.0f;
+        int numSamples = 0;
+
+        const auto reader = levelFifo.read(levelFifo.getNumReady());
+        reader.forEach([&](int index)
+        {
+            const auto& levels = levelBuffer[(size_t) index];
+            peak = juce::jmax(peak, levels.peak);
+            sumOfSquares += levels.sumOfSquares;
+            numSamples += levels.numSamples;
+        });
+
+        displayPeak = juce::jmax(peak, displayPeak * levelDecay);
+        displayRms = juce::jmax(std::sqrt(sumOfSquares / (float) juce::jmax(1, numSamples)), displayRms * levelDecay);
+        changed = true;
+    }
+    else if (displayPeak > 0.0f)
+    {
+        // Playback stopped, let the meter fall
+        displayPeak = displayPeak * levelDecay < 1.0e-4f ? 0.0f : displayPeak * levelDecay;
+        displayRms = displayRms * levelDecay < 1.0e-4f ? 0.0f : displayRms * levelDecay;
+        changed = true;
+    }
+
+    // Scope: only the latest scopeSize samples are kept
+    if (const int numReady = sampleFifo.getNumReady(); numReady > 0)
+    {
+        const int numNew = juce::jmin(numReady, scopeSize);
+        std::copy(scope.begin() + numNew, scope.end(), scope.begin());
+
+        const auto reader = sampleFifo.read(numReady);
+        int destIndex = scopeSize - numNew;
+        int skip = numReady - numNew;
+
+        reader.forEach([&](int index)
+        {
+            if (skip > 0)
+                --skip;
+            else
+                scope[(size_t) destIndex++] = sampleBuffer[(size_t) index];
+        });
+
+        changed = true;
+    }
+
+    // Spectrum: the newest frame, on a decibel scale
+    if (const int numReady = spectrumFifo.getNumReady(); numReady > 0)
+    {
+        const auto reader = spectrumFifo.read(numReady);
+        const int newest = reader.blockSize2 > 0 ? reader.startIndex2 + reader.blockSize2 - 1
+                                                 : reader.startIndex1 + reader.blockSize1 - 1;
+        const auto& frame = spectrumBuffer[(size_t) newest];
+
+        for (int i = 0; i < numBins; ++i)
+        {
+            const auto level = juce::jmap(juce::Decibels::gainToDecibels(frame[(size_t) i], minDecibels), minDecibels, 0.0f, 0.0f, 1.0f);
+            spectrum[(size_t) i] = juce::jmax(level, spectrum[(size_t) i] * spectrumDecay);
+        }
+
+        changed = true;
+    }
+
+    return changed;
+}
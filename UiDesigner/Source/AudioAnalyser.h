@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    AudioAnalyser.h
+    Created: 18 Oct 2026 9:05:47pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// AudioAnalyser.h
+#pragma once
+#include <JuceHeader.h>
+
+// Measures the plugin's output for the meter, scope and spectrum shapes.
+//
+// process() runs on the audio thread: it reduces each block to peak and RMS
+// with vector operations, collects the mono signal for the scope and runs a
+// windowed FFT every half FFT length. The results go into single-producer,
+// single-consumer FIFOs. All memory is allocated in the constructor, and when
+// a FIFO is full the new data is dropped, so the audio thread never waits.
+//
+// collect() runs on the message thread once per display frame. It drains the
+// FIFOs and keeps what the shapes draw, with some decay so the display
+// doesn't flicker.
+class AudioAnalyser
+{
+public:
+    static constexpr int fftOrder = 10;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2;
+    static constexpr int scopeSize = 512;
+
+    AudioAnalyser();
+
+    // Called from prepareToPlay, while process() isn't running
+    void prepare(double newSampleRate);
+
+    // Audio thread only
+    void process(const juce::AudioBuffer<float>& buffer, int numChannels);
+
+    // Message thread only. Returns true if the display has changed.
+    bool collect();
+
+    float getPeak() const { return displayPeak; }
+    float getRms() const { return displayRms; }
+
+    // Mono samples, oldest first
+    const std::array<float, scopeSize>& getScope() const { return scope; }
+
+    // Bin levels from 0 (minDecibels and below) to 1 (full scale)
+    const std::array<float, numBins>& getSpectrum() const { return spectrum; }
+
+private:
+    struct BlockLevels
+    {
+        float peak = 0.0f;
+        float sumOfSquares = 0.0f;
+        int numSamples = 0;
+    };
+
+    using SpectrumFrame = std::array<float, numBins>;
+
+    static constexpr int levelFifoSize = 1024;     // a few frames' worth of 32-sample blocks
+    static constexpr int sampleFifoSize = 8192;
+    static constexpr int spectrumFifoSize = 4;
+    static constexpr float minDecibels = -90.0f;
+    static constexpr float levelDecay = 0.85f;     // per display frame
+    static constexpr float spectrumDecay = 0.7f;
+
+    static float getSumOfSquares(const float* samples, int numSamples);
+
+    // Writes the average of the channels to dest
+    static void mixToMono(float* dest, const juce::AudioBuffer<float>& buffer, int numChannels,
+                          int startSample, int numSamples);
+
+    void pushLevels(const juce::AudioBuffer<float>& buffer, int numChannels);
+    void pushScope(const juce::AudioBuffer<float>& buffer, int numChannels);
+    void addToFft(const juce::AudioBuffer<float>& buffer, int numChannels);
+    void pushSpectrum();
+
+    // Shared, each written by one side only
+    juce::AbstractFifo levelFifo { levelFifoSize };
+    std::vector<BlockLevels> levelBuffer;
+    juce::AbstractFifo sampleFifo { sampleFifoSize };
+    std::vector<float> sampleBuffer;
+    juce::AbstractFifo spectrumFifo { spectrumFifoSize };
+    std::vector<SpectrumFrame> spectrumBuffer;
+
+    // Audio thread
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann };
+    std::vector<float> fftInput;
+    std::vector<float> fftData;
+    int fftInputSize = 0;
+
+    // Message thread
+    float displayPeak = 0.0f;
+    float displayRms = 0.0f;
+    std::array<float, scopeSize> scope {};
+    std::array<float, numBins> spectrum {};
+
+    JUCE_DECLARE_NON_COPYABLE(AudioAnalyser)
+};
@@ -0,0 +1,213 @@
+/*
+  ==============================================================================
+
+    BackgroundRenderer.cpp
+    Created: 18 Oct 2026 4:05:37pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "BackgroundRenderer.h"
+#include "TraceRecorder.h"
+
+bool BackgroundRenderer::View::operator==(const View& other) const
+{
+    return bounds == other.bounds
+        && viewScale == other.viewScale
+        && viewOffset == other.viewOffset
+        && pixelScale == other.pixelScale;
+}
+
+BackgroundRenderer::BackgroundRenderer()
+    : juce::Thread("Render")
+{
+}
+
+BackgroundRenderer::~BackgroundRenderer()
+{
+    // Rendering checks for this between chunks, so it never takes long
+    stopThread(2000);
+}
+
+void BackgroundRenderer::requestFrame(std::shared_ptr<const RenderSource> source, juce::Rectangle<int> bounds,
+                                      float viewScale, juce::Point<int> viewOffset, float pixelScale)
+{
+    const View view { bounds, viewScale, viewOffset, pixelScale };
+
+    if (source == lastRequest.source && view == lastRequest.view)
+        return;
+
+    lastRequest.source = std::move(source);
+    lastRequest.view = view;
+    lastRequest.generation = generation.load();
+    ++lastRequest.id;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+        pendingRequest = lastRequest;
+    }
+
+    if (!isThreadRunning())
+        startThread();
+
+    notify();
+}
+
+bool BackgroundRenderer::collectFinishedFrame()
+{
+    return frameFinished.exchange(false);
+}
+
+void BackgroundRenderer::draw(juce::Graphics& g, float viewScale, juce::Point<int> viewOffset)
+{
+    UIDESIGNER_TRACE_SCOPE("BackgroundRenderer::draw");
+
+    const juce::ScopedLock sl(presentLock);
+
+    if (frontBuffer < 0)
+        return;
+
+    auto& buffer = buffers[frontBuffer];
+    const auto& view = buffer.view;
+
+    // Image pixels to the component as it was, back to the document and out
+    // through the current view. Unless the view changed this is a plain blit.
+    auto transform = juce::AffineTransform::scale(1.0f / view.pixelScale)
+                         .translated(view.bounds.getPosition().toFloat())
+                         .translated(-view.viewOffset.toFloat())
+                         .scaled(viewScale / view.viewScale)
+                         .translated(viewOffset.toFloat());
+
+    g.drawImageTransformed(buffer.image, transform);
+}
+
+void BackgroundRenderer::clear()
+{
+    ++generation;
+
+    {
+        const juce::ScopedLock sl(requestLock);
+        pendingRequest = {};
+    }
+
+    lastRequest.source = nullptr;
+
+    const juce::ScopedLock sl(presentLock);
+    frontBuffer = -1;
+    frameFinished = false;
+}
+
+BackgroundRenderer::Statistics BackgroundRenderer::getStatistics() const
+{
+    Statistics stats;
+    stats.framesPresented = framesPresented.load();
+    stats.lastFrameMs = lastFrameMs.load();
+
+    const juce::ScopedLock sl(presentLock);
+    stats.upToDate = frontBuffer >= 0 && buffers[frontBuffer].requestId == lastRequest.id;
+    return stats;
+}
+
+bool BackgroundRenderer::hasFrameOf(const RenderSource* source, juce::Rectangle<int> bounds,
+                                    float viewScale, juce::Point<int> viewOffset, float pixelScale) const
+{
+    if (source == nullptr || lastRequest.source.get() != source
+        || !(lastRequest.view == View { bounds, viewScale, viewOffset, pixelScale }))
+        return false;
+
+    return getStatistics().upToDate;
+}
+
+void BackgroundRenderer::run()
+{
+    while (!threadShouldExit())
+    {
+        Request request;
+        {
+            const juce::ScopedLock sl(requestLock);
+            std::swap(request, pendingRequest);
+        }
+
+        if (request.source == nullptr)
+        {
+            wait(-1);
+            continue;
+        }
+
+        int backBuffer;
+        {
+            const juce::ScopedLock sl(presentLock);
+            backBuffer = frontBuffer == 0 ? 1 : 0;
+        }
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+
+        if (!renderFrame(request, buffers[backBuffer]))
+            break;
+
+        {
+            // clear() takes this lock too, so a frame from before it can't
+            // slip in afterwards
+            const juce::ScopedLock sl(presentLock);
+
+            if (isCleared(request))
+                continue;
+
+            frontBuffer = backBuffer;
+        }
+
+        lastFrameMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+
+        ++framesPresented;
+        frameFinished = true;
+    }
+}
+
+bool BackgroundRenderer::renderFrame(const Request& request, Buffer& buffer)
+{
+    UIDESIGNER_TRACE_SCOPE("BackgroundRenderer::renderFrame");
+
+    const auto& view = request.view;
+    const int width = juce::jmax(1, juce::roundToInt(view.bounds.getWidth() * view.pixelScale));
+    const int height = juce::jmax(1, juce::roundToInt(view.bounds.getHeight() * view.pixelScale));
+
+    // Software images, since they're drawn into away from the message thread
+    if (buffer.image.getWidth() != width || buffer.image.getHeight() != height)
+        buffer.image = juce::Image(juce::Image::RGB, width, height, false, juce::SoftwareImageType());
+
+    buffer.view = view;
+    buffer.requestId = request.id;
+
+    const RasterTarget target { buffer.image, juce::AffineTransform::scale(view.viewScale)
+                                                  .translated(view.viewOffset.toFloat() - view.bounds.getPosition().toFloat())
+                                                  .scaled(view.pixelScale) };
+
+    juce::Graphics g(buffer.image);
+    g.fillAll(juce::Colours::white);
+    g.addTransform(target.documentToImage);
+
+    const int numItems = request.source->getNumItems();
+
+    for (int begin = 0; begin < numItems; begin += itemsPerChunk)
+    {
+        if (threadShouldExit())
+            return false;
+
+        // Not worth finishing, it won't be shown
+        if (isCleared(request))
+            return true;
+
+        request.source->renderRange(g, view.viewScale, arena, begin, juce::jmin(numItems, begin + itemsPerChunk), &target);
+        arena.reset();
+    }
+
+    return true;
+}
@@ -0,0 +1,123 @@
+/*
+  ==============================================================================
+
+    BackgroundRenderer.h
+    Created: 18 Oct 2026 4:05:37pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// BackgroundRenderer.h
+#pragma once
+#include <JuceHeader.h>
+#include "RenderSource.h"
+
+// Rasterizes the document on a dedicated thread, so the message thread (which
+// a plugin shares with the host) never draws shapes itself.
+//
+// The owner requests frames from paint() with a snapshot and the current view.
+// The thread renders the newest request into one of two images while paint()
+// blits the other one, the last completed frame. When the view has moved on
+// since that frame was rendered, it is drawn scaled and offset to match until
+// a new one arrives. Requests that pile up while the thread is busy are
+// dropped except for the latest.
+class BackgroundRenderer : private juce::Thread
+{
+public:
+    struct Statistics
+    {
+        int framesPresented = 0;
+        double lastFrameMs = 0.0;
+        bool upToDate = false;      // the frame on screen is the one last requested
+    };
+
+    BackgroundRenderer();
+    ~BackgroundRenderer() override;
+
+    // Asks for a frame of the document as seen through the view. Does nothing
+    // if it matches the previous request.
+    void requestFrame(std::shared_ptr<const RenderSource> source, juce::Rectangle<int> bounds,
+                      float viewScale, juce::Point<int> viewOffset, float pixelScale);
+
+    // Returns true once for every frame completed since the last call, in
+    // which case the owner should repaint
+    bool collectFinishedFrame();
+
+    // Draws the latest completed frame in component coordinates
+    void draw(juce::Graphics& g, float viewScale, juce::Point<int> viewOffset);
+
+    // Forgets the frames and any pending request. A frame that is being
+    // rendered right now is dropped when it's done.
+    void clear();
+
+    Statistics getStatistics() const;
+
+    // True if the latest completed frame shows this source through this view
+    bool hasFrameOf(const RenderSource* source, juce::Rectangle<int> bounds,
+                    float viewScale, juce::Point<int> viewOffset, float pixelScale) const;
+
+private:
+    struct View
+    {
+        juce::Rectangle<int> bounds;
+        float viewScale = 1.0f;
+        juce::Point<int> viewOffset;
+        float pixelScale = 1.0f;
+
+        bool operator==(const View& other) const;
+    };
+
+    struct Request
+    {
+        std::shared_ptr<const RenderSource> source;
+        View view;
+        juce::uint32 id = 0;
+        juce::uint32 generation = 0;    // see clear()
+    };
+
+    struct Buffer
+    {
+        juce::Image image;
+        View view;
+        juce::uint32 requestId = 0;
+    };
+
+    // Items drawn between checks for shutdown
+    static constexpr int itemsPerChunk = 1024;
+
+    void run() override;
+    bool renderFrame(const Request& request, Buffer& buffer);
+    bool isCleared(const Request& request) const { return request.generation != generation.load(); }
+
+    // Message thread only
+    Request lastRequest;
+
+    juce::CriticalSection requestLock;
+    Request pendingRequest;
+
+    // The render thread writes to the back buffer without a lock. Only it
+    // changes which buffer is at the front, and it does that under the lock
+    // that draw() holds while blitting.
+    juce::CriticalSection presentLock;
+    Buffer buffers[2];
+    int frontBuffer = -1;
+
+    // Bumped by clear(), frames requested before that are never presented
+    std::atomic<juce::uint32> generation { 0 };
+
+    std::atomic<bool> frameFinished { false };
+    std::atomic<int> framesPresented { 0 };
+    std::atomic<double> lastFrameMs { 0.0 };
+
+    FrameArena arena;   // render thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(BackgroundRenderer)
+};
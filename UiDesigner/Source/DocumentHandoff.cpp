@@ -0,0 +1,66 @@
+/*
+  ==============================================================================
+
+    DocumentHandoff.cpp
+    Created: 18 Oct 2026 6:37:15pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "DocumentHandoff.h"
+#include "SceneRenderer.h"
+
+DocumentHandoff::~DocumentHandoff()
+{
+    // Nobody may still be reading when the owner goes away
+    jassert(activeReaders.load() == 0);
+}
+
+void DocumentHandoff::publish(std::shared_ptr<const DocumentSnapshot> document)
+{
+    std::vector<std::shared_ptr<const DocumentSnapshot>> unreachable;
+
+    {
+        const juce::SpinLock::ScopedLockType sl(writeLock);
+
+        current.store(document.get());
+
+        if (latest != nullptr)
+            retired.push_back(std::move(latest));
+
+        latest = std::move(document);
+
+        // All operations are sequentially consistent: a reader that isn't
+        // counted yet will load the new pointer
+        if (activeReaders.load() == 0)
+            std::swap(unreachable, retired);
+    }
+
+    // Old versions can be large, so they're freed outside the lock
+}
+
+std::shared_ptr<const DocumentSnapshot> DocumentHandoff::getLatest() const
+{
+    const juce::SpinLock::ScopedLockType sl(writeLock);
+    return latest;
+}
+
+DocumentHandoff::ScopedReader::ScopedReader(const DocumentHandoff& handoff)
+    : owner(handoff)
+{
+    owner.activeReaders.fetch_add(1);
+    document = owner.current.load();
+}
+
+DocumentHandoff::ScopedReader::~ScopedReader()
+{
+    owner.activeReaders.fetch_sub(1);
+}
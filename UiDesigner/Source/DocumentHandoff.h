@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    DocumentHandoff.h
+    Created: 18 Oct 2026 6:37:15pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// DocumentHandoff.h
+#pragma once
+#include <JuceHeader.h>
+
+class DocumentSnapshot;
+
+// Passes finished, immutable versions of the document from the editor to the
+// processor, where the host may read them at any time and on any thread.
+//
+// Publishing swaps an atomic pointer. Readers register themselves with a
+// counter, load the pointer and never wait. A replaced version is kept
+// until a later publish sees no readers left, since none that start after
+// the swap can reach it any more.
+class DocumentHandoff
+{
+public:
+    DocumentHandoff() = default;
+    ~DocumentHandoff();
+
+    // Makes document the latest version. Writers (the editor, and the host
+    // restoring state) are serialised among themselves, readers aren't held up.
+    void publish(std::shared_ptr<const DocumentSnapshot> document);
+
+    // The latest version, for the writing side
+    std::shared_ptr<const DocumentSnapshot> getLatest() const;
+
+    // Lock-free access to the latest version from any thread. The document
+    // stays valid for as long as the reader exists.
+    class ScopedReader
+    {
+    public:
+        explicit ScopedReader(const DocumentHandoff& handoff);
+        ~ScopedReader();
+
+        const DocumentSnapshot* get() const { return document; }
+
+    private:
+        const DocumentHandoff& owner;
+        const DocumentSnapshot* document;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedReader)
+    };
+
+private:
+    std::atomic<const DocumentSnapshot*> current { nullptr };
+    mutable std::atomic<int> activeReaders { 0 };
+
+    mutable juce::SpinLock writeLock;
+    std::shared_ptr<const DocumentSnapshot> latest;
+    std::vector<std::shared_ptr<const DocumentSnapshot>> retired;
+
+    JUCE_DECLARE_NON_COPYABLE(DocumentHandoff)
+};
@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    DocumentSerializer.cpp
+    Created: 18 Oct 2026 6:58:40pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "DocumentSerializer.h"
+
+std::unique_ptr<juce::XmlElement> DocumentSerializer::toXml(const DocumentSnapshot& document)
+{
+    auto xml = std::make_unique<juce::XmlElement>("UIDESIGNER_DOCUMENT");
+    xml->setAttribute("version", currentVersion);
+
+    auto* symbolsElement = xml->createNewChildElement("SYMBOLS");
+    const auto& symbols = document.getSymbols();
+
+    for (auto symbolId : symbols.getSymbolIds())
+    {
+        auto* symbol = symbols.getSymbol(symbolId);
+        auto* symbolElement = symbolsElement->createNewChildElement("SYMBOL");
+        symbolElement->setAttribute("id", symbolId);
+        symbolElement->setAttribute("frame", symbol->frame.toString());
+        writeShapes(*symbolElement, symbol->shapes);
+    }
+
+    auto* shapesElement = xml->createNewChildElement("SHAPES");
+
+    for (auto& chunk : document.getChunks())
+        writeShapes(*shapesElement, *chunk);
+
+    return xml;
+}
+
+std::shared_ptr<const DocumentSnapshot> DocumentSerializer::fromXml(const juce::XmlElement& xml)
+{
+    if (!xml.hasTagName("UIDESIGNER_DOCUMENT") || xml.getIntAttribute("version") > currentVersion)
+        return nullptr;
+
+    SymbolLibrary symbols;
+
+    if (auto* symbolsElement = xml.getChildByName("SYMBOLS"))
+    {
+        for (auto* symbolElement : symbolsElement->getChildWithTagNameIterator("SYMBOL"))
+        {
+            symbols.restoreSymbol(symbolElement->getIntAttribute("id"),
+                                  readShapes(*symbolElement),
+                                  juce::Rectangle<float>::fromString(symbolElement->getStringAttribute("frame")));
+        }
+    }
+
+    juce::Array<Shape> shapes;
+
+    if (auto* shapesElement = xml.getChildByName("SHAPES"))
+        shapes = readShapes(*shapesElement);
+
+    return std::make_shared<const DocumentSnapshot>(std::move(shapes), std::move(symbols));
+}
+
+void DocumentSerializer::writeShapes(juce::XmlElement& parent, const juce::Array<Shape>& shapes)
+{
+    for (auto& shape : shapes)
+        writeShape(parent, shape);
+}
+
+juce::Array<DocumentSerializer::Shape> DocumentSerializer::readShapes(const juce::XmlElement& parent)
+{
+    juce::Array<Shape> shapes;
+
+    for (auto* element : parent.getChildWithTagNameIterator("SHAPE"))
+        shapes.add(readShape(*element));
+
+    return shapes;
+}
+
+void DocumentSerializer::writeShape(juce::XmlElement& parent, const Shape& shape)
+{
+    using Tool = MainComponent::Tool;
+
+    auto* element = parent.createNewChildElement("SHAPE");
+    element->setAttribute("type", (int) shape.type);
+    element->setAttribute("bounds", shape.bounds.toString());
+
+    if (shape.rotation != 0.0f)
+    {
+        element->setAttribute("rotation", shape.rotation);
+        element->setAttribute("rotationCentreX", shape.rotationCenter.x);
+        element->setAttribute("rotationCentreY", shape.rotationCenter.y);
+    }
+
+    if (shape.type == Tool::Line)
+    {
+        element->setAttribute("x1", shape.lineStart.x);
+        element->setAttribute("y1", shape.lineStart.y);
+        element->setAttribute("x2", shape.lineEnd.x);
+        element->setAttribute("y2", shape.lineEnd.y);
+    }
+    else if (shape.type == Tool::Text)
+    {
+        element->setAttribute("text", shape.text);
+    }
+    else if (shape.type == Tool::Instance)
+    {
+        element->setAttribute("symbol", shape.symbolId);
+    }
+    else if (shape.type == Tool::Freehand && shape.points != nullptr)
+    {
+        element->setAttribute("points", writePoints(*shape.points));
+    }
+    else if (shape.type == Tool::Image)
+    {
+        element->setAttribute("image", shape.imageFile);
+    }
+
+    if (shape.control != MainComponent::ControlType::None)
+    {
+        element->setAttribute("control", (int) shape.control);
+        element->setAttribute("parameter", shape.parameterIndex);
+    }
+
+    const auto& style = *shape.style;
+    element->setAttribute("fill", style.fillColour.toString());
+    element->setAttribute("stroke", style.strokeColour.toString());
+    element->setAttribute("strokeWidth", style.strokeWidth);
+    element->setAttribute("strokePattern", (int) style.strokePattern);
+    element->setAttribute("hasFill", style.hasFill);
+    element->setAttribute("cornerRadius", style.cornerRadius);
+    element->setAttribute("fontSize", style.fontSize);
+    element->setAttribute("fontFamily", style.fontFamily);
+    element->setAttribute("stretchText", style.textStretchEnabled);
+}
+
+DocumentSerializer::Shape DocumentSerializer::readShape(const juce::XmlElement& element)
+{
+    using Tool = MainComponent::Tool;
+    using StrokePattern = MainComponent::StrokePattern;
+    using ControlType = MainComponent::ControlType;
+
+    Shape shape;
+    shape.type = (Tool) juce::jlimit((int) Tool::Rectangle, (int) Tool::Image, element.getIntAttribute("type"));
+    shape.bounds = juce::Rectangle<float>::fromString(element.getStringAttribute("bounds"));
+    shape.rotation = (float) element.getDoubleAttribute("rotation");
+    shape.lineStart = { (float) element.getDoubleAttribute("x1"), (float) element.getDoubleAttribute("y1") };
+    shape.lineEnd = { (float) element.getDoubleAttribute("x2"), (float) element.getDoubleAttribute("y2") };
+    shape.text = element.getStringAttribute("text");
+    shape.symbolId = element.getIntAttribute("symbol", -1);
+
+    shape.imageFile = element.getStringAttribute("image");
+
+    if (shape.type == Tool::Freehand)
+        shape.points = readPoints(element.getStringAttribute("points"));
+    shape.control = (ControlType) juce::jlimit((int) ControlType::None, (int) ControlType::Toggle,
+                                               element.getIntAttribute("control"));
+    shape.parameterIndex = shape.control != ControlType::None ? element.getIntAttribute("parameter", -1) : -1;
+
+    if (shape.rotation != 0.0f)
+        shape.rotationCenter = { (float) element.getDoubleAttribute("rotationCentreX"),
+                                 (float) element.getDoubleAttribute("rotationCentreY") };
+    else
+        shape.initializeRotationCenter();
+
+    MainComponent::Style style;
+    style.fillColour = juce::Colour::fromString(element.getStringAttribute("fill"));
+    style.strokeColour = juce::Colour::fromString(element.getStringAttribute("stroke"));
+    style.strokeWidth = (float) element.getDoubleAttribute("strokeWidth");
+    style.strokePattern = (StrokePattern) juce::jlimit((int) StrokePattern::Solid, (int) StrokePattern::DashDot,
+                                                       element.getIntAttribute("strokePattern"));
+    style.hasFill = element.getBoolAttribute("hasFill");
+    style.cornerRadius = (float) element.getDoubleAttribute("cornerRadius");
+    style.fontSize = (float) element.getDoubleAttribute("fontSize", 14.0);
+    style.fontFamily = element.getStringAttribute("fontFamily", "Arial");
+    style.textStretchEnabled = element.getBoolAttribute("stretchText");
+    shape.style = style;
+
+    return shape;
+}
+
+juce::String DocumentSerializer::writePoints(const juce::Array<juce::Point<float>>& points)
+{
+    // Relative to the bounds, so four decimals are well below a pixel
+    juce::String text;
+    text.preallocateBytes((size_t) points.size() * 14);
+
+    for (auto& point : points)
+    {
+        if (text.isNotEmpty())
+            text << ' ';
+
+        text << juce::String(point.x, 4) << ' ' << juce::String(point.y, 4);
+    }
+
+    return text;
+}
+
+std::shared_ptr<const juce::Array<juce::Point<float>>> DocumentSerializer::readPoints(const juce::String& text)
+{
+    const auto values = juce::StringArray::fromTokens(text, false);
+    juce::Array<juce::Point<float>> points;
+    points.ensureStorageAllocated(values.size() / 2);
+
+    for (int i = 0; i + 1 < values.size(); i += 2)
+        points.add({ values[i].getFloatValue(), values[i + 1].getFloatValue() });
+
+    return std::make_shared<const juce::Array<juce::Point<float>>>(std::move(points));
+}
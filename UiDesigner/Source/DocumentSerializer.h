@@ -0,0 +1,43 @@
+/*
+  ==============================================================================
+
+    DocumentSerializer.h
+    Created: 18 Oct 2026 6:58:40pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// DocumentSerializer.h
+#pragma once
+#include <JuceHeader.h>
+#include "SceneRenderer.h"
+
+// Converts documents to and from the XML stored in the plugin state
+class DocumentSerializer
+{
+public:
+    using Shape = MainComponent::Shape;
+
+    static std::unique_ptr<juce::XmlElement> toXml(const DocumentSnapshot& document);
+
+    // Returns nullptr if the XML isn't a document
+    static std::shared_ptr<const DocumentSnapshot> fromXml(const juce::XmlElement& xml);
+
+private:
+    static constexpr int currentVersion = 1;
+
+    static void writeShape(juce::XmlElement& parent, const Shape& shape);
+    static Shape readShape(const juce::XmlElement& element);
+    static void writeShapes(juce::XmlElement& parent, const juce::Array<Shape>& shapes);
+    static juce::Array<Shape> readShapes(const juce::XmlElement& parent);
+    static juce::String writePoints(const juce::Array<juce::Point<float>>& points);
+    static std::shared_ptr<const juce::Array<juce::Point<float>>> readPoints(const juce::String& text);
+};
@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    DrawOrder.cpp
+    Created: 18 Oct 2026 11:12:47pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "DrawOrder.h"
+
+void DrawOrder::clear()
+{
+    ++version;
+    entries.clear();
+    keys.clear();
+}
+
+int DrawOrder::getPosition(SlotId shape) const
+{
+    jassert(shape.slot < keys.size());
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), keys[shape.slot], isBelow);
+    jassert(it != entries.end() && it->shape == shape);
+
+    return (int) (it - entries.begin());
+}
+
+void DrawOrder::addShape(SlotId shape)
+{
+    if (shape.slot >= keys.size())
+        keys.resize(shape.slot + 1);
+
+    ++version;
+    const double key = entries.empty() ? 0.0 : entries.back().key + 1.0;
+    entries.push_back({ key, shape });
+    keys[shape.slot] = key;
+}
+
+void DrawOrder::removeShape(SlotId shape)
+{
+    ++version;
+    entries.erase(entries.begin() + getPosition(shape));
+}
+
+void DrawOrder::removeShapes(const juce::Array<SlotId>& shapesToRemove)
+{
+    ++version;
+
+    // A removed shape's key no longer matches its entry
+    for (auto shape : shapesToRemove)
+    {
+        jassert(shape.slot < keys.size());
+        keys[shape.slot] = std::numeric_limits<double>::quiet_NaN();
+    }
+
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [this](const Entry& entry) { return keys[entry.shape.slot] != entry.key; }),
+                  entries.end());
+}
+
+void DrawOrder::moveShape(SlotId shape, int newPosition)
+{
+    const int oldPosition = getPosition(shape);
+    jassert(juce::isPositiveAndBelow(newPosition, size()));
+
+    if (newPosition == oldPosition)
+        return;
+
+    ++version;
+
+    // The neighbours the shape ends up between, once it's out of the list
+    const int below = newPosition > oldPosition ? newPosition : newPosition - 1;
+    const int above = below + 1;
+    const auto keyAt = [this](int position) { return entries[(size_t) position].key; };
+
+    double key;
+
+    if (below < 0)
+        key = keyAt(0) - 1.0;
+    else if (above >= size())
+        key = keyAt(size() - 1) + 1.0;
+    else
+        key = (keyAt(below) + keyAt(above)) * 0.5;
+
+    // Move the entry with the ones in between, rather than erasing and inserting
+    const auto first = entries.begin();
+
+    if (newPosition > oldPosition)
+        std::rotate(first + oldPosition, first + oldPosition + 1, first + newPosition + 1);
+    else
+        std::rotate(first + newPosition, first + oldPosition, first + oldPosition + 1);
+
+    entries[(size_t) newPosition].key = key;
+    keys[shape.slot] = key;
+
+    // Out of precision after many restacks at the same spot
+    const bool fitsBetween = (newPosition == 0 || keyAt(newPosition - 1) < key)
+                             && (newPosition == size() - 1 || key < keyAt(newPosition + 1));
+
+    if (!fitsBetween)
+        renumber();
+}
+
+void DrawOrder::renumber()
+{
+    for (size_t i = 0; i < entries.size(); ++i)
+    {
+        entries[i].key = (double) i;
+        keys[entries[i].shape.slot] = (double) i;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    DrawOrder.h
+    Created: 18 Oct 2026 11:12:47pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// DrawOrder.h
+#pragma once
+#include <JuceHeader.h>
+#include "SlotMap.h"
+
+// The stacking order of the shapes, kept apart from the shape array.
+//
+// Every shape has a fractional z key. Restacking a shape only gives it a new
+// key between its new neighbours and moves one small entry in the sorted
+// list, so the shapes themselves stay where they are.
+//
+// Shapes are identified by their SlotId in the document. Keys are renumbered
+// when two neighbours get too close for another key to fit between them.
+// Finding a shape is a binary search, but removing one still closes the gap
+// in the list, which is a move of small entries rather than of shapes. Use
+// removeShapes() for several at once, that's a single pass.
+class DrawOrder
+{
+public:
+    DrawOrder() = default;
+
+    void clear();
+
+    int size() const { return (int) entries.size(); }
+
+    // Changes whenever shapes are added, removed or restacked
+    juce::uint32 getVersion() const { return version; }
+
+    // The shape at the given position, 0 being the bottom one
+    SlotId getShape(int position) const { return entries[(size_t) position].shape; }
+    int getPosition(SlotId shape) const;
+
+    // Puts a shape that was just added to the document on top
+    void addShape(SlotId shape);
+
+    void removeShape(SlotId shape);
+    void removeShapes(const juce::Array<SlotId>& shapesToRemove);
+
+    // Restacks a shape so that it ends up at the given position
+    void moveShape(SlotId shape, int newPosition);
+
+    void bringToFront(SlotId shape) { moveShape(shape, size() - 1); }
+    void sendToBack(SlotId shape) { moveShape(shape, 0); }
+    void bringForward(SlotId shape) { moveShape(shape, std::min(getPosition(shape) + 1, size() - 1)); }
+    void sendBackward(SlotId shape) { moveShape(shape, std::max(getPosition(shape) - 1, 0)); }
+
+private:
+    struct Entry
+    {
+        double key;
+        SlotId shape;
+    };
+
+    static bool isBelow(const Entry& entry, double key) { return entry.key < key; }
+
+    void renumber();
+
+    std::vector<Entry> entries;     // sorted by key
+    std::vector<double> keys;       // by slot
+    juce::uint32 version = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DrawOrder)
+};
@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    FilmstripCache.cpp
+    Created: 18 Oct 2026 9:48:20pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "FilmstripCache.h"
+#include "SceneRenderer.h"
+#include "TraceRecorder.h"
+
+class FilmstripCache::SliceJob : public juce::ThreadPoolJob
+{
+public:
+    SliceJob(std::shared_ptr<Strip> stripToRender, std::shared_ptr<const FrameContent> frameContent, int firstFrame, int endFrame)
+        : juce::ThreadPoolJob("Filmstrip"),
+          strip(std::move(stripToRender)),
+          content(std::move(frameContent)),
+          begin(firstFrame),
+          end(endFrame)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        UIDESIGNER_TRACE_SCOPE("renderFilmstripSlice");
+
+        // An evicted strip is never drawn, so it's left unfinished
+        if (!renderFrames(*strip, *content, begin, end))
+            return jobHasFinished;
+
+        // The image writes happen before this, the message thread reads the
+        // counter before it uses the image
+        strip->slicesLeft.fetch_sub(1);
+        return jobHasFinished;
+    }
+
+    bool belongsToCancelledStrip() const { return strip->isCancelled.load(); }
+
+private:
+    std::shared_ptr<Strip> strip;
+    std::shared_ptr<const FrameContent> content;
+    const int begin;
+    const int end;
+};
+
+class FilmstripCache::CancelledJobSelector : public juce::ThreadPool::JobSelector
+{
+public:
+    bool isJobSuitable(juce::ThreadPoolJob* job) override
+    {
+        auto* slice = dynamic_cast<SliceJob*>(job);
+        return slice != nullptr && slice->belongsToCancelledStrip();
+    }
+};
+
+//==================================================================
+
+FilmstripCache::FilmstripCache()
+    : threadPool(juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+FilmstripCache::~FilmstripCache()
+{
+    clear();
+    threadPool.removeAllJobs(true, 10000);
+}
+
+void FilmstripCache::drawIndicator(juce::Graphics& g, ControlType control, juce::Rectangle<float> bounds,
+                                   float value, float minThickness, juce::Path& path)
+{
+    g.setColour(juce::Colours::orange.withAlpha(0.6f));
+
+    switch (control)
+    {
+        case ControlType::Knob:
+        {
+            const float size = juce::jmin(bounds.getWidth(), bounds.getHeight());
+            const float thickness = juce::jmax(minThickness, size * 0.08f);
+            const float startAngle = -juce::MathConstants<float>::pi * 0.75f;
+
+            path.clear();
+            path.addCentredArc(bounds.getCentreX(), bounds.getCentreY(),
+                               (size - thickness) * 0.5f, (size - thickness) * 0.5f, 0.0f,
+                               startAngle, startAngle + value * juce::MathConstants<float>::pi * 1.5f, true);
+            g.strokePath(path, juce::PathStrokeType(thickness, juce::PathStrokeType::curved,
+                                                    juce::PathStrokeType::rounded));
+            break;
+        }
+        case ControlType::Slider:
+        {
+            if (bounds.getWidth() >= bounds.getHeight())
+                g.fillRect(bounds.withWidth(bounds.getWidth() * value));
+            else
+                g.fillRect(bounds.withTop(bounds.getBottom() - bounds.getHeight() * value));
+            break;
+        }
+        case ControlType::Toggle:
+        {
+            if (value >= 0.5f)
+                g.fillRect(bounds);
+            break;
+        }
+        case ControlType::None:
+            break;
+    }
+}
+
+void FilmstripCache::drawControl(juce::Graphics& g, const Shape& shape, float value, juce::Path& scratchPath)
+{
+    const float pixelsPerUnit = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto& bounds = shape.bounds;
+
+    // Two physical pixels at least, like the direct drawing
+    const float minThickness = 2.0f / pixelsPerUnit;
+
+    if (!usesFilmstrip(shape.control))
+    {
+        drawIndicator(g, shape.control, bounds, value, minThickness, scratchPath);
+        return;
+    }
+
+    const float widthInPixels = bounds.getWidth() * pixelsPerUnit;
+    const float heightInPixels = bounds.getHeight() * pixelsPerUnit;
+
+    if (widthInPixels < 1.0f || heightInPixels < 1.0f)
+    {
+        drawIndicator(g, shape.control, bounds, value, minThickness, scratchPath);
+        return;
+    }
+
+    const StripKey key { shape.control, quantiseStripSize(widthInPixels), quantiseStripSize(heightInPixels) };
+
+    if ((size_t) key.width * (size_t) (key.height + framePadding) * numFrames * 4 > maxStripBytes)
+    {
+        drawIndicator(g, shape.control, bounds, value, minThickness, scratchPath);
+        return;
+    }
+
+    auto& slot = strips[key];
+    const bool isNew = slot == nullptr;
+
+    if (isNew)
+    {
+        slot = createStrip(key.width, key.height, framePadding);
+
+        auto content = std::make_shared<FrameContent>();
+        content->control = shape.control;
+        content->pixelsPerUnit = pixelsPerUnit;
+        content->indicatorBounds = { (float) key.width / pixelsPerUnit, (float) key.height / pixelsPerUnit };
+        content->frameArea = content->indicatorBounds;
+        startSlices(slot, std::move(content));
+    }
+
+    auto strip = slot;
+    strip->lastUsed = ++useCounter;
+
+    if (isNew)
+        evictStrips();
+
+    if (!strip->isComplete)
+    {
+        drawIndicator(g, shape.control, bounds, value, minThickness, scratchPath);
+        return;
+    }
+
+    // Only frame `index` lies inside the clip, the padding keeps the
+    // neighbours out of its anti-aliased edge
+    const int index = juce::jlimit(0, numFrames - 1, juce::roundToInt(value * (float) (numFrames - 1)));
+    const float scaleX = bounds.getWidth() / (float) strip->frameWidth;
+    const float scaleY = bounds.getHeight() / (float) strip->frameHeight;
+
+    scratchPath.clear();
+    scratchPath.addRectangle(bounds);
+
+    juce::Graphics::ScopedSaveState stateSave(g);
+    g.reduceClipRegion(scratchPath);
+    g.drawImageTransformed(strip->image,
+                           juce::AffineTransform::translation(0.0f, (float) (-index * strip->framePitch))
+                               .scaled(scaleX, scaleY)
+                               .translated(bounds.getX(), bounds.getY()));
+}
+
+bool FilmstripCache::collectFinishedStrips()
+{
+    bool anyFinished = false;
+
+    for (auto& [key, strip] : strips)
+    {
+        if (!strip->isComplete && strip->slicesLeft.load() == 0)
+        {
+            strip->isComplete = true;
+            anyFinished = true;
+        }
+    }
+
+    return anyFinished;
+}
+
+void FilmstripCache::clear()
+{
+    // Running slices keep their strip alive until they notice
+    for (auto& [key, strip] : strips)
+        strip->isCancelled.store(true);
+
+    strips.clear();
+    removeCancelledJobs();
+}
+
+juce::Image FilmstripCache::renderAsset(const Shape& shape, float pixelsPerUnit, const SymbolLibrary* symbols)
+{
+    UIDESIGNER_TRACE_SCOPE("renderFilmstripAsset");
+
+    auto unrotated = shape;
+    unrotated.rotation = 0.0f;
+
+    // Room for the half of the stroke outside the bounds
+    auto content = std::make_shared<FrameContent>();
+    content->control = shape.control;
+    content->pixelsPerUnit = pixelsPerUnit;
+    content->indicatorBounds = shape.bounds;
+    content->frameArea = shape.bounds.expanded(shape.style->strokeWidth * 0.5f + 1.0f);
+    content->shape = unrotated;
+    content->symbols = symbols;
+
+    // Assets are packed without padding, as plugin frameworks expect them
+    auto strip = createStrip(juce::roundToInt(content->frameArea.getWidth() * pixelsPerUnit),
+                             juce::roundToInt(content->frameArea.getHeight() * pixelsPerUnit), 0);
+    renderFrames(*strip, *content, 0, numFrames);
+    return strip->image;
+}
+
+int FilmstripCache::quantiseStripSize(float pixels)
+{
+    const float steps = std::ceil(std::log2(pixels) * sizeStepsPerOctave);
+    return juce::jmax(1, (int) std::ceil(std::exp2(steps / sizeStepsPerOctave) - 0.001f));
+}
+
+std::shared_ptr<FilmstripCache::Strip> FilmstripCache::createStrip(int frameWidth, int frameHeight, int padding)
+{
+    auto strip = std::make_shared<Strip>();
+    strip->frameWidth = juce::jmax(1, frameWidth);
+    strip->frameHeight = juce::jmax(1, frameHeight);
+    strip->framePitch = strip->frameHeight + padding;
+    strip->image = juce::Image(juce::Image::ARGB, strip->frameWidth, strip->framePitch * numFrames, true,
+                               juce::SoftwareImageType());
+    return strip;
+}
+
+void FilmstripCache::startSlices(std::shared_ptr<Strip> strip, std::shared_ptr<const FrameContent> content)
+{
+    const int numSlices = (numFrames + framesPerSlice - 1) / framesPerSlice;
+    strip->slicesLeft.store(numSlices);
+
+    for (int begin = 0; begin < numFrames; begin += framesPerSlice)
+        threadPool.addJob(new SliceJob(strip, content, begin, juce::jmin(numFrames, begin + framesPerSlice)), true);
+}
+
+bool FilmstripCache::renderFrames(Strip& strip, const FrameContent& content, int begin, int end)
+{
+    FrameArena arena;
+    juce::Path path;
+
+    const auto frameTransform = juce::AffineTransform::translation(-content.frameArea.getX(), -content.frameArea.getY())
+                                    .scaled((float) strip.frameWidth / content.frameArea.getWidth(),
+                                            (float) strip.frameHeight / content.frameArea.getHeight());
+
+    for (int i = begin; i < end; ++i)
+    {
+        if (strip.isCancelled.load())
+            return false;
+
+        // Each slice only touches its own frames of the shared image
+        auto frame = strip.image.getClippedImage({ 0, i * strip.framePitch, strip.frameWidth, strip.frameHeight });
+        juce::Graphics g(frame);
+        g.addTransform(frameTransform);
+
+        if (content.shape.has_value())
+        {
+            SceneRenderer renderer(g, arena, content.pixelsPerUnit, content.symbols);
+            renderer.drawShape(*content.shape);
+            arena.reset();
+        }
+
+        const float value = (float) i / (float) (numFrames - 1);
+        drawIndicator(g, content.control, content.indicatorBounds, value, 2.0f / content.pixelsPerUnit, path);
+    }
+
+    return true;
+}
+
+void FilmstripCache::evictStrips()
+{
+    bool evictedAny = false;
+
+    while ((int) strips.size() > maxStrips)
+    {
+        auto oldest = strips.begin();
+
+        for (auto it = strips.begin(); it != strips.end(); ++it)
+            if (it->second->lastUsed < oldest->second->lastUsed)
+                oldest = it;
+
+        oldest->second->isCancelled.store(true);
+        strips.erase(oldest);
+        evictedAny = true;
+    }
+
+    if (evictedAny)
+        removeCancelledJobs();
+}
+
+void FilmstripCache::removeCancelledJobs()
+{
+    // Queued slices are dropped right away, running ones stop after their
+    // current frame, without waiting for them here
+    CancelledJobSelector selector;
+    threadPool.removeAllJobs(true, 0, &selector);
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    FilmstripCache.h
+    Created: 18 Oct 2026 9:48:20pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// FilmstripCache.h
+#pragma once
+#include <JuceHeader.h>
+#include "MainComponent.h"
+
+class SymbolLibrary;
+
+// Pre-rendered value arcs for knob controls, numFrames positions stacked in
+// one image. Drawing a value blits one frame instead of building and stroking
+// a path, so a sweep over many knobs costs the same per frame whatever they
+// look like. Slider and toggle indicators are single rectangle fills, which
+// are cheaper than a blit and don't snap to numFrames steps, so they're
+// always drawn directly.
+//
+// Strips depend only on the control type and its size in pixels, so equal
+// controls share one. Sizes are rounded up to steps of an eighth of an
+// octave, so zooming only needs a new strip every few percent, and frames are
+// scaled down a little to fit. Strips are rendered in slices on a thread
+// pool, and until a strip is complete the indicator is drawn directly.
+// Evicted strips stop rendering and their queued slices are dropped.
+class FilmstripCache
+{
+public:
+    using Shape = MainComponent::Shape;
+    using ControlType = MainComponent::ControlType;
+
+    static constexpr int numFrames = 128;
+
+    FilmstripCache();
+    ~FilmstripCache();
+
+    // Draws the indicator for value over the shape, unrotated and in
+    // document coordinates
+    void drawControl(juce::Graphics& g, const Shape& shape, float value, juce::Path& scratchPath);
+
+    // Returns true if any strips were finished since the last call, in which
+    // case the owner should repaint the controls
+    bool collectFinishedStrips();
+    void clear();
+
+    // The shape with its indicator at every position, one frame below the
+    // other, as an image asset. Renders on the calling thread.
+    juce::Image renderAsset(const Shape& shape, float pixelsPerUnit, const SymbolLibrary* symbols);
+
+    // Draws the indicator without a strip. Knob arcs are at least minThickness wide.
+    static void drawIndicator(juce::Graphics& g, ControlType control, juce::Rectangle<float> bounds,
+                              float value, float minThickness, juce::Path& path);
+
+    static bool usesFilmstrip(ControlType control) { return control == ControlType::Knob; }
+
+private:
+    struct StripKey
+    {
+        ControlType control;
+        int width;
+        int height;
+
+        bool operator<(const StripKey& other) const
+        {
+            return std::tie(control, width, height) < std::tie(other.control, other.width, other.height);
+        }
+    };
+
+    struct Strip
+    {
+        juce::Image image;
+        int frameWidth = 0;
+        int frameHeight = 0;
+        int framePitch = 0;
+        std::atomic<int> slicesLeft { 0 };
+        std::atomic<bool> isCancelled { false };    // evicted, slices stop early
+        bool isComplete = false;    // message thread only
+        juce::int64 lastUsed = 0;
+    };
+
+    // What a slice job draws into each frame
+    struct FrameContent
+    {
+        ControlType control = ControlType::None;
+        juce::Rectangle<float> indicatorBounds;
+        juce::Rectangle<float> frameArea;       // document area mapped onto the frame
+        float pixelsPerUnit = 1.0f;
+        std::optional<Shape> shape;             // only for assets
+        const SymbolLibrary* symbols = nullptr;
+    };
+
+    class SliceJob;
+    class CancelledJobSelector;
+
+    static constexpr int framesPerSlice = 16;
+    static constexpr int framePadding = 2;     // keeps the neighbouring frames out of the clip
+    static constexpr size_t maxStripBytes = 8 * 1024 * 1024;
+    static constexpr int maxStrips = 64;
+    static constexpr float sizeStepsPerOctave = 8.0f;
+
+    static int quantiseStripSize(float pixels);
+    static std::shared_ptr<Strip> createStrip(int frameWidth, int frameHeight, int padding);
+    void startSlices(std::shared_ptr<Strip> strip, std::shared_ptr<const FrameContent> content);
+    // Returns false if the strip was cancelled before all frames were drawn
+    static bool renderFrames(Strip& strip, const FrameContent& content, int begin, int end);
+    void evictStrips();
+    void removeCancelledJobs();
+
+    std::map<StripKey, std::shared_ptr<Strip>> strips;
+    juce::int64 useCounter = 0;
+    juce::ThreadPool threadPool;
+
+    JUCE_DECLARE_NON_COPYABLE(FilmstripCache)
+};
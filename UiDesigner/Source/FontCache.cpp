@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    FontCache.cpp
+    Created: 18 Oct 2026 5:52:03pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "FontCache.h"
+#include "TraceRecorder.h"
+
+JUCE_IMPLEMENT_SINGLETON(FontCache)
+
+FontCache::FontCache()
+{
+}
+
+FontCache::~FontCache()
+{
+    prewarmPool.removeAllJobs(true, 5000);
+    clearSingletonInstance();
+}
+
+juce::Font FontCache::getFont(const juce::String& family, float height, int styleFlags)
+{
+    const FontKey key { family, height, styleFlags };
+    std::promise<juce::Typeface::Ptr> typefacePromise;
+    std::shared_future<juce::Typeface::Ptr> typeface;
+    bool loadsTypeface = false;
+
+    {
+        const juce::ScopedLock sl(lock);
+
+        if (auto found = fonts.find(key); found != fonts.end())
+            return found->second;
+
+        auto [load, isNew] = typefaces.try_emplace(TypefaceKey { family, styleFlags });
+
+        if (isNew)
+        {
+            load->second = typefacePromise.get_future().share();
+            loadsTypeface = true;
+        }
+
+        typeface = load->second;
+    }
+
+    // Loading the typeface is the slow part, so it happens outside the lock
+    // and a pre-warm of another family doesn't hold up the message thread.
+    // Only a request for the same family waits for it.
+    juce::Font font(family, height, styleFlags);
+
+    if (loadsTypeface)
+    {
+        UIDESIGNER_TRACE_SCOPE("FontCache::loadTypeface");
+        typefacePromise.set_value(font.getTypefacePtr());
+    }
+    else
+    {
+        typeface.wait();
+    }
+
+    const juce::ScopedLock sl(lock);
+
+    // Sizes are picked with a slider, so the cache could fill up with ones
+    // nobody uses any more. The typefaces stay, fonts are cheap to recreate.
+    if ((int) fonts.size() >= maxCachedFonts)
+        fonts.clear();
+
+    return fonts.emplace(key, font).first->second;
+}
+
+void FontCache::prewarm(const juce::StringArray& families)
+{
+    for (auto& family : families)
+    {
+        prewarmPool.addJob([this, family]
+        {
+            UIDESIGNER_TRACE_SCOPE("FontCache::prewarm");
+
+            // Measuring also loads the glyph metrics the text editor needs
+            auto font = getFont(family, 14.0f);
+            font.getStringWidthFloat("The quick brown fox jumps over the lazy dog 0123456789");
+        });
+    }
+}
@@ -0,0 +1,61 @@
+/*
+  ==============================================================================
+
+    FontCache.h
+    Created: 18 Oct 2026 5:52:03pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// FontCache.h
+#pragma once
+#include <JuceHeader.h>
+#include <future>
+
+// Process-wide cache of fonts, shared by all text shapes and all plugin
+// instances. Each interned style looks up its font here once, so a thousand
+// labels in one family and size share a single font, see StyleTable.
+//
+// The typefaces behind the fonts are kept alive here as well. JUCE's own
+// typeface cache only holds a handful and loading one is slow, which is what
+// made the first text edit hitch. prewarm() loads typefaces on a background
+// thread ahead of time, e.g. for the families used in a document that was
+// just loaded.
+class FontCache : private juce::DeletedAtShutdown
+{
+public:
+    FontCache();
+    ~FontCache() override;
+
+    juce::Font getFont(const juce::String& family, float height, int styleFlags = juce::Font::plain);
+
+    // Loads the typefaces of these families in the background
+    void prewarm(const juce::StringArray& families);
+
+    JUCE_DECLARE_SINGLETON(FontCache, false)
+
+private:
+    using FontKey = std::tuple<juce::String, float, int>;
+    using TypefaceKey = std::pair<juce::String, int>;
+
+    static constexpr int maxCachedFonts = 256;
+
+    juce::CriticalSection lock;
+    std::map<FontKey, juce::Font> fonts;
+
+    // Set by whoever loads a typeface first, others asking for it meanwhile
+    // wait for that instead of loading it again
+    std::map<TypefaceKey, std::shared_future<juce::Typeface::Ptr>> typefaces;
+
+    juce::ThreadPool prewarmPool { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FontCache)
+};
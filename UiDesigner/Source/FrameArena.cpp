@@ -0,0 +1,115 @@
+/*
+  ==============================================================================
+
+    FrameArena.cpp
+    Created: 18 Oct 2026 2:40:51pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "FrameArena.h"
+
+FrameArena::FrameArena(size_t initialBlockSize)
+{
+    addBlock(initialBlockSize);
+}
+
+void FrameArena::addBlock(size_t minimumSize)
+{
+    Block block;
+    block.size = std::max(minimumSize, blocks.empty() ? minimumSize : blocks.back().size * 2);
+    block.data.malloc(block.size);
+    blocks.push_back(std::move(block));
+}
+
+void* FrameArena::allocate(size_t numBytes, size_t alignment)
+{
+    jassert(juce::isPowerOfTwo(alignment));
+
+    for (;;)
+    {
+        auto& block = blocks[currentBlock];
+        auto base = reinterpret_cast<juce::pointer_sized_uint>(block.data.get());
+        auto alignedOffset = ((base + currentOffset + alignment - 1) & ~(juce::pointer_sized_uint) (alignment - 1)) - base;
+
+        if (alignedOffset + numBytes <= block.size)
+        {
+            bytesUsedInFrame += (alignedOffset - currentOffset) + numBytes;
+            currentOffset = alignedOffset + numBytes;
+            return block.data.get() + alignedOffset;
+        }
+
+        // Move on to the next block, adding one if this frame needs more than ever before
+        if (++currentBlock == blocks.size())
+            addBlock(numBytes + alignment);
+
+        currentOffset = 0;
+    }
+}
+
+juce::Path& FrameArena::acquirePath()
+{
+    if (numPathsInUse == pathPool.size())
+        pathPool.add(new juce::Path());
+
+    auto& path = *pathPool.getUnchecked(numPathsInUse++);
+    pathsUsedInFrame = std::max(pathsUsedInFrame, numPathsInUse);
+    path.clear();  // keeps its storage
+    return path;
+}
+
+void FrameArena::releasePath(juce::Path& path)
+{
+    jassert(numPathsInUse > 0 && &path == pathPool.getUnchecked(numPathsInUse - 1));
+    juce::ignoreUnused(path);
+    --numPathsInUse;
+}
+
+void FrameArena::reset()
+{
+    highWaterBytes = std::max(highWaterBytes, bytesUsedInFrame);
+    highWaterPaths = std::max(highWaterPaths, pathsUsedInFrame);
+
+    // If the frame spilled into several blocks, replace them with a single
+    // block big enough for the largest frame, so later frames stay contiguous
+    if (blocks.size() > 1)
+    {
+        size_t totalSize = 0;
+        for (auto& block : blocks)
+            totalSize += block.size;
+
+        blocks.clear();
+        addBlock(totalSize);
+    }
+
+    currentBlock = 0;
+    currentOffset = 0;
+    bytesUsedInFrame = 0;
+    numPathsInUse = 0;
+    pathsUsedInFrame = 0;
+
+    if (pathPool.size() > maxPooledPaths)
+        pathPool.removeLast(pathPool.size() - maxPooledPaths);
+}
+
+FrameArena::Statistics FrameArena::getStatistics() const
+{
+    Statistics stats;
+    stats.bytesUsed = bytesUsedInFrame;
+    stats.highWaterBytes = std::max(highWaterBytes, bytesUsedInFrame);
+    stats.pathsUsed = pathsUsedInFrame;
+    stats.highWaterPaths = std::max(highWaterPaths, pathsUsedInFrame);
+
+    for (auto& block : blocks)
+        stats.bytesReserved += block.size;
+
+    return stats;
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    FrameArena.h
+    Created: 18 Oct 2026 2:40:51pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// FrameArena.h
+#pragma once
+#include <JuceHeader.h>
+
+// Bump allocator for temporaries that only live for one paint call.
+// Everything handed out is released at once by reset(), which the owner
+// calls at the end of every frame. Memory is kept between frames, so after
+// the first few frames painting doesn't hit malloc for these at all.
+//
+// juce::Path manages its own storage, so paths come from a pool instead:
+// acquirePath() returns an empty path whose capacity survives reset().
+// Paths are handed back in reverse order with releasePath(), or by a
+// ScopedPath, so the pool only grows as deep as they are nested rather
+// than with the number of shapes drawn.
+class FrameArena
+{
+public:
+    struct Statistics
+    {
+        size_t bytesUsed = 0;          // in the current frame
+        size_t highWaterBytes = 0;     // largest frame so far
+        size_t bytesReserved = 0;
+        int pathsUsed = 0;             // most in use at once in the current frame
+        int highWaterPaths = 0;
+    };
+
+    explicit FrameArena(size_t initialBlockSize = 64 * 1024);
+
+    void* allocate(size_t numBytes, size_t alignment = alignof(std::max_align_t));
+
+    // Uninitialised storage for numElements objects, only for types that
+    // don't need destructing since reset() never runs any destructors
+    template <typename Type>
+    Type* allocateArray(size_t numElements)
+    {
+        static_assert(std::is_trivially_destructible<Type>::value, "Arena objects are never destroyed");
+        return static_cast<Type*>(allocate(sizeof(Type) * numElements, alignof(Type)));
+    }
+
+    template <typename Type, typename... Args>
+    Type* create(Args&&... args)
+    {
+        static_assert(std::is_trivially_destructible<Type>::value, "Arena objects are never destroyed");
+        return new (allocate(sizeof(Type), alignof(Type))) Type(std::forward<Args>(args)...);
+    }
+
+    // Returns a cleared path which stays valid until it's released or the
+    // next reset()
+    juce::Path& acquirePath();
+
+    // Must be the most recently acquired path that's still in use
+    void releasePath(juce::Path& path);
+
+    class ScopedPath
+    {
+    public:
+        explicit ScopedPath(FrameArena& frameArena) : arena(frameArena), path(frameArena.acquirePath()) {}
+        ~ScopedPath() { arena.releasePath(path); }
+
+        operator juce::Path&() const { return path; }
+        juce::Path* operator->() const { return &path; }
+
+    private:
+        FrameArena& arena;
+        juce::Path& path;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedPath)
+    };
+
+    void reset();
+
+    Statistics getStatistics() const;
+
+private:
+    struct Block
+    {
+        juce::HeapBlock<char> data;
+        size_t size = 0;
+    };
+
+    void addBlock(size_t minimumSize);
+
+    std::vector<Block> blocks;
+    size_t currentBlock = 0;
+    size_t currentOffset = 0;
+    size_t bytesUsedInFrame = 0;
+    size_t highWaterBytes = 0;
+
+    // Paths beyond this are freed by reset(), so that one deeply nested
+    // frame doesn't keep their storage forever
+    static constexpr int maxPooledPaths = 16;
+
+    juce::OwnedArray<juce::Path> pathPool;
+    int numPathsInUse = 0;
+    int pathsUsedInFrame = 0;
+    int highWaterPaths = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(FrameArena)
+};
@@ -0,0 +1,286 @@
+/*
+  ==============================================================================
+
+    ImageLibrary.cpp
+    Created: 19 Oct 2026 3:02:44am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "ImageLibrary.h"
+#include "TraceRecorder.h"
+
+JUCE_IMPLEMENT_SINGLETON(ImageLibrary)
+
+ImageLibrary::ImageLibrary()
+{
+}
+
+ImageLibrary::~ImageLibrary()
+{
+    decodePool.removeAllJobs(true, 5000);
+    clearSingletonInstance();
+}
+
+void ImageLibrary::load(const juce::String& path)
+{
+    const juce::ScopedLock sl(lock);
+    getEntry(path);
+}
+
+ImageLibrary::Status ImageLibrary::getStatus(const juce::String& path)
+{
+    const juce::ScopedLock sl(lock);
+    return getEntry(path).status;
+}
+
+juce::Image ImageLibrary::getImage(const juce::String& path, float width, float height)
+{
+    const juce::ScopedLock sl(lock);
+    auto& entry = getEntry(path);
+
+    if (entry.status != Status::Ready)
+        return {};
+
+    entry.lastUsed = ++useCounter;
+
+    // Halving further would make the image larger on screen than the level.
+    // Sizes come from levelBounds, which dropped levels are still in.
+    int level = 0;
+
+    while (level + 1 < entry.levelBounds.size()
+           && entry.levelBounds.getReference(level + 1).getWidth() >= width
+           && entry.levelBounds.getReference(level + 1).getHeight() >= height)
+        ++level;
+
+    if (level < entry.firstLevel)
+    {
+        // Drawn a little blurry until the file has been decoded again
+        if (!entry.isReloading)
+        {
+            entry.isReloading = true;
+            decodePool.addJob([this, path] { decode(path); });
+        }
+
+        level = entry.firstLevel;
+    }
+
+    return entry.levels.getReference(level);
+}
+
+ImageLibrary::Entry& ImageLibrary::getEntry(const juce::String& path)
+{
+    auto [found, isNew] = entries.try_emplace(path);
+
+    if (isNew)
+        decodePool.addJob([this, path] { decode(path); });
+
+    return found->second;
+}
+
+void ImageLibrary::decode(const juce::String& path)
+{
+    UIDESIGNER_TRACE_SCOPE("ImageLibrary::decode");
+
+    // Documents from another machine may hold paths that aren't valid here
+    juce::Image decoded;
+
+    if (juce::File::isAbsolutePath(path))
+        decoded = juce::ImageFileFormat::loadFrom(juce::File(path));
+
+    auto levels = decoded.isValid() ? createMipChain(decoded) : juce::Array<juce::Image>();
+
+    {
+        const juce::ScopedLock sl(lock);
+        auto& entry = entries[path];
+        entry.status = levels.isEmpty() ? Status::Failed : Status::Ready;
+        entry.levels = std::move(levels);
+        entry.levelBounds.clearQuick();
+        entry.firstLevel = 0;
+        entry.isReloading = false;
+
+        totalBytes -= entry.numBytes;
+        entry.numBytes = 0;
+
+        for (auto& level : entry.levels)
+        {
+            entry.levelBounds.add(level.getBounds());
+            entry.numBytes += getNumBytes(level);
+        }
+
+        totalBytes += entry.numBytes;
+        evictLevels(entry);
+    }
+
+    ++generation;
+    sendChangeMessage();
+}
+
+void ImageLibrary::evictLevels(const Entry& keptEntry)
+{
+    // Images are only ever evicted a level at a time, so a scan for the
+    // least recently used one is cheap next to the decode that got us here
+    while (totalBytes > maxCachedBytes)
+    {
+        Entry* oldest = nullptr;
+
+        for (auto& [path, entry] : entries)
+        {
+            if (&entry == &keptEntry || entry.status != Status::Ready || entry.isReloading
+                || entry.firstLevel + 1 >= entry.levels.size())
+                continue;
+
+            const auto& largest = entry.levels.getReference(entry.firstLevel);
+
+            if (largest.getWidth() * largest.getHeight() >= minEvictedLevelPixels
+                && (oldest == nullptr || entry.lastUsed < oldest->lastUsed))
+                oldest = &entry;
+        }
+
+        if (oldest == nullptr)
+            return;
+
+        auto& level = oldest->levels.getReference(oldest->firstLevel++);
+        oldest->numBytes -= getNumBytes(level);
+        totalBytes -= getNumBytes(level);
+        level = {};
+    }
+}
+
+juce::Array<juce::Image> ImageLibrary::createMipChain(const juce::Image& decoded)
+{
+    UIDESIGNER_TRACE_SCOPE("ImageLibrary::createMipChain");
+
+    // Software images can be read from any thread
+    auto level = juce::SoftwareImageType().convert(decoded);
+
+    if (level.getFormat() != juce::Image::ARGB)
+        level = level.convertedToFormat(juce::Image::ARGB);
+
+    juce::Array<juce::Image> levels;
+    levels.add(level);
+
+    while (level.getWidth() > minLevelSize || level.getHeight() > minLevelSize)
+    {
+        level = createHalfSizeImage(level);
+        levels.add(level);
+    }
+
+    return levels;
+}
+
+juce::Image ImageLibrary::createHalfSizeImage(const juce::Image& source)
+{
+    const int width = juce::jmax(1, source.getWidth() / 2);
+    const int height = juce::jmax(1, source.getHeight() / 2);
+    juce::Image result(juce::Image::ARGB, width, height, false, juce::SoftwareImageType());
+
+    const juce::Image::BitmapData sourcePixels(source, juce::Image::BitmapData::readOnly);
+    juce::Image::BitmapData resultPixels(result, juce::Image::BitmapData::writeOnly);
+
+    // Each pixel is the average of a 2x2 block. The colours are premultiplied,
+    // so averaging the components weights them by alpha as it should.
+    for (int y = 0; y < height; ++y)
+    {
+        const int y0 = juce::jmin(y * 2, source.getHeight() - 1);
+        const int y1 = juce::jmin(y * 2 + 1, source.getHeight() - 1);
+
+        for (int x = 0; x < width; ++x)
+        {
+            const int x0 = juce::jmin(x * 2, source.getWidth() - 1);
+            const int x1 = juce::jmin(x * 2 + 1, source.getWidth() - 1);
+
+            const juce::PixelARGB* block[] = {
+                reinterpret_cast<const juce::PixelARGB*>(sourcePixels.getPixelPointer(x0, y0)),
+                reinterpret_cast<const juce::PixelARGB*>(sourcePixels.getPixelPointer(x1, y0)),
+                reinterpret_cast<const juce::PixelARGB*>(sourcePixels.getPixelPointer(x0, y1)),
+                reinterpret_cast<const juce::PixelARGB*>(sourcePixels.getPixelPointer(x1, y1))
+            };
+
+            int alpha = 2, red = 2, green = 2, blue = 2;
+
+            for (auto* pixel : block)
+            {
+                alpha += pixel->getAlpha();
+                red += pixel->getRed();
+                green += pixel->getGreen();
+                blue += pixel->getBlue();
+            }
+
+            reinterpret_cast<juce::PixelARGB*>(resultPixels.getPixelPointer(x, y))
+                ->setARGB((juce::uint8) (alpha >> 2), (juce::uint8) (red >> 2),
+                          (juce::uint8) (green >> 2), (juce::uint8) (blue >> 2));
+        }
+    }
+
+    return result;
+}
+
+juce::Rectangle<int> ImageLibrary::readImageSize(const juce::File& file)
+{
+    juce::FileInputStream in(file);
+
+    if (!in.openedOk())
+        return {};
+
+    juce::uint8 header[24] = {};
+
+    if (in.read(header, (int) sizeof(header)) < (int) sizeof(header))
+        return {};
+
+    // PNG: the IHDR chunk comes first, width and height are big-endian
+    if (std::memcmp(header, "\x89PNG\r\n\x1a\n", 8) == 0)
+        return { (int) juce::ByteOrder::bigEndianInt(header + 16), (int) juce::ByteOrder::bigEndianInt(header + 20) };
+
+    // GIF: the logical screen size, little-endian
+    if (std::memcmp(header, "GIF8", 4) == 0)
+        return { (int) juce::ByteOrder::littleEndianShort(header + 6), (int) juce::ByteOrder::littleEndianShort(header + 8) };
+
+    // JPEG: skip segments up to the start of frame
+    if (header[0] == 0xff && header[1] == 0xd8)
+    {
+        in.setPosition(2);
+
+        while (!in.isExhausted())
+        {
+            if ((juce::uint8) in.readByte() != 0xff)
+                return {};
+
+            auto marker = (juce::uint8) in.readByte();
+
+            while (marker == 0xff)
+                marker = (juce::uint8) in.readByte();
+
+            // Markers without a length
+            if (marker == 0x01 || (marker >= 0xd0 && marker <= 0xd8))
+                continue;
+
+            const int length = (juce::uint16) in.readShortBigEndian();
+
+            // C4, C8 and CC share the range but are tables, not frames
+            if (marker >= 0xc0 && marker <= 0xcf && marker != 0xc4 && marker != 0xc8 && marker != 0xcc)
+            {
+                in.readByte();  // sample precision
+                const int height = (juce::uint16) in.readShortBigEndian();
+                const int width = (juce::uint16) in.readShortBigEndian();
+                return { width, height };
+            }
+
+            // The image data starts without a frame having been seen
+            if (marker == 0xda || length < 2)
+                return {};
+
+            in.setPosition(in.getPosition() + length - 2);
+        }
+    }
+
+    return {};
+}
@@ -0,0 +1,113 @@
+/*
+  ==============================================================================
+
+    ImageLibrary.h
+    Created: 19 Oct 2026 3:02:44am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// ImageLibrary.h
+#pragma once
+#include <JuceHeader.h>
+
+// Process-wide store of the bitmaps shown by image shapes, shared by all
+// shapes and plugin instances that use the same file.
+//
+// Files are decoded on a background pool the first time they're asked for.
+// Until then getImage() returns an invalid image and the shape is drawn as a
+// placeholder. Listeners get a change message once images have finished
+// loading.
+//
+// Each image is kept as a mip chain: the decoded image and copies of it
+// halved again and again, built once after decoding. Drawing picks the
+// smallest level that is still no smaller than the image on screen, so a 4K
+// background shown at thumbnail size is resampled from a level a few hundred
+// pixels wide rather than from the original.
+//
+// Decoded levels are kept within a byte budget. When it's exceeded, the
+// largest levels of the least recently drawn images are dropped. Drawing such
+// an image then uses the largest level left while the file is decoded again.
+//
+// All functions are safe to call from any thread.
+class ImageLibrary : public juce::ChangeBroadcaster,
+                     private juce::DeletedAtShutdown
+{
+public:
+    enum class Status
+    {
+        Loading,
+        Ready,
+        Failed      // missing file or unknown format
+    };
+
+    ImageLibrary();
+    ~ImageLibrary() override;
+
+    // Starts decoding the file in the background, unless it's already known
+    void load(const juce::String& path);
+
+    // Loads the file if it isn't known yet
+    Status getStatus(const juce::String& path);
+
+    // The level to draw at the given size in pixels, or an invalid image
+    // while the file is still loading or if it couldn't be decoded
+    juce::Image getImage(const juce::String& path, float width, float height);
+
+    // Changes whenever an image has finished decoding, along with the change
+    // message. Lets callers cache what they found out without taking the lock.
+    juce::uint32 getGeneration() const { return generation.load(std::memory_order_acquire); }
+
+    // Reads the size from the file header without decoding the image. Knows
+    // PNG, JPEG and GIF, and returns an empty size for anything else.
+    static juce::Rectangle<int> readImageSize(const juce::File& file);
+
+    JUCE_DECLARE_SINGLETON(ImageLibrary, false)
+
+private:
+    struct Entry
+    {
+        Status status = Status::Loading;
+        juce::Array<juce::Image> levels;    // full size first, software ARGB
+        juce::Array<juce::Rectangle<int>> levelBounds;  // still known for dropped levels
+        int firstLevel = 0;                 // the ones before it were dropped
+        size_t numBytes = 0;                // of the levels still held
+        juce::uint64 lastUsed = 0;
+        bool isReloading = false;
+    };
+
+    // Levels stop halving once they are this small
+    static constexpr int minLevelSize = 8;
+
+    // Decoded pixels kept across all images. Levels with fewer pixels than
+    // minEvictedLevelPixels are never dropped, so an image always has
+    // something to draw.
+    static constexpr size_t maxCachedBytes = 512 * 1024 * 1024;
+    static constexpr int minEvictedLevelPixels = 256 * 256;
+
+    static juce::Array<juce::Image> createMipChain(const juce::Image& decoded);
+    static juce::Image createHalfSizeImage(const juce::Image& source);
+    static size_t getNumBytes(const juce::Image& level) { return (size_t) level.getWidth() * (size_t) level.getHeight() * 4; }
+
+    Entry& getEntry(const juce::String& path);
+    void decode(const juce::String& path);
+    void evictLevels(const Entry& keptEntry);
+
+    juce::CriticalSection lock;
+    std::map<juce::String, Entry> entries;
+    size_t totalBytes = 0;
+    juce::uint64 useCounter = 0;
+    std::atomic<juce::uint32> generation { 1 };
+
+    juce::ThreadPool decodePool { juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1) };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImageLibrary)
+};
@@ -1,1966 +1,4023 @@
-/*
-  ==============================================================================
-
-    MainComponent.cpp
-    Created: 11 Nov 2024 10:52:48pm
-    Author:  Martin S
- 
-    You may use this code under the terms of the GPL v3 (see
-    www.gnu.org/licenses) or also the licensed attached to this project.
-
-    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
-    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
-    DISCLAIMED.
-
-  ==============================================================================
-*/
-
-#include "MainComponent.h"
-
-StrokePatternButton::StrokePatternButton(const juce::String& name) : juce::Button(name)
-{
-    
-}
-    
-void StrokePatternButton::paintButton(juce::Graphics& g, bool isMouseOver, bool isButtonDown)
-{
-    auto bounds = getLocalBounds();
-    g.setColour((isButtonDown || getToggleState()) ? juce::Colours::grey : (isMouseOver ? juce::Colours::lightgrey : juce::Colours::white));
-    g.fillRect(bounds);
-    
-    g.setColour(juce::Colours::black);
-    g.drawRect(bounds);
-    
-    // Draw pattern preview
-    float dashLengths[6] = { 6.0f, 3.0f }; // Default dash pattern
-    if (getName() == "Dotted")
-        dashLengths[0] = dashLengths[1] = 3.0f;
-    else if (getName() == "Dash-Dot")
-    {
-        dashLengths[0] = 9.0f;
-        dashLengths[1] = 3.0f;
-        dashLengths[2] = 3.0f;
-        dashLengths[3] = 3.0f;
-    }
-    
-    juce::Path path;
-    path.startNewSubPath(bounds.getX() + 5, bounds.getCentreY());
-    path.lineTo(bounds.getRight() - 5, bounds.getCentreY());
-    
-    juce::PathStrokeType strokeType(2.0f);
-    if (getName() != "Solid")
-    {
-        strokeType.setStrokeThickness(1.0f);
-        strokeType.createDashedStroke(path, path, dashLengths, getName() == "Dotted" ? 2 : 4);
-    }
-        
-    g.strokePath(path, strokeType);
-}
-
-
-SelectionHandle::SelectionHandle()
-{
-    handleType = Type::TopLeft;
-}
-
-SelectionHandle::SelectionHandle(Type type)
-{
-    handleType = type;
-}
-
-SelectionHandle::SelectionHandle(const SelectionHandle& other)
-    : handleType(other.handleType)
-    , position(other.position)
-    , handleBounds(other.handleBounds)
-    , bounds_(other.bounds_)
-{
-}
-
-SelectionHandle& SelectionHandle::operator=(const SelectionHandle& other)
-{
-    if (this != &other)
-    {
-        handleType = other.handleType;
-        position = other.position;
-        handleBounds = other.handleBounds;
-        bounds_ = other.bounds_;
-    }
-    return *this;
-}
-
-juce::Point<float> SelectionHandle::rotatePointAround(juce::Point<float> point,
-                                            juce::Point<float> center,
-                                            float angleInRadians)
-{
-    float dx = point.x - center.x;
-    float dy = point.y - center.y;
-    
-    return juce::Point<float>(
-        center.x + (dx * std::cos(angleInRadians) - dy * std::sin(angleInRadians)),
-        center.y + (dx * std::sin(angleInRadians) + dy * std::cos(angleInRadians))
-    );
-}
-
-void SelectionHandle::updatePosition(const juce::Rectangle<float>& bounds, float rotationAngle, const juce::Point<float>& rotationCenter)
-{
-    const float handleSize = 8.0f;
-    const float rotateHandleOffset = 20.0f;
-    bounds_ = bounds;
-    
-    // Calculate handle position based on type
-    switch (handleType)
-    {
-        case Type::TopLeft:     position = bounds.getTopLeft(); break;
-        case Type::Top:         position = bounds.getCentre().withY(bounds.getY()); break;
-        case Type::TopRight:    position = bounds.getTopRight(); break;
-        case Type::Right:       position = bounds.getCentre().withX(bounds.getRight()); break;
-        case Type::BottomRight: position = bounds.getBottomRight(); break;
-        case Type::Bottom:      position = bounds.getCentre().withY(bounds.getBottom()); break;
-        case Type::BottomLeft:  position = bounds.getBottomLeft(); break;
-        case Type::Left:        position = bounds.getCentre().withX(bounds.getX()); break;
-        case Type::Rotate:
-            position = bounds.getCentre().withY(bounds.getY() - rotateHandleOffset);
-            break;
-    }
-
-    // Create handle bounds centered on position
-    handleBounds = juce::Rectangle<float>(handleSize, handleSize).withCentre(position);
-
-    // If there's rotation, rotate the handle position around the bounds center
-    if (rotationAngle != 0.0f && handleType != Type::Rotate)
-    {
-        auto rotated = rotatePointAround(position, rotationCenter, rotationAngle);
-        handleBounds = juce::Rectangle<float>(handleSize, handleSize).withCentre(rotated);
-    }
-}
-
-void SelectionHandle::paint(juce::Graphics& g)
-{
-    g.setColour(juce::Colours::white);
-    g.fillRect(handleBounds);
-    g.setColour(juce::Colours::black);
-    g.drawRect(handleBounds);
-
-    if (handleType == Type::Rotate)
-    {
-        // Draw a circular handle for rotation
-        g.drawEllipse(handleBounds.toFloat(), 1.0f);
-        
-        // Draw line connecting to the shape
-        g.drawLine(handleBounds.getCentreX(), handleBounds.getBottom(),
-                  handleBounds.getCentreX(), bounds_.getY());
-                  
-        // Draw rotation arrow icon above the handle
-        float iconSize = handleBounds.getWidth() * 1.25f;
-        juce::Rectangle<float> iconBounds(handleBounds.getCentreX() - iconSize/2,
-                                        handleBounds.getY() - iconSize - 4,
-                                        iconSize, iconSize);
-        
-        juce::Path arrow;
-        // Draw the circular arc
-        arrow.addArc(iconBounds.getX(),
-                    iconBounds.getY(),
-                    iconSize,  // radius
-                    iconSize,  // radius
-                    juce::MathConstants<float>::pi * 0.1f,   // startAngle
-                    juce::MathConstants<float>::pi * 1.6f,   // endAngle
-                    true);  // clockwise
-
-        // Calculate end point for arrow
-        float endAngle = juce::MathConstants<float>::pi * 1.6f;
-        float endX = iconBounds.getCentreX() + std::cos(endAngle) * iconSize * 0.5f;
-        float endY = iconBounds.getCentreY() + std::sin(endAngle) * iconSize * 0.5f;
-        
-        float dAngle = juce::MathConstants<float>::pi * 1.5f;
-        float dendX = iconBounds.getCentreX() + std::cos(dAngle) * iconSize * 0.5f;
-        float dendY = iconBounds.getCentreY() + std::sin(dAngle) * iconSize * 0.5f;
-        
-        arrow.addArrow(juce::Line<float>(
-            endX, endY,
-            dendX, dendY),
-            1.0f,  // line thickness
-            3.0f,  // arrow head width
-            4.0f); // arrow head length
-        
-        g.strokePath(arrow, juce::PathStrokeType(2.0f));
-    }
-}
-
-bool SelectionHandle::hitTest(juce::Point<float> point) const
-{
-    const float handleHitThreshold = 1.0f;
-    return handleBounds.expanded(handleHitThreshold).contains(point);
-}
-
-bool MainComponent::Shape::hitTest(juce::Point<float> point) const
-{
-    if (rotation != 0.0f)
-    {
-        // For rotated shapes, transform the test point back
-        point = SelectionHandle::rotatePointAround(point, bounds.getCentre(), -rotation);
-    }
-
-    switch (type)
-    {
-        case Tool::Rectangle:
-            return bounds.contains(point);
-            
-        case Tool::Ellipse:
-            return bounds.contains(point);
-                       
-        case Tool::Line:
-        {
-            float threshold = style.strokeWidth + 4.0f;
-            juce::Line<float> line(lineStart, lineEnd);
-            juce::Point<float> foundPoint;
-            return line.getDistanceFromPoint(point, foundPoint) < threshold;
-        }
-            
-        case Tool::Text:
-            return bounds.contains(point);
-            
-        default:
-            return false;
-    }
-}
-
-void MainComponent::Shape::initializeRotationCenter()
-{
-    if (type == Tool::Line) {
-        // For lines, use midpoint between start and end
-        rotationCenter = (lineStart + lineEnd) * 0.5f;
-    } else {
-        // For rectangles and ellipses, use bounds center
-        rotationCenter = bounds.getCentre();
-    }
-}
-
-void MainComponent::Shape::move(float dx, float dy)
-{
-    bounds.translate(dx, dy);
-    rotationCenter.addXY(dx, dy);
-    
-    if (type == Tool::Line)
-    {
-        lineStart.addXY(dx, dy);
-        lineEnd.addXY(dx, dy);
-    }
-}
-
-void MainComponent::Shape::drawText(juce::Graphics& g) const
-{
-    // Don't apply rotation here - it's handled by the main drawing code
-    g.setFont(font);
-    g.setColour(style.fillColour);
-
-    if (style.textStretchEnabled)
-    {
-        auto textBounds = g.getCurrentFont().getStringWidth(text);
-        float scaleX = bounds.getWidth() / textBounds;
-        float scaleY = bounds.getHeight() / font.getHeight();
-        
-        g.addTransform(juce::AffineTransform::scale(scaleX, scaleY)
-                      .translated(bounds.getX(), bounds.getY()));
-        g.drawText(text, 0, 0, textBounds, font.getHeight(),
-                  juce::Justification::left, true);
-    }
-    else
-    {
-        g.drawText(text, bounds.toType<int>(),
-                  juce::Justification::left, true);
-    }
-}
-
-
-MainComponent::MainComponent()
-{
-    setName("MainComponent");
-    
-    // Create the tool window
-    toolWindow = std::make_unique<ToolWindow>(*this);
-    
-    addAndMakeVisible(showToolsButton);
-    showToolsButton.setButtonText("Show Tools");
-    showToolsButton.onClick = [this]
-    {
-        showTools();
-    };
-    
-    // Set initial style
-    currentStyle.fillColour = juce::Colours::lightgrey;
-    currentStyle.strokeColour = juce::Colours::black;
-    currentStyle.strokeWidth = 0.0f;
-    currentStyle.strokePattern = StrokePattern::Solid;
-    currentStyle.hasFill = true;
-
-    // Enable keyboard listening
-    addKeyListener(this);
-    setWantsKeyboardFocus(true);
-}
-
-
-void MainComponent::paint(juce::Graphics& g)
-{
-    g.fillAll(juce::Colours::white);
-    
-    auto drawRect = [&](const juce::Rectangle<float>& bounds, const Style& style)
-    {
-        if (style.hasFill)
-        {
-            if (style.cornerRadius > 0.0f)
-                g.fillRoundedRectangle(bounds, style.cornerRadius);
-            else
-                g.fillRect(bounds);
-        }
-        
-        if (style.strokeWidth > 0.0f)
-        {
-            drawStrokedPath(g, style, [&]()
-            {
-                juce::Path path;
-                if (style.cornerRadius > 0.0f)
-                    path.addRoundedRectangle(bounds, style.cornerRadius);
-                else
-                    path.addRectangle(bounds);
-                return path;
-            });
-        }
-    };
-    
-    auto drawEllipse = [&](const juce::Rectangle<float>& bounds, const Style& style)
-    {
-        if (style.hasFill)
-            g.fillEllipse(bounds);
-        
-        if (style.strokeWidth > 0.0f)
-        {
-            drawStrokedPath(g, style, [&]()
-            {
-                juce::Path path;
-                path.addEllipse(bounds);
-                return path;
-            });
-        }
-    };
-    
-    auto drawLine = [&](const Shape& shape)
-    {
-        Style lineStyle = shape.style;
-        lineStyle.strokeWidth = std::max(1.0f, shape.style.strokeWidth);
-        
-        drawStrokedPath(g, lineStyle, [&]()
-        {
-            juce::Path path;
-            path.startNewSubPath(shape.lineStart);
-            path.lineTo(shape.lineEnd);
-            return path;
-        });
-    };
-    
-    // Draw all completed shapes
-    for (int i = 0; i < shapes.size(); ++i)
-    {
-        // Skip drawing the shape that's currently being edited
-        if (isEditingText && i == editingShapeIndex)
-            continue;
-            
-        const auto& shape = shapes.getReference(i);
-        applyStyle(g, shape.style);
-        
-        if (shape.rotation != 0.0f)
-        {
-            // Apply rotation transform
-            g.saveState();
-            g.addTransform(juce::AffineTransform::rotation(
-                shape.rotation,
-                shape.rotationCenter.x,
-                shape.rotationCenter.y));
-        }
-        
-        switch (shape.type)
-        {
-            case Tool::Rectangle:
-            {
-                drawRect(shape.bounds, shape.style);
-                break;
-            }
-            case Tool::Ellipse:
-            {
-                drawEllipse(shape.bounds, shape.style);
-                break;
-            }
-            case Tool::Line:
-            {
-                drawLine(shape);
-                break;
-            }
-            case Tool::Text:
-                shape.drawText(g);
-                break;
-            default:
-                break;
-        }
-        
-        // Restore original transform if we rotated
-        if (shape.rotation != 0.0f)
-        {
-            g.restoreState();
-        }
-    }
-    
-    // Draw current shape being created
-    if (isDrawing)
-    {
-        applyStyle(g, currentStyle);
-        
-        switch (currentTool)
-        {
-            case Tool::Rectangle:
-            {
-                auto bounds = juce::Rectangle<float>(dragStart, dragEnd);
-                drawRect(bounds, currentStyle);
-                break;
-            }
-            case Tool::Ellipse:
-            {
-                auto bounds = juce::Rectangle<float>(dragStart, dragEnd);
-                drawEllipse(bounds, currentStyle);
-                break;
-            }
-            case Tool::Line:
-            {
-                Shape previewShape;
-                previewShape.type = Tool::Line;
-                previewShape.style = currentStyle;
-                previewShape.lineStart = dragStart;
-                previewShape.lineEnd = dragEnd;
-                drawLine(previewShape);
-                break;
-            }
-            default:
-                break;
-        }
-    }
-    
-    // Draw selection indicators
-    if (selectedShapeIndex >= 0 && selectedShapeIndex < shapes.size())
-    {
-        auto& selectedShape = shapes.getReference(selectedShapeIndex);
-        
-        // Draw selection outline
-        g.setColour(juce::Colours::blue);
-        
-        if (selectedShape.rotation != 0.0f)
-        {
-            // For rotated shapes, we need to draw a rotated rectangle
-            juce::Path path;
-            path.addRectangle(selectedShape.bounds);
-            g.addTransform(juce::AffineTransform::rotation(
-                selectedShape.rotation,
-                selectedShape.rotationCenter.x,
-                selectedShape.rotationCenter.y));
-            g.strokePath(path, juce::PathStrokeType(1.5f, juce::PathStrokeType::mitered));
-            g.addTransform(juce::AffineTransform::rotation(
-                -selectedShape.rotation,
-                selectedShape.rotationCenter.x,
-                selectedShape.rotationCenter.y));
-        }
-        else
-        {
-            // For non-rotated shapes, just draw the bounds
-            g.drawRect(selectedShape.bounds, 1.5f);
-        }
-
-        // Draw selection handles
-        for (auto& handle : selectionHandles)
-            handle.paint(g);
-    }
-    
-    if (selectedShapeIndex >= 0 && selectedShapeIndex < shapes.size())
-    {
-        auto& selectedShape = shapes.getReference(selectedShapeIndex);
-        drawDimensionLabel(g, selectedShape);
-    }
-}
- 
-void MainComponent::resized()
-{
-    
-    // Position the button in the top-right corner
-    const int buttonWidth = 100;
-    const int buttonHeight = 30;
-    const int padding = 10;
-    
-    showToolsButton.setBounds(padding,
-                             padding,
-                             buttonWidth,
-                             buttonHeight);
-    
-}
-
-void MainComponent::mouseDown(const juce::MouseEvent& e)
-{
-    if (e.getMouseDownY() < showToolsButton.getBottom() + 10)
-        return;
-    
-    lastMousePosition = e.position;
-    
-    if (currentTool == Tool::Text)
-    {
-        // Start text editing
-        if (!isEditingText)
-        {
-            startTextEditing(e.position);
-        }
-        return;
-    }
-
-    if (currentTool == Tool::Select)
-    {
-        // Check for handle interaction first
-        for (int i = 0; i < selectionHandles.size(); ++i)
-        {
-            if (selectionHandles[i].hitTest(e.position))
-            {
-                isDraggingHandle = true;
-                activeHandle = selectionHandles[i].getType();
-                
-                if (activeHandle == SelectionHandle::Type::Rotate)
-                {
-                    prepareRotation(e, shapes.getReference(selectedShapeIndex));
-                }
-                return;
-            }
-        }
-
-        // Check for shape selection
-        bool foundShape = false;
-        for (int i = shapes.size() - 1; i >= 0; --i)
-        {
-            if (shapes[i].hitTest(e.position))
-            {
-                if (selectedShapeIndex != i) // Only update if selecting a different shape
-                {
-                    selectedShapeIndex = i;
-                    updateSelectionHandles();
-                }
-                isDraggingShape = true;
-                foundShape = true;
-                break;
-            }
-        }
-        
-        if (!foundShape && selectedShapeIndex != -1)
-        {
-            deselectAllShapes();
-        }
-        else if (foundShape)
-        {
-            updateToolPanelFromShape(&shapes.getReference(selectedShapeIndex));
-        }
-    }
-    else
-    {
-        isDrawing = true;
-        dragStart = e.position;
-        dragEnd = e.position;
-    }
-}
-
-void MainComponent::mouseDoubleClick(const juce::MouseEvent& e)
-{
-    if (currentTool == Tool::Select)
-    {
-        // Check each shape for a hit
-        for (int i = shapes.size() - 1; i >= 0; --i)
-        {
-            if (shapes[i].hitTest(e.position) && shapes[i].type == Tool::Text)
-            {
-                startTextEditing(e.position, &shapes.getReference(i));
-                break;
-            }
-        }
-    }
-}
-
-void MainComponent::mouseDrag(const juce::MouseEvent& e)
-{
-    if (currentTool == Tool::Select)
-    {
-        handleShapeManipulation(e);
-    }
-    else if (isDrawing)
-    {
-        dragEnd = e.position;
-        repaint();
-    }
-}
-
-void MainComponent::mouseUp(const juce::MouseEvent& e)
-{
-    if (currentTool == Tool::Select)
-    {
-        isDraggingShape = false;
-        isDraggingHandle = false;
-    }
-    else if (isDrawing)
-    {
-        isDrawing = false;
-        
-        Shape shape;
-        shape.type = currentTool;
-        shape.style = currentStyle;
-        
-        if (currentTool == Tool::Line)
-        {
-            // For lines, store actual start and end points
-            shape.lineStart = dragStart;
-            shape.lineEnd = dragEnd;
-            
-            // Create bounds that encompass the line
-            float left = std::min(dragStart.x, dragEnd.x);
-            float right = std::max(dragStart.x, dragEnd.x);
-            float top = std::min(dragStart.y, dragEnd.y);
-            float bottom = std::max(dragStart.y, dragEnd.y);
-            
-            // Add some padding for hit testing
-            shape.bounds = juce::Rectangle<float>(left, top,
-                                                right - left,
-                                                bottom - top);
-        }
-        else
-        {
-            shape.bounds = juce::Rectangle<float>(dragStart, dragEnd);
-        }
-        
-        shape.initializeRotationCenter();
-        shapes.add(shape);
-        repaint();
-    }
-}
-
-void MainComponent::handleShapeManipulation(const juce::MouseEvent& e)
-{
-    if (selectedShapeIndex >= 0 && selectedShapeIndex < shapes.size())
-    {
-        auto delta = e.position - lastMousePosition;
-        auto& shape = shapes.getReference(selectedShapeIndex);
-
-        if (isDraggingHandle)
-        {
-            if (activeHandle == SelectionHandle::Type::Rotate)
-                rotateShape(e);
-            else
-                resizeShape(e);
-        }
-        else if (isDraggingShape)
-        {
-            // Move the shape
-            shape.move(delta.x, delta.y);
-            updateSelectionHandles();
-        }
-
-        repaint();
-    }
-
-    lastMousePosition = e.position;
-}
-
-void MainComponent::rotateShape(const juce::MouseEvent& e)
-{
-    auto& shape = shapes.getReference(selectedShapeIndex);
-    
-    // Calculate current angle relative to the stored rotation center
-    float currentAngle = std::atan2(e.position.y - shape.rotationCenter.y,
-                                    e.position.x - shape.rotationCenter.x);
-    
-    // Update shape rotation
-    shape.rotation = initialRotation + (currentAngle - initialAngle);
-    
-    updateSelectionHandles();
-}
-
-void MainComponent::resizeShape(const juce::MouseEvent& e)
-{
-    auto& shape = shapes.getReference(selectedShapeIndex);
-    auto delta = e.position - lastMousePosition;
-
-    // Transform the delta based on rotation
-    float cosAngle = std::cos(-shape.rotation);
-    float sinAngle = std::sin(-shape.rotation);
-    
-    // Rotate the delta vector to account for shape rotation
-    float transformedDeltaX = delta.x * cosAngle - delta.y * sinAngle;
-    float transformedDeltaY = delta.x * sinAngle + delta.y * cosAngle;
-    
-    // Create transformed delta
-    juce::Point<float> transformedDelta(transformedDeltaX, transformedDeltaY);
-
-    if (shape.type == Tool::Text && !shape.style.textStretchEnabled)
-    {
-        // For text, only allow moving without resizing (Figma-like behavior)
-        shape.bounds.translate(transformedDelta.x, transformedDelta.y);
-    }
-    else if (shape.type == Tool::Line)
-    {
-        // For lines, we need to update the actual line points
-        switch (activeHandle)
-        {
-            case SelectionHandle::Type::TopLeft:
-                shape.lineStart.addXY(delta.x, delta.y);
-                break;
-            case SelectionHandle::Type::BottomRight:
-                shape.lineEnd.addXY(delta.x, delta.y);
-                break;
-            default:
-                break;
-        }
-        
-        // Update bounds to encompass the new line position
-        float left = std::min(shape.lineStart.x, shape.lineEnd.x);
-        float right = std::max(shape.lineStart.x, shape.lineEnd.x);
-        float top = std::min(shape.lineStart.y, shape.lineEnd.y);
-        float bottom = std::max(shape.lineStart.y, shape.lineEnd.y);
-        
-        shape.bounds = juce::Rectangle<float>(left, top, right - left, bottom - top);
-    }
-    else
-    {
-        // Handle resizing based on the active handle
-        switch (activeHandle)
-        {
-            case SelectionHandle::Type::TopLeft:
-                shape.bounds.setTop(shape.bounds.getY() + transformedDelta.y);
-                shape.bounds.setLeft(shape.bounds.getX() + transformedDelta.x);
-                break;
-            case SelectionHandle::Type::Top:
-                shape.bounds.setTop(shape.bounds.getY() + transformedDelta.y);
-                break;
-            case SelectionHandle::Type::TopRight:
-                shape.bounds.setTop(shape.bounds.getY() + transformedDelta.y);
-                shape.bounds.setRight(shape.bounds.getRight() + transformedDelta.x);
-                break;
-            case SelectionHandle::Type::Right:
-                shape.bounds.setRight(shape.bounds.getRight() + transformedDelta.x);
-                break;
-            case SelectionHandle::Type::BottomRight:
-                shape.bounds.setBottom(shape.bounds.getBottom() + transformedDelta.y);
-                shape.bounds.setRight(shape.bounds.getRight() + transformedDelta.x);
-                break;
-            case SelectionHandle::Type::Bottom:
-                shape.bounds.setBottom(shape.bounds.getBottom() + transformedDelta.y);
-                break;
-            case SelectionHandle::Type::BottomLeft:
-                shape.bounds.setBottom(shape.bounds.getBottom() + transformedDelta.y);
-                shape.bounds.setLeft(shape.bounds.getX() + transformedDelta.x);
-                break;
-            case SelectionHandle::Type::Left:
-                shape.bounds.setLeft(shape.bounds.getX() + transformedDelta.x);
-                break;
-            default:
-                break;
-        }
-    }
-
-    updateSelectionHandles();
-    
-    if (toolWindow != nullptr)
-        toolWindow->getToolPanel().updateDimensionEditors(&shape);
-}
-
-void MainComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
-{
-    if (auto* cs = dynamic_cast<juce::ColourSelector*>(source))
-    {
-        if (currentlyEditingFillColour)
-        {
-            currentStyle.fillColour = cs->getCurrentColour();
-        }
-        else
-        {
-            currentStyle.strokeColour = cs->getCurrentColour();
-        }
-        repaint();
-    }
-}
-
-bool MainComponent::keyPressed(const juce::KeyPress& key, Component* /*originatingComponent*/)
-{
-    if (selectedShapeIndex >= 0 && selectedShapeIndex < shapes.size())
-    {
-        auto& shape = shapes.getReference(selectedShapeIndex);
-        
-        if (key == juce::KeyPress::deleteKey || key == juce::KeyPress::backspaceKey)
-        {
-            shapes.remove(selectedShapeIndex);
-            selectedShapeIndex = -1;
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::leftKey) && key.getModifiers().isShiftDown())
-        {
-            shape.move(-10.0f, 0.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::rightKey) && key.getModifiers().isShiftDown())
-        {
-            shape.move(10.0f, 0.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::upKey) && key.getModifiers().isShiftDown())
-        {
-            shape.move(0.0f, -10.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::downKey) && key.getModifiers().isShiftDown())
-        {
-            shape.move(0.0f, 10.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::leftKey))
-        {
-            shape.move(-1.0f, 0.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::rightKey))
-        {
-            shape.move(1.0f, 0.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::upKey))
-        {
-            shape.move(0.0f, -1.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-        else if (key.isKeyCode(juce::KeyPress::downKey))
-        {
-            shape.move(0.0f, 1.0f);
-            updateSelectionHandles();
-            repaint();
-            return true;
-        }
-    }
-    
-    return false;
-}
-
-bool MainComponent::keyStateChanged(bool isKeyDown, Component *originatingComponent)
-{
-    return false;
-}
-
-void MainComponent::deselectAllShapes()
-{
-    selectedShapeIndex = -1;
-    updateSelectionHandles();
-    updateToolPanelFromShape(nullptr);
-}
-
-void MainComponent::setCurrentTool(Tool tool)
-{
-    currentTool = tool;
-    if (tool != Tool::Select)
-        deselectAllShapes();
-}
-
-void MainComponent::setFillEnabled(bool enabled)
-{
-    currentStyle.hasFill = enabled;
-    repaint();
-}
-
-void MainComponent::setFillColour(juce::Colour colour)
-{
-    currentStyle.fillColour = colour;
-    repaint();
-}
-
-void MainComponent::setStrokeColour(juce::Colour colour)
-{
-    currentStyle.strokeColour = colour;
-    repaint();
-}
-
-void MainComponent::setStrokeWidth(float width)
-{
-    if (currentTool == Tool::Line)
-        width = std::max(1.0f, width);
-    
-    currentStyle.strokeWidth = width;
-    repaint();
-}
-
-void MainComponent::setCornerRadius(float radius)
-{
-    currentStyle.cornerRadius = radius;
-    repaint();
-}
-
-void MainComponent::setStrokePattern(StrokePattern pattern)
-{
-    currentStyle.strokePattern = pattern;
-    repaint();
-}
-
-void MainComponent::updateSelectedShapeFill(bool enabled)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        shapes.getReference(selectedShapeIndex).style.hasFill = enabled;
-        repaint();
-    }
-    // Still update current style for new shapes
-    currentStyle.hasFill = enabled;
-}
-
-void MainComponent::updateSelectedShapeFillColour(juce::Colour colour)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        shapes.getReference(selectedShapeIndex).style.fillColour = colour;
-        repaint();
-    }
-    currentStyle.fillColour = colour;
-}
-
-void MainComponent::updateSelectedShapeStrokeColour(juce::Colour colour)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        shapes.getReference(selectedShapeIndex).style.strokeColour = colour;
-        repaint();
-    }
-    currentStyle.strokeColour = colour;
-}
-
-void MainComponent::updateSelectedShapeStrokeWidth(float width)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        auto& shape = shapes.getReference(selectedShapeIndex);
-        if (shape.type == Tool::Line)
-            width = std::max(1.0f, width);
-        shape.style.strokeWidth = width;
-        repaint();
-    }
-    currentStyle.strokeWidth = width;
-}
-
-void MainComponent::updateSelectedShapeCornerRadius(float radius)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        shapes.getReference(selectedShapeIndex).style.cornerRadius = radius;
-        repaint();
-    }
-    currentStyle.cornerRadius = radius;
-}
-
-void MainComponent::updateSelectedShapeStrokePattern(StrokePattern pattern)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        shapes.getReference(selectedShapeIndex).style.strokePattern = pattern;
-        repaint();
-    }
-    currentStyle.strokePattern = pattern;
-}
-
-void MainComponent::updateSelectedShapeFontSize(float size)
-{
-    if (selectedShapeIndex >= 0)
-    {
-        auto& shape = shapes.getReference(selectedShapeIndex);
-        if (shape.type == Tool::Text)
-        {
-            shape.style.fontSize = size;
-            shape.font.setHeight(size);
-            
-            // Recalculate bounds based on new font size
-            auto width = shape.font.getStringWidth(shape.text);
-            auto height = shape.font.getHeight();
-            shape.bounds.setSize(width, height);
-            
-            updateSelectionHandles();
-            repaint();
-        }
-    }
-    currentStyle.fontSize = size;
-}
-
-const MainComponent::Shape* MainComponent::getSelectedShape() const
-{
-    return selectedShapeIndex >= 0 ? &shapes.getReference(selectedShapeIndex): nullptr;
-}
-
-void MainComponent::updateSelectedShapeBounds(const juce::Rectangle<float>& newBounds)
-{
-    if (selectedShapeIndex >= 0 && selectedShapeIndex < shapes.size())
-    {
-        shapes.getReference(selectedShapeIndex).bounds = newBounds;
-        updateSelectionHandles();
-        repaint();
-    }
-}
-
-void MainComponent::startTextEditing(juce::Point<float> position, const Shape* existingShape)
-{
-    isEditingText = true;
-    isEditingExistingText = (existingShape != nullptr);
-    
-    // Store the index of the shape being edited
-    if (existingShape)
-    {
-        for (int i = 0; i < shapes.size(); ++i)
-        {
-            if (&shapes.getReference(i) == existingShape)
-            {
-                editingShapeIndex = i;
-                break;
-            }
-        }
-    }
-    
-    // Create and set up text editor
-    textEditor = std::make_unique<juce::TextEditor>("textEntry");
-    textEditor->setMultiLine(true, false);
-    textEditor->setReturnKeyStartsNewLine(false);
-    textEditor->setScrollbarsShown(false);
-    
-    // Set up font and style
-    juce::Font editorFont;
-    if (existingShape)
-    {
-        editorFont = existingShape->font;
-        textEditor->setColour(juce::TextEditor::textColourId, existingShape->style.fillColour);
-    }
-    else
-    {
-        editorFont = juce::Font(currentStyle.fontFamily, currentStyle.fontSize, juce::Font::plain);
-        textEditor->setColour(juce::TextEditor::textColourId, currentStyle.fillColour);
-    }
-    textEditor->setFont(editorFont);
-    
-    // Remove ALL possible sources of offset
-    textEditor->setBorder(juce::BorderSize<int>(0));
-    textEditor->setIndents(0, 0);
-    textEditor->setJustification(juce::Justification::topLeft);
-    textEditor->setLineSpacing(1.0f);
-    
-    // Make it transparent
-    textEditor->setColour(juce::TextEditor::backgroundColourId, juce::Colours::transparentWhite);
-    textEditor->setColour(juce::TextEditor::outlineColourId, juce::Colours::transparentWhite);
-    textEditor->setColour(juce::TextEditor::focusedOutlineColourId, juce::Colours::transparentWhite);
-    textEditor->setColour(juce::TextEditor::highlightColourId, juce::Colours::lightblue.withAlpha(0.3f));
-    
-    // Set position and initial size
-    if (existingShape)
-    {
-        auto bounds = existingShape->bounds;
-        textEditor->setBounds(bounds.toType<int>());
-        textEditor->setText(existingShape->text, false);
-        textEditor->selectAll();
-
-        // Apply rotation if the text is rotated
-        if (existingShape->rotation != 0.0f)
-        {
-            textEditor->setTransform(juce::AffineTransform::rotation(
-                existingShape->rotation,
-                existingShape->rotationCenter.x,
-                existingShape->rotationCenter.y));
-        }
-    }
-    else
-    {
-        // Initial size for new text
-        const float initialWidth = 200.0f;
-        currentEditorHeight = editorFont.getHeight();
-        textEditor->setBounds(position.x, position.y, initialWidth, currentEditorHeight);
-    }
-    
-    addAndMakeVisible(textEditor.get());
-    textEditor->grabKeyboardFocus();
-    
-    // Add text change listener to handle auto-resize
-    textEditor->onTextChange = [this]()
-    {
-        updateTextEditorSize();
-    };
-    
-    textEditor->onReturnKey = [this]()
-    {
-        finishTextEditing();
-    };
-    
-    textEditor->onFocusLost = [this]()
-    {
-        finishTextEditing();
-    };
-}
-
-void MainComponent::updateTextEditorSize()
-{
-    if (!textEditor)
-        return;
-    
-    // Store current transform before resizing
-    auto currentTransform = textEditor->getTransform();
-    
-    // Get current bounds to maintain position
-    auto bounds = textEditor->getBounds();
-    
-    // Calculate width based on actual text content using the font
-    juce::String currentText = textEditor->getText();
-    float textWidth = textEditor->getFont().getStringWidthFloat(currentText);
-    float newWidth;
-    
-    if (isEditingExistingText)
-    {
-        newWidth = textWidth + 10.0f;
-    }
-    else
-    {
-        newWidth = std::max(200.0f, textWidth + 10.0f);
-    }
-    
-    float textHeight = textEditor->getTextHeight();
-    
-    // Update editor bounds while maintaining position
-    textEditor->setBounds(bounds.getX(), bounds.getY(),
-                         newWidth, textHeight);
-    
-    // Reapply the transform after resizing
-    textEditor->setTransform(currentTransform);
-    
-    currentEditorHeight = textHeight;
-
-    // Update shape bounds if editing existing
-    if (isEditingExistingText && editingShapeIndex >= 0)
-    {
-        auto& shape = shapes.getReference(editingShapeIndex);
-        
-        // Store rotation info
-        float rotation = shape.rotation;
-        juce::Point<float> rotationCenter = shape.rotationCenter;
-        
-        // Update bounds to match new text size
-        shape.bounds.setSize(newWidth, textHeight);
-        
-        // Maintain rotation
-        shape.rotation = rotation;
-        shape.rotationCenter = rotationCenter;
-        
-        // Update selection handles to match new bounds
-        updateSelectionHandles();
-    }
-    
-    repaint();
-}
-
-void MainComponent::finishTextEditing()
-{
-    if (!isEditingText || textEditor == nullptr)
-        return;
-        
-    juce::String newText = textEditor->getText();
-    if (newText.isNotEmpty())
-    {
-        if (isEditingExistingText && editingShapeIndex >= 0)
-        {
-            // Update existing shape
-            auto& existingShape = shapes.getReference(editingShapeIndex);
-            
-            // Store rotation info
-            float rotation = existingShape.rotation;
-            juce::Point<float> rotationCenter = existingShape.rotationCenter;
-            
-            // Update text and recalculate bounds
-            existingShape.text = newText;
-            float width = existingShape.font.getStringWidthFloat(newText);
-            float height = existingShape.font.getHeight();
-            
-            existingShape.bounds.setSize(width, height);
-            
-            // Restore rotation
-            existingShape.rotation = rotation;
-            existingShape.rotationCenter = rotationCenter;
-            
-            updateSelectionHandles();
-        }
-        else
-        {
-            // Create new shape (existing code for new text creation)
-            Shape textShape;
-            textShape.type = Tool::Text;
-            textShape.text = newText;
-            textShape.style = currentStyle;
-            textShape.font = textEditor->getFont();
-            
-            auto width = textShape.font.getStringWidthFloat(newText);
-            float ascent = textShape.font.getAscent();
-            float descent = textShape.font.getDescent();
-            float height = ascent + descent;
-            
-            auto editorBounds = textEditor->getBounds().toFloat();
-            textShape.bounds = juce::Rectangle<float>(
-                editorBounds.getX(),
-                editorBounds.getY(),
-                width,
-                height);
-                
-            textShape.initializeRotationCenter();
-            shapes.add(textShape);
-        }
-    }
-    
-    removeChildComponent(textEditor.get());
-    textEditor = nullptr;
-    isEditingText = false;
-    isEditingExistingText = false;  // Reset the flag
-    editingShapeIndex = -1;  // Reset the editing index
-    repaint();
-}
-
-void MainComponent::updateToolPanelFromShape(const Shape* shape)
-{
-    if (toolWindow != nullptr)
-    {
-        auto& toolPanel = toolWindow->getToolPanel();
-        toolPanel.updateFromShape(shape);
-    }
-}
-
-void MainComponent::drawDimensionLabel(juce::Graphics& g, const Shape& shape)
-{
-    // Don't show dimensions for lines
-    if (shape.type == Tool::Line)
-        return;
-
-    // Format dimension text
-    juce::String dimensionText;
-    int width = static_cast<int>(std::abs(shape.bounds.getWidth()));
-    int height = static_cast<int>(std::abs(shape.bounds.getHeight()));
-    dimensionText = juce::String(width) + " × " + juce::String(height);
-
-    // Set up text appearance
-    g.setFont(14.0f);
-
-    // Position text below the shape
-    float centreX = shape.bounds.getCentreX();
-    float textY = shape.bounds.getBottom() + 15.0f;
-
-    // Draw with a light background for better visibility
-    float textWidth = g.getCurrentFont().getStringWidthFloat(dimensionText) * 1.3f;
-    float textHeight = g.getCurrentFont().getHeight() * 1.3f;
-    juce::Rectangle<float> textBounds(centreX - textWidth / 2, textY, textWidth, textHeight);
-    
-    // Save the current graphics state before rotation
-    juce::Graphics::ScopedSaveState stateSave(g);
-    
-    // Calculate the adjusted rotation angle to keep text readable
-    float adjustedRotation = shape.rotation;
-    
-    // Normalize the rotation angle to be between -180 and 180 degrees
-    while (adjustedRotation > juce::MathConstants<float>::pi)
-        adjustedRotation -= 2.0f * juce::MathConstants<float>::pi;
-    while (adjustedRotation < -juce::MathConstants<float>::pi)
-        adjustedRotation += 2.0f * juce::MathConstants<float>::pi;
-    
-    bool flipText = false;
-    // If rotation is beyond ±90 degrees, flip the text by 180 degrees
-    if (adjustedRotation > juce::MathConstants<float>::halfPi ||
-        adjustedRotation < -juce::MathConstants<float>::halfPi)
-    {
-        flipText = true;
-    }
-    
-    // Apply the same rotation as the shape
-    if (shape.rotation != 0.0f)
-    {
-        g.addTransform(juce::AffineTransform::rotation(
-            shape.rotation,
-            shape.rotationCenter.x,
-            shape.rotationCenter.y));
-    }
-    
-    //Check if we need to flip the text, to make sure its not upside-down.
-    if (flipText)
-    {
-        g.addTransform(juce::AffineTransform::rotation(
-           juce::MathConstants<float>::pi,
-           textBounds.getCentreX(),
-           textBounds.getCentreY()));
-    }
-    
-    g.setColour(juce::Colours::blue);
-    g.fillRect(textBounds);
-    
-    g.setColour(juce::Colours::white);
-    g.drawText(dimensionText, textBounds, juce::Justification::centred, false);
-}
-
-void MainComponent::showTools()
-{
-    if (toolWindow != nullptr)
-    {
-        toolWindow->setVisible(true);
-        toolWindow->toFront(true);
-    }
-}
-
-void MainComponent::prepareRotation(const juce::MouseEvent& e, MainComponent::Shape& shape)
-{
-    // Get the corners of the bounding rectangle
-    auto topLeft = shape.bounds.getTopLeft();
-    auto topRight = shape.bounds.getTopRight();
-    auto bottomLeft = shape.bounds.getBottomLeft();
-    auto bottomRight = shape.bounds.getBottomRight();
-    
-    // Rotate all corners around the current rotation center using the current rotation
-    auto rotatePoint = [&shape](juce::Point<float> point) {
-        return SelectionHandle::rotatePointAround(point, shape.rotationCenter, shape.rotation);
-    };
-    
-    auto rotatedTopLeft = rotatePoint(topLeft);
-    auto rotatedTopRight = rotatePoint(topRight);
-    auto rotatedBottomLeft = rotatePoint(bottomLeft);
-    auto rotatedBottomRight = rotatePoint(bottomRight);
-    
-    juce::Point<float> tempCenter = {
-        (rotatedTopLeft.x + rotatedTopRight.x + rotatedBottomLeft.x + rotatedBottomRight.x) / 4.0f,
-        (rotatedTopLeft.y + rotatedTopRight.y + rotatedBottomLeft.y + rotatedBottomRight.y) / 4.0f
-    };
-    
-    auto rotatePointReverse = [&shape, tempCenter](juce::Point<float> point) {
-        return SelectionHandle::rotatePointAround(point, tempCenter, -shape.rotation);
-    };
-    
-    rotatedTopLeft = rotatePointReverse(rotatedTopLeft);
-    rotatedTopRight = rotatePointReverse(rotatedTopRight);
-    rotatedBottomLeft = rotatePointReverse(rotatedBottomLeft);
-    rotatedBottomRight = rotatePointReverse(rotatedBottomRight);
-    
-    //Create new bounds from the back-rotated rectangle:
-    shape.bounds = juce::Rectangle<float>(rotatedTopLeft, rotatedBottomRight);
-    
-    // Calculate the center of the back-rotated rectangle
-    shape.rotationCenter = {
-        (rotatedTopLeft.x + rotatedTopRight.x + rotatedBottomLeft.x + rotatedBottomRight.x) / 4.0f,
-        (rotatedTopLeft.y + rotatedTopRight.y + rotatedBottomLeft.y + rotatedBottomRight.y) / 4.0f
-    };
-    
-    // Store initial angle for rotation
-    initialAngle = std::atan2(e.position.y - shape.rotationCenter.y,
-                             e.position.x - shape.rotationCenter.x);
-    initialRotation = shape.rotation;
-}
-
-
-void MainComponent::applyStyle(juce::Graphics& g, const Style& style)
-{
-    g.setColour(style.fillColour);
-}
-
-template<typename PathFunction>
-void MainComponent::drawStrokedPath(juce::Graphics& g, const Style& style, PathFunction&& pathFunc)
-{
-    g.setColour(style.strokeColour);
-    
-    // Get the path from the lambda
-    juce::Path path = pathFunc();
-    
-    if (style.strokePattern == StrokePattern::Solid)
-    {
-        juce::PathStrokeType strokeType(
-            style.strokeWidth,
-            juce::PathStrokeType::mitered,     // Joint style
-            juce::PathStrokeType::square   // End cap style
-        );
-        g.strokePath(path, strokeType);
-    }
-    else
-    {
-        float dashLengths[6];
-        int numDashLengths;
-        
-        // Scale dash lengths based on stroke width to maintain visible pattern
-        float scale = juce::jmax(1.0f, style.strokeWidth * 0.5f);
-        scale = 1.0f;
-        
-        switch (style.strokePattern)
-        {
-            case StrokePattern::Dashed:
-                dashLengths[0] = 12.0f * scale;  // Dash length
-                dashLengths[1] = 6.0f * scale;   // Gap length
-                numDashLengths = 2;
-                break;
-                
-            case StrokePattern::Dotted:
-                dashLengths[0] = 2.0f * scale;   // Dot length
-                dashLengths[1] = 4.0f * scale;   // Gap length
-                numDashLengths = 2;
-                break;
-                
-            case StrokePattern::DashDot:
-                dashLengths[0] = 12.0f * scale;  // Dash length
-                dashLengths[1] = 6.0f * scale;   // Gap length
-                dashLengths[2] = 2.0f * scale;   // Dot length
-                dashLengths[3] = 6.0f * scale;   // Gap length
-                numDashLengths = 4;
-                break;
-                
-            default:
-                numDashLengths = 0;
-                break;
-        }
-        
-        juce::Path dashedPath;
-        juce::PathStrokeType strokeType(
-            style.strokeWidth * 0.5f,
-            juce::PathStrokeType::mitered,     // Joint style
-            juce::PathStrokeType::butt   // End cap style
-        );
-        
-        strokeType.createDashedStroke(dashedPath, path, dashLengths, numDashLengths);
-        g.strokePath(dashedPath, strokeType);
-    }
-}
-
-void MainComponent::updateSelectionHandles()
-{
-    if (selectedShapeIndex >= 0 && selectedShapeIndex < shapes.size())
-    {
-        selectionHandles.clear();
-        const auto& shape = shapes[selectedShapeIndex];
-
-        if (shape.type == Tool::Line)
-        {
-            // For lines, only show handles at the endpoints
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::TopLeft));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::BottomRight));
-            
-            // Update handle positions for line endpoints
-            for (auto& handle : selectionHandles)
-            {
-                if (handle.getType() == SelectionHandle::Type::TopLeft)
-                {
-                    handle.updatePosition(juce::Rectangle<float>(shape.lineStart.x - 4,
-                                                               shape.lineStart.y - 4,
-                                                               8, 8),
-                                        shape.rotation,
-                                        shape.rotationCenter);
-                }
-                else // BottomRight
-                {
-                    handle.updatePosition(juce::Rectangle<float>(shape.lineEnd.x - 4,
-                                                               shape.lineEnd.y - 4,
-                                                               8, 8),
-                                        shape.rotation,
-                                        shape.rotationCenter);
-                }
-            }
-        }
-        else
-        {
-            // Add resize handles
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::TopLeft));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Top));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::TopRight));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Right));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::BottomRight));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Bottom));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::BottomLeft));
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Left));
-             
-            // Add rotation handle
-            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Rotate));
-
-            // Update handle positions
-            for (auto& handle : selectionHandles)
-                handle.updatePosition(shape.bounds, shape.rotation, shape.rotationCenter);
-        }
-    }
-    else
-    {
-        selectionHandles.clear();
-    }
-    
-    repaint();
-}
-
-//==================================================================
-
-ColorPickerWindow::ColorPickerWindow(const juce::String& name,
-                                     juce::Colour initialColor,
-                                    std::function<void(juce::Colour)> colorCallback)
-    : DocumentWindow(name, juce::Colours::lightgrey,
-                    DocumentWindow::closeButton | DocumentWindow::minimiseButton)
-{
-    colorSelector = std::make_unique<juce::ColourSelector>(
-        juce::ColourSelector::showColourspace |
-        juce::ColourSelector::showAlphaChannel |
-        juce::ColourSelector::showColourAtTop |
-        juce::ColourSelector::editableColour);
-    colorSelector->setCurrentColour(initialColor);
-    colorSelector->setSize(300, 400);
-    
-    colorSelector->addChangeListener(this);
-    this->colorCallback = std::move(colorCallback);
-    
-    setContentNonOwned(colorSelector.get(), true);
-    setUsingNativeTitleBar(true);
-    setResizable(true, false);
-    setAlwaysOnTop(true);
-    
-    centreWithSize(getWidth(), getHeight());
-    setVisible(true);
-    toFront(true);
-}
-
-void ColorPickerWindow::closeButtonPressed()
-{
-    setVisible(false);
-}
-
-void ColorPickerWindow::changeListenerCallback(juce::ChangeBroadcaster*)
-{
-    if (colorCallback)
-        colorCallback(colorSelector->getCurrentColour());
-}
-
-
-//-----------------------------------
-
-ToolPanel::ToolPanel(MainComponent& mainComponent) : owner(mainComponent)
-{
- 
-    auto setupButton = [this](juce::TextButton& b, const juce::String& text)
-    {
-        b.setButtonText(text);
-        b.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
-        b.setColour(juce::TextButton::textColourOffId, juce::Colours::black);
-        b.setColour(juce::TextButton::buttonColourId, juce::Colours::white);
-        b.setColour(juce::TextButton::buttonOnColourId, juce::Colours::grey);
-        addAndMakeVisible(b);
-
-    };
-    
-    auto setupShapeButton = [this, setupButton](juce::TextButton& b, const juce::String& text)
-    {
-        setupButton(b, text);
-        b.setClickingTogglesState(true);
-        b.setRadioGroupId(2);
-    };
-    
-    setupShapeButton(selectButton, "Select");
-    setupShapeButton(rectangleButton, "Rectangle");
-    setupShapeButton(ellipseButton, "Ellipse");
-    setupShapeButton(lineButton, "Line");
-    
-    selectButton.onClick = [this]
-    {
-        owner.setCurrentTool(MainComponent::Tool::Select);
-    };
-    rectangleButton.onClick = [this]
-    {
-        owner.setCurrentTool(MainComponent::Tool::Rectangle);
-    };
-    ellipseButton.onClick = [this]
-    {
-        owner.setCurrentTool(MainComponent::Tool::Ellipse);
-    };
-    lineButton.onClick = [this]
-    {
-        owner.setCurrentTool(MainComponent::Tool::Line);
-    };
-
-    auto addLabel = [this](juce::Label& label, const juce::String& text)
-    {
-        label.setText(text, juce::dontSendNotification);
-        label.setColour(juce::Label::textColourId, juce::Colours::black);
-        addAndMakeVisible(label);
-    };
-    
-    strokeWidthSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
-    addAndMakeVisible(strokeWidthSlider);
-    cornerRadiusSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
-    addAndMakeVisible(cornerRadiusSlider);
-
-
-    fillToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
-    fillToggle.setColour(juce::ToggleButton::tickColourId, juce::Colours::black);
-    fillToggle.setColour(juce::ToggleButton::tickDisabledColourId, juce::Colours::black);
-    addAndMakeVisible(fillToggle);
-
-    
-    addAndMakeVisible(solidStrokeButton);
-    addAndMakeVisible(dashedStrokeButton);
-    addAndMakeVisible(dottedStrokeButton);
-    addAndMakeVisible(dashDotStrokeButton);
-    
-    setupButton(fillColorButton, "Fill Color");
-    setupButton(strokeColorButton, "Stroke Color");
-    
-    // Set up slider listeners
-    strokeWidthSlider.onValueChange = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeStrokeWidth((float)strokeWidthSlider.getValue());
-    };
-
-    cornerRadiusSlider.onValueChange = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeCornerRadius((float)cornerRadiusSlider.getValue());
-    };
-    
-    // stroke pattern button callbacks:
-    solidStrokeButton.onClick = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::Solid);
-    };
-
-    dashedStrokeButton.onClick = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::Dashed);
-    };
-
-    dottedStrokeButton.onClick = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::Dotted);
-    };
-
-    dashDotStrokeButton.onClick = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::DashDot);
-    };
-
-
-    // Set up slider properties
-    strokeWidthSlider.setRange(0.0, 20.0, 1.0);
-    strokeWidthSlider.setValue(0.0);
-    //strokeWidthSlider.addListener(&owner);
-    
-    cornerRadiusSlider.setRange(0.0, 50.0, 1.0);
-    cornerRadiusSlider.setValue(0.0);
-    //cornerRadiusSlider.addListener(&owner);
-    
-    // Labels
-    addLabel(strokeWidthLabel, "Stroke Width");
-    strokeWidthLabel.attachToComponent(&strokeWidthSlider, true);
-
-    addLabel(cornerRadiusLabel, "Corner Radius");
-    cornerRadiusLabel.attachToComponent(&cornerRadiusSlider, true);
-    
-    addLabel(fillColorLabel, "Fill Color");
-    addLabel(strokeColorLabel, "Stroke Color");
-    
-    // Color buttons
-    fillColorButton.onClick = [this]
-    {
-        showColorPicker(true);
-    };
-    strokeColorButton.onClick = [this]
-    {
-        showColorPicker(false);
-    };
-    
-    // Fill toggle
-    fillToggle.setButtonText("Enable Fill");
-    fillToggle.setToggleState(true, juce::dontSendNotification);
-    fillToggle.onClick = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeFill(fillToggle.getToggleState());
-    };
-
-    // Stroke pattern buttons setup
-    solidStrokeButton.setRadioGroupId(1);
-    solidStrokeButton.setClickingTogglesState(true);
-    dashedStrokeButton.setRadioGroupId(1);
-    dashedStrokeButton.setClickingTogglesState(true);
-    dottedStrokeButton.setRadioGroupId(1);
-    dottedStrokeButton.setClickingTogglesState(true);
-    dashDotStrokeButton.setRadioGroupId(1);
-    dashDotStrokeButton.setClickingTogglesState(true);
-
-    solidStrokeButton.setToggleState(true, juce::dontSendNotification);
-    
-    addLabel(widthLabel, "Width");
-    addLabel(heightLabel, "Height");
-    addAndMakeVisible(widthEditor);
-    addAndMakeVisible(heightEditor);
-
-    widthEditor.setInputRestrictions(6, "0123456789");
-    heightEditor.setInputRestrictions(6, "0123456789");
-
-    widthEditor.onReturnKey = [this]()
-    {
-        if (auto* shape = owner.getSelectedShape())
-        {
-            auto bounds = shape->bounds;
-            bounds.setWidth(widthEditor.getText().getFloatValue());
-            owner.updateSelectedShapeBounds(bounds);
-        }
-    };
-
-    heightEditor.onReturnKey = [this]()
-    {
-        if (auto* shape = owner.getSelectedShape())
-        {
-            auto bounds = shape->bounds;
-            bounds.setHeight(heightEditor.getText().getFloatValue());
-            owner.updateSelectedShapeBounds(bounds);
-        }
-    };
-    
-    setupShapeButton(textButton, "Text");
-    textButton.onClick = [this]
-    {
-        // Set default black color for text
-        owner.setFillColour(juce::Colours::black);
-        owner.setCurrentTool(MainComponent::Tool::Text);
-        
-        // Update the fill color button to show black
-        fillColorButton.setColour(juce::TextButton::buttonColourId, juce::Colours::black);
-    };
-    
-    // Add text controls
-    fontSizeSlider.setRange(8.0, 72.0, 1.0);
-    fontSizeSlider.setValue(14.0);
-    fontSizeSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
-    fontSizeSlider.onValueChange = [this]
-    {
-        if (!updatingFromShape)
-            owner.updateSelectedShapeFontSize((float)fontSizeSlider.getValue());
-    };
-    addAndMakeVisible(fontSizeSlider);
-    addLabel(fontSizeLabel, "Font Size");
-    
-}
-
-ToolPanel::~ToolPanel()
-{
-    // Make sure we clean up any open color picker windows
-    deleteColorPickers();
-}
-
-void ToolPanel::resized()
-{
-    // Move the layout code from MainComponent::resized() to here
-    auto padding = 10;
-    auto buttonWidth = 100;
-    auto buttonHeight = 30;
-    auto colorButtonWidth = 60;
-    auto strokePatternWidth = 40;
-    auto y = padding;
-    
-    // Tool buttons
-    selectButton.setBounds(padding, y, buttonWidth, buttonHeight);
-    rectangleButton.setBounds(padding, y + buttonHeight + padding, buttonWidth, buttonHeight);
-    ellipseButton.setBounds(padding, y + (buttonHeight + padding) * 2, buttonWidth, buttonHeight);
-    lineButton.setBounds(padding, y + (buttonHeight + padding) * 3, buttonWidth, buttonHeight);
-    textButton.setBounds(padding, y + (buttonHeight + padding) * 4, buttonWidth, buttonHeight);
-    
-    y = y + (buttonHeight + padding) * 5;
-    
-    // Style controls
-    auto labelWidth = 80;
-    strokeWidthSlider.setBounds(padding + labelWidth, y, 200, buttonHeight);
-    
-    y += buttonHeight + padding;
-    cornerRadiusSlider.setBounds(padding + labelWidth, y, 200, buttonHeight);
-    
-    y += buttonHeight + padding;
-    fillColorButton.setBounds(padding + labelWidth, y, colorButtonWidth, buttonHeight);
-    fillColorLabel.setBounds(padding, y, labelWidth, buttonHeight);
-    fillToggle.setBounds(padding + labelWidth + colorButtonWidth + padding, y, buttonWidth, buttonHeight);
-    
-    y += buttonHeight + padding;
-    strokeColorButton.setBounds(padding + labelWidth, y, colorButtonWidth, buttonHeight);
-    strokeColorLabel.setBounds(padding, y, labelWidth, buttonHeight);
-    
-    y += buttonHeight + padding;
-    solidStrokeButton.setBounds(padding, y, strokePatternWidth, buttonHeight);
-    dashedStrokeButton.setBounds(padding * 2 + strokePatternWidth, y, strokePatternWidth, buttonHeight);
-    dottedStrokeButton.setBounds(padding * 3 + strokePatternWidth * 2, y, strokePatternWidth, buttonHeight);
-    dashDotStrokeButton.setBounds(padding * 4 + strokePatternWidth * 3, y, strokePatternWidth, buttonHeight);
-    
-    y += buttonHeight + padding;
-    // Add font size control
-    fontSizeLabel.setBounds(padding, y, labelWidth, buttonHeight);
-    fontSizeSlider.setBounds(padding + labelWidth, y, 200, buttonHeight);
-    
-    y += buttonHeight + padding;
-    widthLabel.setBounds(padding, y, labelWidth, buttonHeight);
-    widthEditor.setBounds(padding + labelWidth, y, 60, buttonHeight);
-    
-    y += buttonHeight + padding;
-    heightLabel.setBounds(padding, y, labelWidth, buttonHeight);
-    heightEditor.setBounds(padding + labelWidth, y, 60, buttonHeight);
-}
-
-void ToolPanel::updateDimensionEditors(const MainComponent::Shape* shape)
-{
-    if (shape && shape->type != MainComponent::Tool::Line)
-    {
-        widthEditor.setText(juce::String(static_cast<int>(std::abs(shape->bounds.getWidth()))), false);
-        heightEditor.setText(juce::String(static_cast<int>(std::abs(shape->bounds.getHeight()))), false);
-        widthEditor.setEnabled(true);
-        heightEditor.setEnabled(true);
-    }
-    else
-    {
-        widthEditor.setText("--");
-        heightEditor.setText("--");
-        widthEditor.setEnabled(false);
-        heightEditor.setEnabled(false);
-    }
-}
-
-void ToolPanel::updateFromShape(const MainComponent::Shape* shape)
-{
-    updatingFromShape = true;
-    
-    if (shape)
-    {
-        // Update all controls to reflect the selected shape's properties
-        fillToggle.setToggleState(shape->style.hasFill, juce::dontSendNotification);
-        strokeWidthSlider.setValue(shape->style.strokeWidth, juce::dontSendNotification);
-        cornerRadiusSlider.setValue(shape->style.cornerRadius, juce::dontSendNotification);
-        
-        fillColorButton.setColour(juce::TextButton::buttonColourId, shape->style.fillColour);
-        strokeColorButton.setColour(juce::TextButton::buttonColourId, shape->style.strokeColour);
-        
-        // Update stroke pattern buttons
-        solidStrokeButton.setToggleState(shape->style.strokePattern == MainComponent::StrokePattern::Solid, juce::dontSendNotification);
-        dashedStrokeButton.setToggleState(shape->style.strokePattern == MainComponent::StrokePattern::Dashed, juce::dontSendNotification);
-        dottedStrokeButton.setToggleState(shape->style.strokePattern == MainComponent::StrokePattern::Dotted, juce::dontSendNotification);
-        dashDotStrokeButton.setToggleState(shape->style.strokePattern == MainComponent::StrokePattern::DashDot, juce::dontSendNotification);
-        
-        // Update dimension editors
-        updateDimensionEditors(shape);
-        
-        // Update text-specific controls
-        if (shape->type == MainComponent::Tool::Text)
-            fontSizeSlider.setValue(shape->style.fontSize, juce::dontSendNotification);
-    }
-    else
-    {
-        updateDimensionEditors(nullptr);
-    }
-    
-    updatingFromShape = false;
-}
-
-void ToolPanel::deleteColorPickers()
-{
-    fillColorPicker = nullptr;
-    strokeColorPicker = nullptr;
-}
-
-void ToolPanel::showColorPicker(bool isFillColor)
-{
-    // If there's already a picker of this type, just focus it instead of creating a new one
-    if (isFillColor && fillColorPicker != nullptr)
-    {
-        fillColorPicker->setVisible(true);
-        fillColorPicker->toFront(true);
-        return;
-    }
-    else if (!isFillColor && strokeColorPicker != nullptr)
-    {
-        strokeColorPicker->setVisible(true);
-        strokeColorPicker->toFront(true);
-        return;
-    }
-
-    juce::String windowTitle = isFillColor ? "Fill Color" : "Stroke Color";
-    juce::Colour initialColor = isFillColor ?
-        fillColorButton.findColour(juce::TextButton::buttonColourId) :
-        strokeColorButton.findColour(juce::TextButton::buttonColourId);
-        
-    auto& picker = isFillColor ? fillColorPicker : strokeColorPicker;
-    picker = std::make_unique<ColorPickerWindow>(windowTitle, initialColor,
-        [this, isFillColor](juce::Colour newColour)
-        {
-            if (isFillColor)
-            {
-                fillColorButton.setColour(juce::TextButton::buttonColourId, newColour);
-                owner.updateSelectedShapeFillColour(newColour);
-            }
-            else
-            {
-                strokeColorButton.setColour(juce::TextButton::buttonColourId, newColour);
-                owner.updateSelectedShapeStrokeColour(newColour);
-            }
-        });
-
-    // Position the picker window relative to the button
-    auto &button = isFillColor ? fillColorButton : strokeColorButton;
-    auto buttonPos = button.getBounds().getTopRight();
-    auto screenPos = localPointToGlobal(buttonPos);
-    
-    // Offset it slightly so it doesn't cover the button
-    screenPos.addXY(10, 0);
-    
-    picker->setTopLeftPosition(screenPos.x, screenPos.y);
-}
-
-
-//-------------------------------------------
-
-ToolWindow::ToolWindow(MainComponent& mainComponent)
-    : DocumentWindow("Tools", juce::Colours::lightgrey,
-                    DocumentWindow::closeButton | DocumentWindow::minimiseButton)
-{
-    toolPanel = std::make_unique<ToolPanel>(mainComponent);
-    
-    const int width = 600;
-    const int height = 600;
-    
-    // Give the tool panel an initial size before setting it as content
-    toolPanel->setSize(width, height);
-    
-    // Use setContentNonOwned since we're managing ownership with unique_ptr
-    setContentNonOwned(toolPanel.get(), true);
-    
-    setUsingNativeTitleBar(true);
-    setResizable(true, false);
-    centreWithSize(width, height);
-    setVisible(true);
-    //Need to make the process the foreground, otherwise the tooltip window wont show up initially, on Mac at least.
-    juce::Process::makeForegroundProcess();
-    toFront(true);  // Bring window to front when created
-}
-
-void ToolWindow::closeButtonPressed()
-{
-    // Just hide the window when the user clicks the close button
-    setVisible(false);
-}
-
-ToolPanel& ToolWindow::getToolPanel()
-{
-    return *toolPanel;
-}
-
+/*
+  ==============================================================================
+
+    MainComponent.cpp
+    Created: 11 Nov 2024 10:52:48pm
+    Author:  Martin S
+ 
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "MainComponent.h"
+#include "AudioAnalyser.h"
+#include "FilmstripCache.h"
+#include "FontCache.h"
+#include "SceneRenderer.h"
+#include "SymbolLibrary.h"
+
+StrokePatternButton::StrokePatternButton(const juce::String& name) : juce::Button(name)
+{
+    
+}
+    
+void StrokePatternButton::paintButton(juce::Graphics& g, bool isMouseOver, bool isButtonDown)
+{
+    auto bounds = getLocalBounds();
+    g.setColour((isButtonDown || getToggleState()) ? juce::Colours::grey : (isMouseOver ? juce::Colours::lightgrey : juce::Colours::white));
+    g.fillRect(bounds);
+    
+    g.setColour(juce::Colours::black);
+    g.drawRect(bounds);
+    
+    // Draw pattern preview
+    float dashLengths[6] = { 6.0f, 3.0f }; // Default dash pattern
+    if (getName() == "Dotted")
+        dashLengths[0] = dashLengths[1] = 3.0f;
+    else if (getName() == "Dash-Dot")
+    {
+        dashLengths[0] = 9.0f;
+        dashLengths[1] = 3.0f;
+        dashLengths[2] = 3.0f;
+        dashLengths[3] = 3.0f;
+    }
+    
+    juce::Path path;
+    path.startNewSubPath(bounds.getX() + 5, bounds.getCentreY());
+    path.lineTo(bounds.getRight() - 5, bounds.getCentreY());
+    
+    juce::PathStrokeType strokeType(2.0f);
+    if (getName() != "Solid")
+    {
+        strokeType.setStrokeThickness(1.0f);
+        strokeType.createDashedStroke(path, path, dashLengths, getName() == "Dotted" ? 2 : 4);
+    }
+        
+    g.strokePath(path, strokeType);
+}
+
+
+SelectionHandle::SelectionHandle()
+{
+    handleType = Type::TopLeft;
+}
+
+SelectionHandle::SelectionHandle(Type type)
+{
+    handleType = type;
+}
+
+SelectionHandle::SelectionHandle(const SelectionHandle& other)
+    : handleType(other.handleType)
+    , position(other.position)
+    , handleBounds(other.handleBounds)
+    , bounds_(other.bounds_)
+{
+}
+
+SelectionHandle& SelectionHandle::operator=(const SelectionHandle& other)
+{
+    if (this != &other)
+    {
+        handleType = other.handleType;
+        position = other.position;
+        handleBounds = other.handleBounds;
+        bounds_ = other.bounds_;
+    }
+    return *this;
+}
+
+juce::Point<float> SelectionHandle::rotatePointAround(juce::Point<float> point,
+                                            juce::Point<float> center,
+                                            float angleInRadians)
+{
+    float dx = point.x - center.x;
+    float dy = point.y - center.y;
+    
+    return juce::Point<float>(
+        center.x + (dx * std::cos(angleInRadians) - dy * std::sin(angleInRadians)),
+        center.y + (dx * std::sin(angleInRadians) + dy * std::cos(angleInRadians))
+    );
+}
+
+void SelectionHandle::updatePosition(const juce::Rectangle<float>& bounds, float rotationAngle, const juce::Point<float>& rotationCenter)
+{
+    const float rotateHandleOffset = 20.0f;
+    bounds_ = bounds;
+    
+    // Calculate handle position based on type
+    switch (handleType)
+    {
+        case Type::TopLeft:     position = bounds.getTopLeft(); break;
+        case Type::Top:         position = bounds.getCentre().withY(bounds.getY()); break;
+        case Type::TopRight:    position = bounds.getTopRight(); break;
+        case Type::Right:       position = bounds.getCentre().withX(bounds.getRight()); break;
+        case Type::BottomRight: position = bounds.getBottomRight(); break;
+        case Type::Bottom:      position = bounds.getCentre().withY(bounds.getBottom()); break;
+        case Type::BottomLeft:  position = bounds.getBottomLeft(); break;
+        case Type::Left:        position = bounds.getCentre().withX(bounds.getX()); break;
+        case Type::Rotate:
+            position = bounds.getCentre().withY(bounds.getY() - rotateHandleOffset);
+            break;
+    }
+
+    // Create handle bounds centered on position
+    handleBounds = juce::Rectangle<float>(handleSize, handleSize).withCentre(position);
+
+    // If there's rotation, rotate the handle position around the bounds center
+    if (rotationAngle != 0.0f && handleType != Type::Rotate)
+    {
+        auto rotated = rotatePointAround(position, rotationCenter, rotationAngle);
+        handleBounds = juce::Rectangle<float>(handleSize, handleSize).withCentre(rotated);
+    }
+}
+
+// Graphics::drawRect() collects the four sides in a RectangleList, which
+// allocates. These are the same sides, filled one by one.
+static void drawRectOutline(juce::Graphics& g, juce::Rectangle<float> area, float lineThickness)
+{
+    g.fillRect(area.removeFromTop(lineThickness));
+    g.fillRect(area.removeFromBottom(lineThickness));
+    g.fillRect(area.removeFromLeft(lineThickness));
+    g.fillRect(area.removeFromRight(lineThickness));
+}
+
+const juce::Path& SelectionHandle::getRotateIcon()
+{
+    // The same for every handle, so it's built and stroked once, around the
+    // centre of the handle
+    static const juce::Path icon = []
+    {
+        const auto handleArea = juce::Rectangle<float>(handleSize, handleSize).withCentre({});
+        
+        float iconSize = handleArea.getWidth() * 1.25f;
+        juce::Rectangle<float> iconBounds(handleArea.getCentreX() - iconSize/2,
+                                        handleArea.getY() - iconSize - 4,
+                                        iconSize, iconSize);
+        
+        juce::Path arrow;
+        
+        // The circular arc
+        arrow.addArc(iconBounds.getX(),
+                    iconBounds.getY(),
+                    iconSize,  // radius
+                    iconSize,  // radius
+                    juce::MathConstants<float>::pi * 0.1f,   // startAngle
+                    juce::MathConstants<float>::pi * 1.6f,   // endAngle
+                    true);  // clockwise
+
+        // Calculate end point for arrow
+        float endAngle = juce::MathConstants<float>::pi * 1.6f;
+        float endX = iconBounds.getCentreX() + std::cos(endAngle) * iconSize * 0.5f;
+        float endY = iconBounds.getCentreY() + std::sin(endAngle) * iconSize * 0.5f;
+        
+        float dAngle = juce::MathConstants<float>::pi * 1.5f;
+        float dendX = iconBounds.getCentreX() + std::cos(dAngle) * iconSize * 0.5f;
+        float dendY = iconBounds.getCentreY() + std::sin(dAngle) * iconSize * 0.5f;
+        
+        arrow.addArrow(juce::Line<float>(
+            endX, endY,
+            dendX, dendY),
+            1.0f,  // line thickness
+            3.0f,  // arrow head width
+            4.0f); // arrow head length
+        
+        juce::Path outline;
+        juce::PathStrokeType(2.0f).createStrokedPath(outline, arrow);
+        return outline;
+    }();
+    
+    return icon;
+}
+
+void SelectionHandle::paint(juce::Graphics& g, FrameArena& arena)
+{
+    g.setColour(juce::Colours::white);
+    g.fillRect(handleBounds);
+    g.setColour(juce::Colours::black);
+    drawRectOutline(g, handleBounds, 1.0f);
+
+    if (handleType == Type::Rotate)
+    {
+        // Draw a circular handle for rotation: a square rounded all the way
+        // is a circle, and its stroke outline is ready-made
+        FrameArena::ScopedPath circle(arena);
+        SceneRenderer::addRectangleStroke(circle, handleBounds, handleBounds.getWidth() * 0.5f, 1.0f);
+        g.fillPath(circle);
+        
+        // Draw line connecting to the shape
+        g.fillRect(juce::Rectangle<float>(juce::Point<float>(handleBounds.getCentreX() - 0.5f, handleBounds.getBottom()),
+                                          juce::Point<float>(handleBounds.getCentreX() + 0.5f, bounds_.getY())));
+                  
+        // Draw rotation arrow icon above the handle
+        g.fillPath(getRotateIcon(), juce::AffineTransform::translation(handleBounds.getCentre()));
+    }
+}
+
+bool SelectionHandle::hitTest(juce::Point<float> point) const
+{
+    const float handleHitThreshold = 1.0f;
+    return handleBounds.expanded(handleHitThreshold).contains(point);
+}
+
+static bool isBoundToParameter(const MainComponent::Shape& shape, int parameterIndex)
+{
+    return shape.control != MainComponent::ControlType::None && shape.parameterIndex == parameterIndex;
+}
+
+static bool isAudioDisplay(const MainComponent::Shape& shape)
+{
+    return shape.type == MainComponent::Tool::Meter || shape.type == MainComponent::Tool::Scope
+        || shape.type == MainComponent::Tool::Spectrum;
+}
+
+// Freehand points are stored relative to the bounds, see Shape::points
+static juce::AffineTransform getFreehandTransform(const juce::Rectangle<float>& bounds)
+{
+    return juce::AffineTransform::scale(bounds.getWidth(), bounds.getHeight()).translated(bounds.getPosition());
+}
+
+bool MainComponent::Shape::hitTest(juce::Point<float> point) const
+{
+    if (rotation != 0.0f)
+    {
+        // For rotated shapes, transform the test point back
+        point = SelectionHandle::rotatePointAround(point, bounds.getCentre(), -rotation);
+    }
+
+    switch (type)
+    {
+        case Tool::Rectangle:
+            return bounds.contains(point);
+            
+        case Tool::Ellipse:
+            return bounds.contains(point);
+                       
+        case Tool::Line:
+        {
+            float threshold = style->strokeWidth + 4.0f;
+            juce::Line<float> line(lineStart, lineEnd);
+            juce::Point<float> foundPoint;
+            return line.getDistanceFromPoint(point, foundPoint) < threshold;
+        }
+            
+        case Tool::Freehand:
+        {
+            if (points == nullptr || points->isEmpty())
+                return false;
+            
+            // The curve never strays far from the segments between its points
+            float threshold = style->strokeWidth + 4.0f;
+            const auto toDocument = getFreehandTransform(bounds);
+            auto previous = points->getFirst().transformedBy(toDocument);
+            
+            if (previous.getDistanceFrom(point) < threshold)
+                return true;
+            
+            for (int i = 1; i < points->size(); ++i)
+            {
+                const auto next = points->getReference(i).transformedBy(toDocument);
+                juce::Point<float> foundPoint;
+                
+                if (juce::Line<float>(previous, next).getDistanceFromPoint(point, foundPoint) < threshold)
+                    return true;
+                
+                previous = next;
+            }
+            return false;
+        }
+            
+        case Tool::Text:
+            return bounds.contains(point);
+            
+        case Tool::Instance:
+        case Tool::Image:
+        case Tool::Meter:
+        case Tool::Scope:
+        case Tool::Spectrum:
+            return bounds.contains(point);
+            
+        default:
+            return false;
+    }
+}
+
+juce::Rectangle<float> MainComponent::Shape::getDrawnBounds() const
+{
+    // Area touched when painting this shape, including stroke and rotation
+    auto area = type == Tool::Line ? juce::Rectangle<float>(lineStart, lineEnd) : bounds;
+    float strokeWidth = isOpenPath(type) ? std::max(1.0f, style->strokeWidth) : style->strokeWidth;
+    
+    // Mitered corners and square line caps reach further out than half the stroke width
+    area = area.expanded(strokeWidth + 1.0f);
+    
+    if (rotation != 0.0f)
+        area = area.transformedBy(juce::AffineTransform::rotation(rotation, rotationCenter.x, rotationCenter.y));
+    
+    return area;
+}
+
+void MainComponent::Shape::initializeRotationCenter()
+{
+    if (type == Tool::Line) {
+        // For lines, use midpoint between start and end
+        rotationCenter = (lineStart + lineEnd) * 0.5f;
+    } else {
+        // For rectangles and ellipses, use bounds center
+        rotationCenter = bounds.getCentre();
+    }
+}
+
+void MainComponent::Shape::move(float dx, float dy)
+{
+    bounds.translate(dx, dy);
+    rotationCenter.addXY(dx, dy);
+    
+    if (type == Tool::Line)
+    {
+        lineStart.addXY(dx, dy);
+        lineEnd.addXY(dx, dy);
+    }
+}
+
+void MainComponent::Shape::addFreehandCurve(juce::Path& path) const
+{
+    if (points == nullptr)
+        return;
+    
+    // Built from the relative points, then moved into place in one go
+    StrokeSimplifier::addCurve(path, points->begin(), points->size());
+    path.applyTransform(getFreehandTransform(bounds));
+}
+
+void MainComponent::Shape::drawText(juce::Graphics& g) const
+{
+    UIDESIGNER_TRACE_SCOPE("Shape::drawText");
+    
+    // Don't apply rotation here - it's handled by the main drawing code
+    const auto& font = getFont();
+    g.setFont(font);
+    g.setColour(style->fillColour);
+
+    if (style->textStretchEnabled)
+    {
+        auto textBounds = g.getCurrentFont().getStringWidth(text);
+        float scaleX = bounds.getWidth() / textBounds;
+        float scaleY = bounds.getHeight() / font.getHeight();
+        
+        g.addTransform(juce::AffineTransform::scale(scaleX, scaleY)
+                      .translated(bounds.getX(), bounds.getY()));
+        g.drawText(text, 0, 0, textBounds, font.getHeight(),
+                  juce::Justification::left, true);
+    }
+    else
+    {
+        g.drawText(text, bounds.toType<int>(),
+                  juce::Justification::left, true);
+    }
+}
+
+
+MainComponent::MainComponent()
+{
+    setName("MainComponent");
+    
+    // paint() fills everything, so nothing behind needs painting first
+    setOpaque(true);
+    
+    symbolLibrary = std::make_unique<SymbolLibrary>();
+    tileCache = std::make_unique<TileCache>();
+    filmstripCache = std::make_unique<FilmstripCache>();
+    
+    addAndMakeVisible(showToolsButton);
+    showToolsButton.setButtonText("Show Tools");
+    showToolsButton.onClick = [this]
+    {
+        showTools();
+    };
+    
+    // Set initial style
+    currentStyle.fillColour = juce::Colours::lightgrey;
+    currentStyle.strokeColour = juce::Colours::black;
+    currentStyle.strokeWidth = 0.0f;
+    currentStyle.strokePattern = StrokePattern::Solid;
+    currentStyle.hasFill = true;
+
+    // Up to eight resize handles plus the rotation handle
+    selectionHandles.ensureStorageAllocated(9);
+    shapesChangedSinceSnapshot.ensureStorageAllocated(maxSnapshotChanges);
+    
+    // Enable keyboard listening
+    addKeyListener(this);
+    setWantsKeyboardFocus(true);
+    
+    // So the first text edit doesn't wait for the typeface
+    prewarmDocumentFonts();
+    
+    // Image shapes are redrawn once their files are decoded
+    ImageLibrary::getInstance()->addChangeListener(this);
+}
+
+MainComponent::~MainComponent()
+{
+    if (auto* imageLibrary = ImageLibrary::getInstanceWithoutCreating())
+        imageLibrary->removeChangeListener(this);
+}
+
+
+void MainComponent::paint(juce::Graphics& g)
+{
+    UIDESIGNER_TRACE_SCOPE("paint");
+    
+    performanceOverlay.beginFrame(g.getClipBounds());
+    
+    g.fillAll(juce::Colours::white);
+    
+    performanceOverlay.beginSection(PerformanceOverlay::Section::Shapes);
+    
+    // The frame only fits if neither the size nor the display scale has changed
+    const bool drawsCachedFrame = cachedFrame.isValid()
+                                  && cachedFrameScale == g.getInternalContext().getPhysicalPixelScaleFactor()
+                                  && cachedFrame.getBounds() == getFrameBounds(cachedFrameScale);
+    
+    // Tiles are placed in component coordinates, at the whole-pixel view offset
+    if (drawsCachedFrame)
+    {
+        g.drawImageTransformed(cachedFrame, juce::AffineTransform::scale(1.0f / cachedFrameScale));
+    }
+    else if (renderMode == RenderMode::Tiled)
+    {
+        tileCache->draw(g, g.getClipBounds(), viewScale, viewOffset.roundToInt(), *this);
+        performanceOverlay.setTileStatistics(tileCache->getStatistics());
+    }
+    else if (renderMode == RenderMode::Progressive)
+    {
+        // Panning moves the current pass along. Any other change of view
+        // starts a new pass, with the first slice right away so the frame
+        // isn't empty.
+        const float pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        
+        if (!progressiveRenderer.matchesView(getLocalBounds(), viewScale, viewOffset.roundToInt(), pixelScale)
+            && !progressiveRenderer.pan(getLocalBounds(), viewScale, viewOffset.roundToInt(), pixelScale))
+        {
+            progressiveRenderer.start(getDocumentSnapshot(), getLocalBounds(), viewScale, viewOffset.roundToInt(), pixelScale);
+            progressiveRenderer.renderNextSlice(progressiveSliceBudgetMs);
+        }
+        
+        progressiveRenderer.draw(g, *this);
+        performanceOverlay.setProgressiveStatistics(progressiveRenderer.getStatistics());
+    }
+    else if (renderMode == RenderMode::Threaded)
+    {
+        // The render thread needs its own copy of the document. An edit only
+        // copies the chunks of the snapshot it touched, and until the new
+        // frame is in, the previous one is shown.
+        backgroundRenderer.requestFrame(getDocumentSnapshot(), getLocalBounds(), viewScale, viewOffset.roundToInt(),
+                                        g.getInternalContext().getPhysicalPixelScaleFactor());
+        backgroundRenderer.draw(g, viewScale, viewOffset.roundToInt());
+        performanceOverlay.setBackgroundRenderStatistics(backgroundRenderer.getStatistics());
+    }
+    
+    // Shapes are drawn in document coordinates, everything after them
+    // (selection, labels, HUD) stays in component coordinates
+    const auto viewTransform = getViewTransform();
+    g.saveState();
+    g.addTransform(viewTransform);
+    
+    if (renderMode == RenderMode::Direct && !drawsCachedFrame)
+        renderDocument(g, viewScale);
+    
+    // Draw current shape being created
+    if (isDrawing)
+    {
+        SceneRenderer renderer(g, frameArena, viewScale);
+        
+        switch (currentTool)
+        {
+            case Tool::Rectangle:
+            case Tool::Meter:
+            case Tool::Scope:
+            case Tool::Spectrum:
+            {
+                auto bounds = juce::Rectangle<float>(dragStart, dragEnd);
+                renderer.drawRectangle(bounds, currentStyle);
+                break;
+            }
+            case Tool::Ellipse:
+            {
+                auto bounds = juce::Rectangle<float>(dragStart, dragEnd);
+                renderer.drawEllipse(bounds, currentStyle);
+                break;
+            }
+            case Tool::Line:
+            {
+                renderer.drawLine(dragStart, dragEnd, currentStyle);
+                break;
+            }
+            case Tool::Freehand:
+            {
+                // The outline of the finished part is kept between frames and
+                // grows with it, only the end of the curve is stroked each time
+                if (SceneRenderer::canAddFreehandOutline(currentStyle))
+                {
+                    updateFreehandOutline();
+                    renderer.fillFreehandOutline(freehandOutline, currentStyle);
+                }
+                else
+                {
+                    renderer.drawFreehand(freehandStroke.getFinishedCurve(), currentStyle);
+                }
+                
+                FrameArena::ScopedPath unfinishedCurve(frameArena);
+                freehandStroke.addUnfinishedCurve(unfinishedCurve);
+                renderer.drawFreehand(unfinishedCurve, currentStyle);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    
+    drawAudioDisplays(g);
+    drawControlValues(g);
+    
+    g.restoreState();
+    performanceOverlay.endSection();
+    
+    // Draw selection indicators
+    if (shapes.contains(selectedShapeId))
+    {
+        performanceOverlay.beginSection(PerformanceOverlay::Section::Selection);
+        auto& selectedShape = shapes.getReference(selectedShapeId);
+        
+        // Draw selection outline
+        g.setColour(juce::Colours::blue);
+        
+        if (selectedShape.rotation != 0.0f)
+        {
+            // For rotated shapes, we need to draw a rotated rectangle. The
+            // view only scales uniformly, so the stroke can be outlined in
+            // document units.
+            FrameArena::ScopedPath outline(frameArena);
+            SceneRenderer::addRectangleStroke(outline, selectedShape.bounds, 0.0f, 1.5f / viewScale);
+            g.fillPath(outline, juce::AffineTransform::rotation(
+                selectedShape.rotation,
+                selectedShape.rotationCenter.x,
+                selectedShape.rotationCenter.y).followedBy(viewTransform));
+        }
+        else
+        {
+            // For non-rotated shapes, just draw the bounds
+            drawRectOutline(g, selectedShape.bounds.transformedBy(viewTransform), 1.5f);
+        }
+
+        // Draw selection handles
+        for (auto& handle : selectionHandles)
+            handle.paint(g, frameArena);
+        
+        performanceOverlay.endSection();
+    }
+    
+    if (shapes.contains(selectedShapeId))
+    {
+        performanceOverlay.beginSection(PerformanceOverlay::Section::Labels);
+        auto& selectedShape = shapes.getReference(selectedShapeId);
+        drawDimensionLabel(g, selectedShape);
+        drawSnapGuides(g);
+        performanceOverlay.endSection();
+    }
+    
+    if (!hasPaintedFirstFrame)
+        firstFramePainted();
+    
+    performanceOverlay.setFrameArenaStatistics(frameArena.getStatistics());
+    performanceOverlay.paint(g, getLocalBounds());
+    
+    // Everything taken from the arena during this frame is released here
+    frameArena.reset();
+}
+ 
+void MainComponent::renderDocument(juce::Graphics& g, float scale)
+{
+    SceneRenderer renderer(g, frameArena, scale, symbolLibrary.get());
+    
+    // Draw all completed shapes, except the one that's currently being edited.
+    // The draw list only lives for this frame, so it comes from the arena.
+    auto** drawList = frameArena.allocateArray<const Shape*>((size_t) shapes.size());
+    int numToDraw = 0;
+    
+    for (int position = 0; position < drawOrder.size(); ++position)
+    {
+        const auto id = drawOrder.getShape(position);
+        
+        if (!(isEditingText && id == editingShapeId))
+            drawList[numToDraw++] = &shapes.getReference(id);
+    }
+    
+    renderer.drawShapes(drawList, numToDraw);
+    
+    const auto& renderStats = renderer.getStatistics();
+    performanceOverlay.addRenderStatistics(renderStats.shapesDrawn, renderStats.shapesCulled, renderStats.shapesOccluded,
+                                           renderStats.shapesBatched, renderStats.shapesSimplified, renderStats.drawCalls);
+}
+
+std::shared_ptr<const RenderSource> MainComponent::getDocumentSnapshot()
+{
+    // Edits only note what changed, the snapshot is brought up to date when
+    // a background job or the processor needs it. Dragging a shape then
+    // copies the one chunk it's in per frame, rather than the whole document.
+    if (!isSnapshotOutdated)
+        return documentSnapshot;
+    
+    if (symbolSnapshot == nullptr)
+        symbolSnapshot = std::make_shared<const SymbolLibrary>(*symbolLibrary);
+    
+    // Leaving out the text being edited shifts every shape above it
+    const auto hiddenShape = isEditingText ? editingShapeId : ShapeId();
+    const bool canUpdateChunks = documentSnapshot != nullptr
+                                 && !snapshotNeedsFullRebuild
+                                 && drawOrder.getVersion() == snapshotDrawOrderVersion
+                                 && !hiddenShape.isValid() && !snapshotHiddenShape.isValid();
+    
+    documentSnapshot = canUpdateChunks ? createUpdatedSnapshot() : createFullSnapshot(hiddenShape);
+    
+    isSnapshotOutdated = false;
+    snapshotNeedsFullRebuild = false;
+    shapesChangedSinceSnapshot.clearQuick();
+    snapshotDrawOrderVersion = drawOrder.getVersion();
+    snapshotHiddenShape = hiddenShape;
+    
+    return documentSnapshot;
+}
+
+std::shared_ptr<const DocumentSnapshot> MainComponent::createFullSnapshot(ShapeId hiddenShape)
+{
+    juce::Array<Shape> visibleShapes;
+    visibleShapes.ensureStorageAllocated(shapes.size());
+    
+    // In stacking order, so the snapshot and the saved document need no keys
+    for (int position = 0; position < drawOrder.size(); ++position)
+    {
+        const auto id = drawOrder.getShape(position);
+        
+        if (id != hiddenShape)
+            visibleShapes.add(shapes.getReference(id));
+    }
+    
+    return std::make_shared<const DocumentSnapshot>(std::move(visibleShapes), symbolSnapshot);
+}
+
+std::shared_ptr<const DocumentSnapshot> MainComponent::createUpdatedSnapshot()
+{
+    using Chunk = DocumentSnapshot::Chunk;
+    
+    auto chunks = documentSnapshot->getChunks();
+    
+    // Sorted, so that each chunk is copied once however many of its shapes changed
+    std::array<int, maxSnapshotChanges> positions;
+    int numPositions = 0;
+    
+    for (auto id : shapesChangedSinceSnapshot)
+        if (shapes.contains(id))
+            positions[(size_t) numPositions++] = drawOrder.getPosition(id);
+    
+    std::sort(positions.begin(), positions.begin() + numPositions);
+    
+    std::shared_ptr<Chunk> copiedChunk;
+    int copiedChunkIndex = -1;
+    
+    for (int i = 0; i < numPositions; ++i)
+    {
+        const int position = positions[(size_t) i];
+        const int chunkIndex = position / DocumentSnapshot::chunkSize;
+        
+        if (chunkIndex != copiedChunkIndex)
+        {
+            copiedChunk = std::make_shared<Chunk>(*chunks[(size_t) chunkIndex]);
+            chunks[(size_t) chunkIndex] = copiedChunk;
+            copiedChunkIndex = chunkIndex;
+        }
+        
+        copiedChunk->getReference(position % DocumentSnapshot::chunkSize) = shapes.getReference(drawOrder.getShape(position));
+    }
+    
+    return std::make_shared<const DocumentSnapshot>(std::move(chunks), symbolSnapshot);
+}
+
+void MainComponent::publishDocument()
+{
+    hasUnpublishedChanges = false;
+    getDocumentSnapshot();
+    
+    if (onDocumentChanged != nullptr)
+        onDocumentChanged(documentSnapshot);
+}
+
+void MainComponent::setDocument(std::shared_ptr<const DocumentSnapshot> document)
+{
+    jassert(document != nullptr);
+    
+    if (isEditingText)
+        finishTextEditing();
+    
+    endControlDrag();
+    deselectAllShapes();
+    hasPendingDrag = false;
+    pendingStyleEdits = {};
+    
+    shapes.clear();
+    drawOrder.clear();
+    audioDisplayIds.clearQuick();
+    
+    for (auto& ids : controlIdsByParameter)
+        ids.clearQuick();
+    
+    snapIndexNeedsRebuild = true;
+    shapes.ensureStorageAllocated(document->getNumShapes());
+    
+    for (auto& chunk : document->getChunks())
+    {
+        for (auto& shape : *chunk)
+        {
+            const auto id = shapes.add(shape);
+            drawOrder.addShape(id);
+            addToLiveShapeIndexes(id, shape);
+        }
+    }
+    
+    // The document is its own snapshot, with its shapes in the same order
+    symbolLibrary = std::make_unique<SymbolLibrary>(document->getSymbols());
+    symbolSnapshot = document->getSharedSymbols();
+    documentSnapshot = std::move(document);
+    hasUnpublishedChanges = false;
+    isSnapshotOutdated = false;
+    snapshotNeedsFullRebuild = false;
+    shapesChangedSinceSnapshot.clearQuick();
+    snapshotDrawOrderVersion = drawOrder.getVersion();
+    snapshotHiddenShape = {};
+    
+    cachedFrame = {};
+    tileCache->clear();
+    progressiveRenderer.restart();
+    backgroundRenderer.clear();
+    
+    prewarmDocumentFonts();
+    repaint();
+}
+
+std::unique_ptr<MainComponent::EditorState> MainComponent::saveEditorState()
+{
+    UIDESIGNER_TRACE_SCOPE("saveEditorState");
+    
+    if (isEditingText)
+        finishTextEditing();
+    
+    if (hasUnpublishedChanges)
+        publishDocument();
+    
+    auto state = std::make_unique<EditorState>();
+    state->document = std::static_pointer_cast<const DocumentSnapshot>(getDocumentSnapshot());
+    state->viewScale = viewScale;
+    state->viewOffset = viewOffset;
+    state->renderMode = renderMode;
+    state->tileCache = std::move(tileCache);
+    
+    if (cachedFrame.isValid())
+    {
+        // Nothing has changed since the previous editor closed
+        state->frame = cachedFrame;
+        state->frameScale = cachedFrameScale;
+        return state;
+    }
+    
+    // Only a frame that is already on screen is kept, closing never renders
+    // the document. Tiled mode keeps its tiles instead, and in Direct mode
+    // the next editor draws the document in its first paint anyway.
+    const auto bounds = getLocalBounds();
+    const auto offset = viewOffset.roundToInt();
+    const auto pixelScale = (float) juce::Component::getApproximateScaleFactorForComponent(this);
+    
+    const bool hasBackgroundFrame = renderMode == RenderMode::Threaded
+        && backgroundRenderer.hasFrameOf(state->document.get(), bounds, viewScale, offset, pixelScale);
+    
+    // A complete pass only redraws the areas changed since it started
+    const bool hasProgressiveFrame = renderMode == RenderMode::Progressive
+        && progressiveRenderer.isComplete()
+        && progressiveRenderer.matchesView(bounds, viewScale, offset, pixelScale);
+    
+    if (bounds.isEmpty() || !(hasBackgroundFrame || hasProgressiveFrame))
+        return state;
+    
+    const auto frameBounds = getFrameBounds(pixelScale);
+    state->frame = juce::Image(juce::Image::RGB, frameBounds.getWidth(), frameBounds.getHeight(), false);
+    state->frameScale = pixelScale;
+    
+    juce::Graphics g(state->frame);
+    g.fillAll(juce::Colours::white);
+    g.addTransform(juce::AffineTransform::scale(pixelScale));
+    
+    if (hasBackgroundFrame)
+        backgroundRenderer.draw(g, viewScale, offset);
+    else
+        progressiveRenderer.draw(g, *this);
+    
+    frameArena.reset();
+    return state;
+}
+
+void MainComponent::restoreEditorState(std::unique_ptr<EditorState> state)
+{
+    if (state == nullptr)
+        return;
+    
+    viewScale = state->viewScale;
+    viewOffset = state->viewOffset;
+    setRenderMode(state->renderMode);
+    viewChanged();
+    
+    // The frame and tiles are only of use if the document is still the one
+    // they show. Tiles touched by later edits are invalidated as usual.
+    if (state->document != nullptr && state->document == documentSnapshot && !isSnapshotOutdated)
+    {
+        cachedFrame = state->frame;
+        cachedFrameScale = state->frameScale;
+        
+        if (state->tileCache != nullptr)
+            tileCache = std::move(state->tileCache);
+    }
+}
+
+juce::Rectangle<int> MainComponent::getFrameBounds(float pixelScale) const
+{
+    return (getLocalBounds().toFloat() * pixelScale).getSmallestIntegerContainer();
+}
+
+void MainComponent::markShapeDirty(const Shape& shape)
+{
+    // Called before and after each edit, so both the old and the new area are redrawn
+    const auto area = getShapeDrawnBounds(shape);
+    tileCache->invalidate(area);
+    progressiveRenderer.invalidate(area);
+    markSnapshotOutdated(shape);
+    hasUnpublishedChanges = true;
+    lastEditTime = juce::Time::getMillisecondCounter();
+    cachedFrame = {};
+    
+    // Other edits update the snap index in place. The dragged shape is
+    // re-indexed on its own when the drag ends.
+    const auto id = shapes.getIdOf(shape);
+    const bool isDraggedShape = (isDraggingShape || isDraggingHandle) && id == selectedShapeId;
+    
+    if (id.isValid() && !isDraggedShape && !snapIndexNeedsRebuild
+        && !snapIndex.updateShape(id, getSnapBounds(shape)))
+        snapIndexNeedsRebuild = true;
+    
+    if (id.isValid())
+        addToLiveShapeIndexes(id, shape);
+}
+
+void MainComponent::addToLiveShapeIndexes(ShapeId id, const Shape& shape)
+{
+    // Only ever adds. Removed shapes, shapes that stopped being displays and
+    // controls that were rebound are dropped by the next vblank that walks
+    // the list.
+    if (isAudioDisplay(shape) && !audioDisplayIds.contains(id))
+        audioDisplayIds.add(id);
+    
+    if (shape.control != ControlType::None
+        && juce::isPositiveAndBelow(shape.parameterIndex, ParameterBindings::numParameters))
+    {
+        auto& ids = controlIdsByParameter[(size_t) shape.parameterIndex];
+        
+        if (!ids.contains(id))
+            ids.add(id);
+    }
+}
+
+juce::Rectangle<float> MainComponent::getShapeDrawnBounds(const Shape& shape) const
+{
+    return shape.type == Tool::Instance ? symbolLibrary->getDrawnBounds(shape) : shape.getDrawnBounds();
+}
+
+template<typename Filter>
+MainComponent::ShapeId MainComponent::findTopmostShape(juce::Point<float> position, Filter&& filter) const
+{
+    for (int drawPosition = drawOrder.size(); --drawPosition >= 0;)
+    {
+        const auto id = drawOrder.getShape(drawPosition);
+        const auto& shape = shapes.getReference(id);
+        
+        if (filter(shape) && shape.hitTest(position))
+            return id;
+    }
+    
+    return {};
+}
+
+void MainComponent::markSnapshotOutdated(const Shape& changedShape)
+{
+    isSnapshotOutdated = true;
+    
+    // Shapes that aren't in the document yet are being added, which changes
+    // the stacking order anyway
+    const auto id = shapes.getIdOf(changedShape);
+    
+    if (!id.isValid() || snapshotNeedsFullRebuild || shapesChangedSinceSnapshot.contains(id))
+        return;
+    
+    // The storage is reserved, so noting a change never allocates
+    if (shapesChangedSinceSnapshot.size() < maxSnapshotChanges)
+        shapesChangedSinceSnapshot.add(id);
+    else
+        snapshotNeedsFullRebuild = true;
+}
+
+void MainComponent::markSymbolDirty(int symbolId)
+{
+    // Called around symbol edits, snapshots pick up the new library
+    symbolSnapshot = nullptr;
+    
+    for (auto& shape : shapes)
+        if (shape.type == Tool::Instance && shape.symbolId == symbolId)
+            markShapeDirty(shape);
+}
+
+template<typename EditFunction>
+void MainComponent::editSymbolStyle(int symbolId, EditFunction&& edit)
+{
+    auto* symbol = symbolLibrary->getSymbol(symbolId);
+    
+    if (symbol == nullptr)
+        return;
+    
+    auto masterShapes = symbol->shapes;
+    
+    for (auto& master : masterShapes)
+        master.style.edit([&](Style& style) { edit(style, master.type); });
+    
+    // The instances themselves aren't changed, only their areas are redrawn
+    markSymbolDirty(symbolId);
+    symbolLibrary->updateSymbol(symbolId, std::move(masterShapes));
+    markSymbolDirty(symbolId);
+}
+
+void MainComponent::setRenderMode(RenderMode newMode)
+{
+    renderMode = newMode;
+    cachedFrame = {};
+    tileCache->clear();
+    progressiveRenderer.restart();
+    backgroundRenderer.clear();
+    repaint();
+}
+
+void MainComponent::handleVBlank()
+{
+    applyPendingUpdates();
+    
+    if (tileCache->collectFinishedTiles())
+        repaint();
+    
+    // The processor only gets to see finished edits, and only once no
+    // further ones have followed for a moment
+    if (hasUnpublishedChanges && !(isDraggingShape || isDraggingHandle || isEditingText || isDrawing)
+        && juce::Time::getMillisecondCounter() - lastEditTime >= publishDelayMs)
+        publishDocument();
+    
+    // One slice per frame, input is handled in between
+    if (renderMode == RenderMode::Progressive && progressiveRenderer.renderNextSlice(progressiveSliceBudgetMs))
+        repaint();
+    
+    if (backgroundRenderer.collectFinishedFrame())
+        repaint();
+    
+    // Parameter changes may come from the audio thread, they're only picked
+    // up here
+    if (parameterBindings != nullptr)
+        repaintControls(parameterBindings->takeChangedParameters());
+    
+    // Controls drawn directly while their strip was rendering switch over
+    if (filmstripCache->collectFinishedStrips())
+        repaintControls(~0u);
+    
+    if (audioAnalyser != nullptr && audioAnalyser->collect())
+        repaintAudioDisplays();
+}
+
+void MainComponent::resized()
+{
+    
+    // Position the button in the top-right corner
+    const int buttonWidth = 100;
+    const int buttonHeight = 30;
+    const int padding = 10;
+    
+    showToolsButton.setBounds(padding,
+                             padding,
+                             buttonWidth,
+                             buttonHeight);
+    
+}
+
+void MainComponent::mouseDown(const juce::MouseEvent& e)
+{
+    UIDESIGNER_TRACE_SCOPE("mouseDown");
+    
+    applyPendingUpdates();
+    
+    if (e.getMouseDownY() < showToolsButton.getBottom() + 10)
+        return;
+    
+    if (e.mods.isMiddleButtonDown())
+    {
+        isPanningView = true;
+        lastPanPosition = e.position;
+        return;
+    }
+    
+    // Handles live in component coordinates, shapes in document coordinates
+    auto position = viewToDocument(e.position);
+    lastMousePosition = position;
+    
+    if (isPreviewingControls)
+    {
+        beginControlDrag(position);
+        return;
+    }
+    
+    if (currentTool == Tool::Text)
+    {
+        // Start text editing
+        if (!isEditingText)
+        {
+            startTextEditing(position);
+        }
+        return;
+    }
+
+    if (currentTool == Tool::Select)
+    {
+        // Check for handle interaction first
+        for (int i = 0; i < selectionHandles.size(); ++i)
+        {
+            if (selectionHandles[i].hitTest(e.position))
+            {
+                isDraggingHandle = true;
+                activeHandle = selectionHandles[i].getType();
+                beginSnapDrag();
+                
+                if (activeHandle == SelectionHandle::Type::Rotate)
+                {
+                    auto& shape = shapes.getReference(selectedShapeId);
+                    markShapeDirty(shape);
+                    prepareRotation(e, shape);
+                    markShapeDirty(shape);
+                }
+                return;
+            }
+        }
+
+        // Check for shape selection
+        bool foundShape = false;
+        const auto id = findTopmostShape(position, [](const Shape&) { return true; });
+        
+        if (id.isValid())
+        {
+            if (selectedShapeId != id) // Only update if selecting a different shape
+            {
+                selectedShapeId = id;
+                updateSelectionHandles();
+            }
+            isDraggingShape = true;
+            foundShape = true;
+            beginSnapDrag();
+        }
+        
+        if (!foundShape && selectedShapeId.isValid())
+        {
+            deselectAllShapes();
+        }
+        else if (foundShape)
+        {
+            updateToolPanelFromShape(&shapes.getReference(selectedShapeId));
+        }
+    }
+    else
+    {
+        isDrawing = true;
+        dragStart = position;
+        dragEnd = position;
+        
+        if (currentTool == Tool::Freehand)
+        {
+            freehandStroke.begin(position, freehandTolerancePixels / viewScale);
+            freehandOutline.clear();
+            numOutlinedFreehandPoints = 0;
+        }
+    }
+}
+
+void MainComponent::updateFreehandOutline()
+{
+    const int numKept = freehandStroke.getKeptPoints().size();
+    
+    if (numKept == numOutlinedFreehandPoints)
+        return;
+    
+    // Only the pieces added since the last frame are stroked
+    FrameArena::ScopedPath newCurve(frameArena);
+    freehandStroke.addFinishedCurve(newCurve, numOutlinedFreehandPoints);
+    SceneRenderer::addFreehandOutline(freehandOutline, newCurve, currentStyle);
+    
+    numOutlinedFreehandPoints = numKept;
+}
+
+void MainComponent::mouseDoubleClick(const juce::MouseEvent& e)
+{
+    if (currentTool == Tool::Select && !isPreviewingControls)
+    {
+        auto position = viewToDocument(e.position);
+        
+        const auto id = findTopmostShape(position, [](const Shape& shape) { return shape.type == Tool::Text; });
+        
+        if (id.isValid())
+            startTextEditing(position, id);
+    }
+}
+
+void MainComponent::mouseDrag(const juce::MouseEvent& e)
+{
+    UIDESIGNER_TRACE_SCOPE("mouseDrag");
+    
+    if (isPanningView)
+    {
+        panView(e.position - lastPanPosition);
+        lastPanPosition = e.position;
+    }
+    else if (isPreviewingControls)
+    {
+        if (shapes.contains(draggedControlId))
+            dragControl(viewToDocument(e.position));
+    }
+    else if (currentTool == Tool::Select)
+    {
+        UIDESIGNER_ASSERT_NO_ALLOCATIONS("mouseDrag");
+        
+        // Only remember where the mouse is, the shape is updated on the next vblank
+        pendingDragPosition = viewToDocument(e.position);
+        hasPendingDrag = true;
+    }
+    else if (isDrawing)
+    {
+        dragEnd = viewToDocument(e.position);
+        
+        if (currentTool == Tool::Freehand)
+        {
+            // Only the end of the stroke changes, both where it was and
+            // where it is now need redrawing
+            auto area = freehandStroke.getUnfinishedArea();
+            freehandStroke.addSample(dragEnd);
+            area = area.getUnion(freehandStroke.getUnfinishedArea())
+                       .expanded(std::max(1.0f, currentStyle.strokeWidth) * 0.5f);
+            
+            repaint(area.transformedBy(getViewTransform()).getSmallestIntegerContainer().expanded(2));
+        }
+        else
+        {
+            repaint();
+        }
+    }
+}
+
+void MainComponent::mouseUp(const juce::MouseEvent& e)
+{
+    UIDESIGNER_TRACE_SCOPE("mouseUp");
+    
+    if (isPanningView)
+    {
+        isPanningView = false;
+    }
+    else if (isPreviewingControls)
+    {
+        endControlDrag();
+    }
+    else if (currentTool == Tool::Select)
+    {
+        applyPendingUpdates();
+        endSnapDrag();
+        isDraggingShape = false;
+        isDraggingHandle = false;
+    }
+    else if (isDrawing)
+    {
+        isDrawing = false;
+        
+        Shape shape;
+        shape.type = currentTool;
+        shape.style = currentStyle;
+        
+        if (currentTool == Tool::Line)
+        {
+            // For lines, store actual start and end points
+            shape.lineStart = dragStart;
+            shape.lineEnd = dragEnd;
+            
+            // Create bounds that encompass the line
+            float left = std::min(dragStart.x, dragEnd.x);
+            float right = std::max(dragStart.x, dragEnd.x);
+            float top = std::min(dragStart.y, dragEnd.y);
+            float bottom = std::max(dragStart.y, dragEnd.y);
+            
+            // Add some padding for hit testing
+            shape.bounds = juce::Rectangle<float>(left, top,
+                                                right - left,
+                                                bottom - top);
+        }
+        else if (currentTool == Tool::Freehand)
+        {
+            auto points = freehandStroke.finish();
+            shape.bounds = juce::Rectangle<float>::findAreaThatContainsPoints(points.begin(), points.size());
+            
+            // Relative to the bounds, a straight stroke has no extent across
+            const auto origin = shape.bounds.getPosition();
+            const float scaleX = shape.bounds.getWidth() > 0.0f ? 1.0f / shape.bounds.getWidth() : 0.0f;
+            const float scaleY = shape.bounds.getHeight() > 0.0f ? 1.0f / shape.bounds.getHeight() : 0.0f;
+            
+            for (auto& point : points)
+                point = { (point.x - origin.x) * scaleX, (point.y - origin.y) * scaleY };
+            
+            points.minimiseStorageOverheads();
+            shape.points = std::make_shared<const juce::Array<juce::Point<float>>>(std::move(points));
+        }
+        else
+        {
+            shape.bounds = juce::Rectangle<float>(dragStart, dragEnd);
+        }
+        
+        shape.initializeRotationCenter();
+        const auto id = shapes.add(shape);
+        drawOrder.addShape(id);
+        markShapeDirty(shapes.getReference(id));
+        repaint();
+    }
+}
+
+void MainComponent::mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel)
+{
+    // Cmd/ctrl + wheel zooms around the mouse, a plain wheel or trackpad scroll pans
+    if (e.mods.isCommandDown())
+        setViewScale(viewScale * std::pow(2.0f, wheel.deltaY * wheelZoomSpeed), e.position);
+    else
+        panView({ wheel.deltaX * wheelPanSpeed, wheel.deltaY * wheelPanSpeed });
+}
+
+void MainComponent::mouseMagnify(const juce::MouseEvent& e, float scaleFactor)
+{
+    setViewScale(viewScale * scaleFactor, e.position);
+}
+
+juce::AffineTransform MainComponent::getViewTransform() const
+{
+    return juce::AffineTransform::scale(viewScale).translated(viewOffset);
+}
+
+juce::Point<float> MainComponent::viewToDocument(juce::Point<float> position) const
+{
+    return (position - viewOffset) / viewScale;
+}
+
+void MainComponent::setViewScale(float newScale, juce::Point<float> anchor)
+{
+    newScale = juce::jlimit(minViewScale, maxViewScale, newScale);
+    
+    if (newScale == viewScale)
+        return;
+    
+    auto anchorInDocument = viewToDocument(anchor);
+    viewScale = newScale;
+    
+    // Whole-pixel offsets keep cached tiles aligned with the screen
+    viewOffset = (anchor - anchorInDocument * viewScale).roundToInt().toFloat();
+    viewChanged();
+}
+
+void MainComponent::panView(juce::Point<float> delta)
+{
+    // Sub-pixel parts of the delta are kept until they add up to a whole pixel
+    panRemainder += delta;
+    auto wholePixels = panRemainder.roundToInt().toFloat();
+    panRemainder -= wholePixels;
+    
+    if (wholePixels.isOrigin())
+        return;
+    
+    viewOffset += wholePixels;
+    viewChanged();
+}
+
+void MainComponent::resetView()
+{
+    viewScale = 1.0f;
+    viewOffset = {};
+    panRemainder = {};
+    viewChanged();
+}
+
+void MainComponent::viewChanged()
+{
+    // Handles and the text editor are placed in component coordinates
+    cachedFrame = {};
+    updateSelectionHandles();
+    updateTextEditorTransform();
+    repaint();
+}
+
+void MainComponent::handleShapeManipulation(juce::Point<float> position)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto delta = position - lastMousePosition;
+        auto& shape = shapes.getReference(selectedShapeId);
+        markShapeDirty(shape);
+
+        numSnapGuides = 0;
+
+        if (isDraggingHandle)
+        {
+            if (activeHandle == SelectionHandle::Type::Rotate)
+            {
+                rotateShape(position);
+            }
+            else if (canSnapResize(shape))
+            {
+                // Resize from where the mouse alone would have put the edges,
+                // then snap the ones that moved
+                shape.bounds = unsnappedBounds;
+                resizeShape(position);
+                unsnappedBounds = shape.bounds;
+                
+                if (snappingEnabled)
+                    snapResizedEdges(shape);
+            }
+            else
+            {
+                resizeShape(position);
+            }
+        }
+        else if (isDraggingShape)
+        {
+            // Undo last frame's snap, so the shape keeps following the mouse
+            // and only snaps where it is now
+            shape.move(delta.x - snapOffset.x, delta.y - snapOffset.y);
+            snapOffset = snappingEnabled ? getMoveSnapOffset(getSnapBounds(shape)) : juce::Point<float>();
+            shape.move(snapOffset.x, snapOffset.y);
+            updateSelectionHandles();
+        }
+
+        markShapeDirty(shape);
+        repaint();
+    }
+
+    lastMousePosition = position;
+}
+
+void MainComponent::rotateShape(juce::Point<float> position)
+{
+    auto& shape = shapes.getReference(selectedShapeId);
+    
+    // Calculate current angle relative to the stored rotation center
+    float currentAngle = std::atan2(position.y - shape.rotationCenter.y,
+                                    position.x - shape.rotationCenter.x);
+    
+    // Update shape rotation
+    shape.rotation = initialRotation + (currentAngle - initialAngle);
+    
+    updateSelectionHandles();
+}
+
+void MainComponent::resizeShape(juce::Point<float> position)
+{
+    auto& shape = shapes.getReference(selectedShapeId);
+    auto delta = position - lastMousePosition;
+
+    // Transform the delta based on rotation
+    float cosAngle = std::cos(-shape.rotation);
+    float sinAngle = std::sin(-shape.rotation);
+    
+    // Rotate the delta vector to account for shape rotation
+    float transformedDeltaX = delta.x * cosAngle - delta.y * sinAngle;
+    float transformedDeltaY = delta.x * sinAngle + delta.y * cosAngle;
+    
+    // Create transformed delta
+    juce::Point<float> transformedDelta(transformedDeltaX, transformedDeltaY);
+
+    if (shape.type == Tool::Text && !shape.style->textStretchEnabled)
+    {
+        // For text, only allow moving without resizing (Figma-like behavior)
+        shape.bounds.translate(transformedDelta.x, transformedDelta.y);
+    }
+    else if (shape.type == Tool::Line)
+    {
+        // For lines, we need to update the actual line points
+        switch (activeHandle)
+        {
+            case SelectionHandle::Type::TopLeft:
+                shape.lineStart.addXY(delta.x, delta.y);
+                break;
+            case SelectionHandle::Type::BottomRight:
+                shape.lineEnd.addXY(delta.x, delta.y);
+                break;
+            default:
+                break;
+        }
+        
+        // Update bounds to encompass the new line position
+        float left = std::min(shape.lineStart.x, shape.lineEnd.x);
+        float right = std::max(shape.lineStart.x, shape.lineEnd.x);
+        float top = std::min(shape.lineStart.y, shape.lineEnd.y);
+        float bottom = std::max(shape.lineStart.y, shape.lineEnd.y);
+        
+        shape.bounds = juce::Rectangle<float>(left, top, right - left, bottom - top);
+    }
+    else
+    {
+        // Handle resizing based on the active handle
+        switch (activeHandle)
+        {
+            case SelectionHandle::Type::TopLeft:
+                shape.bounds.setTop(shape.bounds.getY() + transformedDelta.y);
+                shape.bounds.setLeft(shape.bounds.getX() + transformedDelta.x);
+                break;
+            case SelectionHandle::Type::Top:
+                shape.bounds.setTop(shape.bounds.getY() + transformedDelta.y);
+                break;
+            case SelectionHandle::Type::TopRight:
+                shape.bounds.setTop(shape.bounds.getY() + transformedDelta.y);
+                shape.bounds.setRight(shape.bounds.getRight() + transformedDelta.x);
+                break;
+            case SelectionHandle::Type::Right:
+                shape.bounds.setRight(shape.bounds.getRight() + transformedDelta.x);
+                break;
+            case SelectionHandle::Type::BottomRight:
+                shape.bounds.setBottom(shape.bounds.getBottom() + transformedDelta.y);
+                shape.bounds.setRight(shape.bounds.getRight() + transformedDelta.x);
+                break;
+            case SelectionHandle::Type::Bottom:
+                shape.bounds.setBottom(shape.bounds.getBottom() + transformedDelta.y);
+                break;
+            case SelectionHandle::Type::BottomLeft:
+                shape.bounds.setBottom(shape.bounds.getBottom() + transformedDelta.y);
+                shape.bounds.setLeft(shape.bounds.getX() + transformedDelta.x);
+                break;
+            case SelectionHandle::Type::Left:
+                shape.bounds.setLeft(shape.bounds.getX() + transformedDelta.x);
+                break;
+            default:
+                break;
+        }
+    }
+
+    updateSelectionHandles();
+}
+
+juce::Rectangle<float> MainComponent::getSnapBounds(const Shape& shape)
+{
+    auto area = shape.type == Tool::Line ? juce::Rectangle<float>(shape.lineStart, shape.lineEnd) : shape.bounds;
+    
+    if (shape.rotation != 0.0f)
+        area = area.transformedBy(juce::AffineTransform::rotation(shape.rotation, shape.rotationCenter.x, shape.rotationCenter.y));
+    
+    return area;
+}
+
+bool MainComponent::canSnapResize(const Shape& shape)
+{
+    // Only edges that stay axis-aligned can line up with others
+    return shape.rotation == 0.0f && shape.type != Tool::Line
+           && !(shape.type == Tool::Text && !shape.style->textStretchEnabled);
+}
+
+void MainComponent::setSnappingEnabled(bool shouldSnap)
+{
+    snappingEnabled = shouldSnap;
+    numSnapGuides = 0;
+    repaint();
+}
+
+void MainComponent::beginSnapDrag()
+{
+    if (!shapes.contains(selectedShapeId))
+        return;
+    
+    if (snapIndexNeedsRebuild)
+    {
+        UIDESIGNER_TRACE_SCOPE("rebuildSnapIndex");
+        
+        snapIndex.clear();
+        
+        for (int i = 0; i < shapes.size(); ++i)
+        {
+            const auto id = shapes.getId(i);
+            snapIndex.addShape(id, getSnapBounds(shapes.getReference(id)));
+        }
+        
+        snapIndex.sort();
+        snapIndexNeedsRebuild = false;
+    }
+    
+    const auto& shape = shapes.getReference(selectedShapeId);
+    unsnappedBounds = shape.bounds;
+    snapOffset = {};
+    numSnapGuides = 0;
+}
+
+void MainComponent::removeFromSnapIndex(ShapeId id)
+{
+    if (!snapIndexNeedsRebuild && !snapIndex.removeShape(id))
+        snapIndexNeedsRebuild = true;
+}
+
+void MainComponent::endSnapDrag()
+{
+    if ((isDraggingShape || isDraggingHandle) && !snapIndexNeedsRebuild
+        && shapes.contains(selectedShapeId))
+    {
+        const auto newBounds = getSnapBounds(shapes.getReference(selectedShapeId));
+        
+        if (!snapIndex.updateShape(selectedShapeId, newBounds))
+            snapIndexNeedsRebuild = true;
+    }
+    
+    if (numSnapGuides > 0)
+    {
+        numSnapGuides = 0;
+        repaint();
+    }
+}
+
+MainComponent::AxisSnap MainComponent::findAxisSnap(SnapIndex::Axis axis, juce::Rectangle<float> bounds, float maxDistance) const
+{
+    using Kind = SnapIndex::Kind;
+    
+    const auto span = axis == SnapIndex::Axis::X ? bounds.getHorizontalRange() : bounds.getVerticalRange();
+    const auto extent = axis == SnapIndex::Axis::X ? bounds.getVerticalRange() : bounds.getHorizontalRange();
+    
+    AxisSnap best;
+    float bestDistance = std::numeric_limits<float>::max();
+    
+    for (auto value : { span.getStart(), (span.getStart() + span.getEnd()) * 0.5f, span.getEnd() })
+    {
+        if (auto* edge = snapIndex.findNearest(axis, value, maxDistance, selectedShapeId))
+        {
+            if (std::abs(edge->position - value) < bestDistance)
+            {
+                best = { edge->position - value, edge, nullptr, nullptr };
+                bestDistance = std::abs(best.offset);
+            }
+        }
+    }
+    
+    // Equal gaps to the nearest shapes on either side
+    auto* before = snapIndex.findBefore(axis, Kind::End, span.getStart() + maxDistance, extent, selectedShapeId);
+    auto* after = snapIndex.findAfter(axis, Kind::Start, span.getEnd() - maxDistance, extent, selectedShapeId);
+    
+    if (before != nullptr && after != nullptr && after->position - before->position > span.getLength())
+    {
+        const float centredStart = (before->position + after->position - span.getLength()) * 0.5f;
+        const float offset = centredStart - span.getStart();
+        
+        if (std::abs(offset) <= maxDistance && std::abs(offset) < bestDistance)
+            best = { offset, nullptr, before, after };
+    }
+    
+    return best;
+}
+
+juce::Point<float> MainComponent::getMoveSnapOffset(juce::Rectangle<float> bounds)
+{
+    const float maxDistance = snapDistancePixels / viewScale;
+    const auto x = findAxisSnap(SnapIndex::Axis::X, bounds, maxDistance);
+    const auto y = findAxisSnap(SnapIndex::Axis::Y, bounds, maxDistance);
+    
+    const auto snapped = bounds.translated(x.offset, y.offset);
+    addSnapGuides(SnapIndex::Axis::X, x, snapped);
+    addSnapGuides(SnapIndex::Axis::Y, y, snapped);
+    
+    return { x.offset, y.offset };
+}
+
+void MainComponent::snapResizedEdges(Shape& shape)
+{
+    using Type = SelectionHandle::Type;
+    
+    const float maxDistance = snapDistancePixels / viewScale;
+    auto& bounds = shape.bounds;
+    
+    const bool movesLeft = activeHandle == Type::TopLeft || activeHandle == Type::Left || activeHandle == Type::BottomLeft;
+    const bool movesRight = activeHandle == Type::TopRight || activeHandle == Type::Right || activeHandle == Type::BottomRight;
+    const bool movesTop = activeHandle == Type::TopLeft || activeHandle == Type::Top || activeHandle == Type::TopRight;
+    const bool movesBottom = activeHandle == Type::BottomLeft || activeHandle == Type::Bottom || activeHandle == Type::BottomRight;
+    
+    const SnapIndex::Edge* xEdge = nullptr;
+    const SnapIndex::Edge* yEdge = nullptr;
+    
+    if (movesLeft && (xEdge = snapIndex.findNearest(SnapIndex::Axis::X, bounds.getX(), maxDistance, selectedShapeId)))
+        bounds.setLeft(xEdge->position);
+    else if (movesRight && (xEdge = snapIndex.findNearest(SnapIndex::Axis::X, bounds.getRight(), maxDistance, selectedShapeId)))
+        bounds.setRight(xEdge->position);
+    
+    if (movesTop && (yEdge = snapIndex.findNearest(SnapIndex::Axis::Y, bounds.getY(), maxDistance, selectedShapeId)))
+        bounds.setTop(yEdge->position);
+    else if (movesBottom && (yEdge = snapIndex.findNearest(SnapIndex::Axis::Y, bounds.getBottom(), maxDistance, selectedShapeId)))
+        bounds.setBottom(yEdge->position);
+    
+    if (xEdge != nullptr)
+        addSnapGuides(SnapIndex::Axis::X, { 0.0f, xEdge, nullptr, nullptr }, bounds);
+    if (yEdge != nullptr)
+        addSnapGuides(SnapIndex::Axis::Y, { 0.0f, yEdge, nullptr, nullptr }, bounds);
+    
+    updateSelectionHandles();
+}
+
+void MainComponent::addSnapGuides(SnapIndex::Axis axis, const AxisSnap& snap, juce::Rectangle<float> snappedBounds)
+{
+    const bool isX = axis == SnapIndex::Axis::X;
+    const auto extent = isX ? snappedBounds.getVerticalRange() : snappedBounds.getHorizontalRange();
+    
+    // A line along the shared edge, across both shapes
+    if (snap.edge != nullptr)
+        addSnapGuide(isX, snap.edge->position, extent.getUnionWith(snap.edge->extent));
+    
+    // The two equal gaps, through the middle of the moved shape
+    if (snap.gapBefore != nullptr && snap.gapAfter != nullptr)
+    {
+        const auto span = isX ? snappedBounds.getHorizontalRange() : snappedBounds.getVerticalRange();
+        const float middle = extent.getStart() + extent.getLength() * 0.5f;
+        addSnapGuide(!isX, middle, { snap.gapBefore->position, span.getStart() });
+        addSnapGuide(!isX, middle, { span.getEnd(), snap.gapAfter->position });
+    }
+}
+
+void MainComponent::addSnapGuide(bool isVertical, float position, juce::Range<float> span)
+{
+    if (numSnapGuides < maxSnapGuides)
+        snapGuides[(size_t) numSnapGuides++] = { isVertical, position, span };
+}
+
+void MainComponent::drawSnapGuides(juce::Graphics& g)
+{
+    if (numSnapGuides == 0)
+        return;
+    
+    const auto viewTransform = getViewTransform();
+    g.setColour(juce::Colours::deeppink);
+    
+    for (int i = 0; i < numSnapGuides; ++i)
+    {
+        const auto& guide = snapGuides[(size_t) i];
+        auto line = guide.isVertical ? juce::Line<float>(guide.position, guide.span.getStart(), guide.position, guide.span.getEnd())
+                                     : juce::Line<float>(guide.span.getStart(), guide.position, guide.span.getEnd(), guide.position);
+        
+        // Guides are always horizontal or vertical, so a line one pixel wide
+        // is a rectangle. Graphics::drawLine() would build a path for it.
+        const auto start = line.getStart().transformedBy(viewTransform);
+        const auto end = line.getEnd().transformedBy(viewTransform);
+        const auto halfWidth = guide.isVertical ? juce::Point<float>(0.5f, 0.0f) : juce::Point<float>(0.0f, 0.5f);
+        
+        g.fillRect(juce::Rectangle<float>(start - halfWidth, end + halfWidth));
+    }
+}
+
+void MainComponent::applyPendingUpdates()
+{
+    if (hasPendingDrag)
+    {
+        UIDESIGNER_TRACE_SCOPE("applyPendingDrag");
+        
+        // All mouse movement since the last frame is applied as a single delta
+        hasPendingDrag = false;
+        
+        {
+            UIDESIGNER_ASSERT_NO_ALLOCATIONS("handleShapeManipulation");
+            handleShapeManipulation(pendingDragPosition);
+        }
+        
+        // Kept outside the check: TextEditor::setText always allocates, but
+        // the editors are only touched when the rounded size actually changes
+        if (isDraggingHandle && toolWindow != nullptr)
+            toolWindow->getToolPanel().updateDimensionEditors(getSelectedShape());
+    }
+    
+    auto edits = std::exchange(pendingStyleEdits, {});
+    
+    if (edits.fillColour.has_value())
+        updateSelectedShapeFillColour(*edits.fillColour);
+    if (edits.strokeColour.has_value())
+        updateSelectedShapeStrokeColour(*edits.strokeColour);
+    if (edits.strokeWidth.has_value())
+        updateSelectedShapeStrokeWidth(*edits.strokeWidth);
+    if (edits.cornerRadius.has_value())
+        updateSelectedShapeCornerRadius(*edits.cornerRadius);
+    if (edits.fontSize.has_value())
+        updateSelectedShapeFontSize(*edits.fontSize);
+}
+
+void MainComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
+{
+    if (source == ImageLibrary::getInstanceWithoutCreating())
+    {
+        imagesLoaded();
+        return;
+    }
+    
+    if (auto* cs = dynamic_cast<juce::ColourSelector*>(source))
+    {
+        if (currentlyEditingFillColour)
+        {
+            currentStyle.fillColour = cs->getCurrentColour();
+        }
+        else
+        {
+            currentStyle.strokeColour = cs->getCurrentColour();
+        }
+        repaint();
+    }
+}
+
+bool MainComponent::keyPressed(const juce::KeyPress& key, Component* /*originatingComponent*/)
+{
+    UIDESIGNER_TRACE_SCOPE("keyPressed");
+    
+    applyPendingUpdates();
+    
+    if (key == juce::KeyPress('p', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        setPerformanceOverlayVisible(!performanceOverlay.isVisible());
+        return true;
+    }
+    
+    if (key == juce::KeyPress('t', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        toggleTraceRecording();
+        return true;
+    }
+    
+    if (key == juce::KeyPress('r', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        switch (renderMode)
+        {
+            case RenderMode::Direct:        setRenderMode(RenderMode::Tiled); break;
+            case RenderMode::Tiled:         setRenderMode(RenderMode::Progressive); break;
+            case RenderMode::Progressive:   setRenderMode(RenderMode::Threaded); break;
+            case RenderMode::Threaded:      setRenderMode(RenderMode::Direct); break;
+        }
+        return true;
+    }
+    
+    if (key == juce::KeyPress('0', juce::ModifierKeys::commandModifier, 0))
+    {
+        resetView();
+        return true;
+    }
+    
+    if (key == juce::KeyPress('k', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        createSymbolFromSelection();
+        return true;
+    }
+    
+    if (key == juce::KeyPress('d', juce::ModifierKeys::commandModifier, 0))
+    {
+        duplicateSelectedShape();
+        return true;
+    }
+    
+    // With shift, some keyboards report the brackets as braces
+    if (key.getModifiers().isCommandDown())
+    {
+        const auto keyCode = key.getKeyCode();
+        const bool toEnd = key.getModifiers().isShiftDown();
+        
+        if (keyCode == ']' || keyCode == '}')
+        {
+            if (toEnd)
+                bringSelectedShapeToFront();
+            else
+                bringSelectedShapeForward();
+            
+            return true;
+        }
+        
+        if (keyCode == '[' || keyCode == '{')
+        {
+            if (toEnd)
+                sendSelectedShapeToBack();
+            else
+                sendSelectedShapeBackward();
+            
+            return true;
+        }
+    }
+    
+    if (key == juce::KeyPress('b', juce::ModifierKeys::commandModifier, 0))
+    {
+        cycleSelectedShapeControl();
+        return true;
+    }
+    
+    if (key == juce::KeyPress('b', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        bindSelectedShapeToNextParameter();
+        return true;
+    }
+    
+    if (key == juce::KeyPress('g', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        setSnappingEnabled(!snappingEnabled);
+        return true;
+    }
+    
+    if (key == juce::KeyPress('f', juce::ModifierKeys::commandModifier | juce::ModifierKeys::shiftModifier, 0))
+    {
+        exportSelectedFilmstrip();
+        return true;
+    }
+    
+    if (key == juce::KeyPress('e', juce::ModifierKeys::commandModifier, 0))
+    {
+        setControlPreviewEnabled(!isPreviewingControls);
+        return true;
+    }
+    
+    if (key == juce::KeyPress('=', juce::ModifierKeys::commandModifier, 0)
+        || key == juce::KeyPress('-', juce::ModifierKeys::commandModifier, 0))
+    {
+        const float factor = key.getKeyCode() == '=' ? 1.25f : 0.8f;
+        setViewScale(viewScale * factor, getLocalBounds().getCentre().toFloat());
+        return true;
+    }
+    
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        
+        if (key == juce::KeyPress::deleteKey || key == juce::KeyPress::backspaceKey)
+        {
+            markShapeDirty(shape);
+            removeFromSnapIndex(selectedShapeId);
+            drawOrder.removeShape(selectedShapeId);
+            shapes.remove(selectedShapeId);
+            selectedShapeId = {};
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::leftKey) && key.getModifiers().isShiftDown())
+        {
+            markShapeDirty(shape);
+            shape.move(-10.0f, 0.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::rightKey) && key.getModifiers().isShiftDown())
+        {
+            markShapeDirty(shape);
+            shape.move(10.0f, 0.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::upKey) && key.getModifiers().isShiftDown())
+        {
+            markShapeDirty(shape);
+            shape.move(0.0f, -10.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::downKey) && key.getModifiers().isShiftDown())
+        {
+            markShapeDirty(shape);
+            shape.move(0.0f, 10.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::leftKey))
+        {
+            markShapeDirty(shape);
+            shape.move(-1.0f, 0.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::rightKey))
+        {
+            markShapeDirty(shape);
+            shape.move(1.0f, 0.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::upKey))
+        {
+            markShapeDirty(shape);
+            shape.move(0.0f, -1.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+        else if (key.isKeyCode(juce::KeyPress::downKey))
+        {
+            markShapeDirty(shape);
+            shape.move(0.0f, 1.0f);
+            markShapeDirty(shape);
+            updateSelectionHandles();
+            repaint();
+            return true;
+        }
+    }
+    
+    return false;
+}
+
+bool MainComponent::keyStateChanged(bool isKeyDown, Component *originatingComponent)
+{
+    return false;
+}
+
+void MainComponent::deselectAllShapes()
+{
+    // Edits queued for the old selection must not land on the next one
+    applyPendingUpdates();
+    
+    selectedShapeId = {};
+    updateSelectionHandles();
+    updateToolPanelFromShape(nullptr);
+}
+
+void MainComponent::setCurrentTool(Tool tool)
+{
+    currentTool = tool;
+    if (tool != Tool::Select)
+        deselectAllShapes();
+}
+
+void MainComponent::setFillEnabled(bool enabled)
+{
+    currentStyle.hasFill = enabled;
+    repaint();
+}
+
+void MainComponent::setFillColour(juce::Colour colour)
+{
+    currentStyle.fillColour = colour;
+    repaint();
+}
+
+void MainComponent::setStrokeColour(juce::Colour colour)
+{
+    currentStyle.strokeColour = colour;
+    repaint();
+}
+
+void MainComponent::setStrokeWidth(float width)
+{
+    if (isOpenPath(currentTool))
+        width = std::max(1.0f, width);
+    
+    currentStyle.strokeWidth = width;
+    repaint();
+}
+
+void MainComponent::setCornerRadius(float radius)
+{
+    currentStyle.cornerRadius = radius;
+    repaint();
+}
+
+void MainComponent::setStrokePattern(StrokePattern pattern)
+{
+    currentStyle.strokePattern = pattern;
+    repaint();
+}
+
+void MainComponent::updateSelectedShapeFill(bool enabled)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        shape.style.edit([&](Style& style) { style.hasFill = enabled; });
+        markShapeDirty(shape);
+        repaint();
+    }
+    // Still update current style for new shapes
+    currentStyle.hasFill = enabled;
+}
+
+void MainComponent::updateSelectedShapeFillColour(juce::Colour colour)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        shape.style.edit([&](Style& style) { style.fillColour = colour; });
+        markShapeDirty(shape);
+        repaint();
+    }
+    currentStyle.fillColour = colour;
+}
+
+void MainComponent::updateSelectedShapeStrokeColour(juce::Colour colour)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        
+        if (shape.type == Tool::Instance)
+            editSymbolStyle(shape.symbolId, [&](Style& style, Tool) { style.strokeColour = colour; });
+        else
+            shape.style.edit([&](Style& style) { style.strokeColour = colour; });
+        
+        markShapeDirty(shape);
+        repaint();
+    }
+    currentStyle.strokeColour = colour;
+}
+
+void MainComponent::updateSelectedShapeStrokeWidth(float width)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        if (shape.type == Tool::Instance)
+        {
+            editSymbolStyle(shape.symbolId, [&](Style& style, Tool type)
+            {
+                style.strokeWidth = isOpenPath(type) ? std::max(1.0f, width) : width;
+            });
+        }
+        else
+        {
+            if (isOpenPath(shape.type))
+                width = std::max(1.0f, width);
+            markShapeDirty(shape);
+            shape.style.edit([&](Style& style) { style.strokeWidth = width; });
+            markShapeDirty(shape);
+        }
+        repaint();
+    }
+    currentStyle.strokeWidth = width;
+}
+
+void MainComponent::updateSelectedShapeCornerRadius(float radius)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        
+        if (shape.type == Tool::Instance)
+            editSymbolStyle(shape.symbolId, [&](Style& style, Tool) { style.cornerRadius = radius; });
+        else
+            shape.style.edit([&](Style& style) { style.cornerRadius = radius; });
+        
+        markShapeDirty(shape);
+        repaint();
+    }
+    currentStyle.cornerRadius = radius;
+}
+
+void MainComponent::updateSelectedShapeStrokePattern(StrokePattern pattern)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        
+        if (shape.type == Tool::Instance)
+            editSymbolStyle(shape.symbolId, [&](Style& style, Tool) { style.strokePattern = pattern; });
+        else
+            shape.style.edit([&](Style& style) { style.strokePattern = pattern; });
+        
+        markShapeDirty(shape);
+        repaint();
+    }
+    currentStyle.strokePattern = pattern;
+}
+
+void MainComponent::updateSelectedShapeFontSize(float size)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        if (shape.type == Tool::Text)
+        {
+            markShapeDirty(shape);
+            shape.style.edit([&](Style& style) { style.fontSize = size; });
+            
+            // Recalculate bounds based on new font size
+            const auto font = shape.getFont();
+            auto width = font.getStringWidth(shape.text);
+            auto height = font.getHeight();
+            shape.bounds.setSize(width, height);
+            markShapeDirty(shape);
+            
+            updateSelectionHandles();
+            repaint();
+        }
+    }
+    currentStyle.fontSize = size;
+}
+
+void MainComponent::queueSelectedShapeFillColour(juce::Colour colour)
+{
+    pendingStyleEdits.fillColour = colour;
+    
+    if (!isShowing())
+        applyPendingUpdates();
+}
+
+void MainComponent::queueSelectedShapeStrokeColour(juce::Colour colour)
+{
+    pendingStyleEdits.strokeColour = colour;
+    
+    if (!isShowing())
+        applyPendingUpdates();
+}
+
+void MainComponent::queueSelectedShapeStrokeWidth(float width)
+{
+    pendingStyleEdits.strokeWidth = width;
+    
+    if (!isShowing())
+        applyPendingUpdates();
+}
+
+void MainComponent::queueSelectedShapeCornerRadius(float radius)
+{
+    pendingStyleEdits.cornerRadius = radius;
+    
+    if (!isShowing())
+        applyPendingUpdates();
+}
+
+void MainComponent::queueSelectedShapeFontSize(float size)
+{
+    pendingStyleEdits.fontSize = size;
+    
+    if (!isShowing())
+        applyPendingUpdates();
+}
+
+const MainComponent::Shape* MainComponent::getSelectedShape() const
+{
+    return shapes.contains(selectedShapeId) ? &shapes.getReference(selectedShapeId) : nullptr;
+}
+
+void MainComponent::updateSelectedShapeBounds(const juce::Rectangle<float>& newBounds)
+{
+    if (shapes.contains(selectedShapeId))
+    {
+        auto& shape = shapes.getReference(selectedShapeId);
+        markShapeDirty(shape);
+        shape.bounds = newBounds;
+        markShapeDirty(shape);
+        updateSelectionHandles();
+        repaint();
+    }
+}
+
+void MainComponent::prewarmDocumentFonts()
+{
+    juce::StringArray families;
+    families.add(currentStyle.fontFamily);
+    
+    for (auto& shape : shapes)
+        if (shape.type == Tool::Text)
+            families.addIfNotAlreadyThere(shape.style->fontFamily);
+    
+    FontCache::getInstance()->prewarm(families);
+}
+
+static bool isImportableImage(const juce::String& path)
+{
+    // The formats JUCE decodes and ImageLibrary::readImageSize() understands
+    return juce::File::isAbsolutePath(path)
+           && juce::File(path).hasFileExtension("png;jpg;jpeg;gif");
+}
+
+bool MainComponent::isInterestedInFileDrag(const juce::StringArray& files)
+{
+    for (auto& file : files)
+        if (isImportableImage(file))
+            return true;
+    
+    return false;
+}
+
+void MainComponent::filesDropped(const juce::StringArray& files, int x, int y)
+{
+    importImages(files, viewToDocument(juce::Point<int>(x, y).toFloat()));
+}
+
+void MainComponent::importImages(const juce::StringArray& files)
+{
+    // Top left of the view, below the show tools button
+    const auto topLeft = juce::Point<float>(0.0f, (float) showToolsButton.getBottom());
+    importImages(files, viewToDocument(topLeft) + juce::Point<float>(importedImageSpacing, importedImageSpacing));
+}
+
+void MainComponent::importImages(const juce::StringArray& files, juce::Point<float> position)
+{
+    // Rows are as wide as the view, so a whole skin doesn't end up in one line
+    const float rowWidth = (float) getWidth() / viewScale;
+    auto origin = position;
+    float rowHeight = 0.0f;
+    
+    for (auto& path : files)
+    {
+        if (!isImportableImage(path))
+            continue;
+        
+        // Only the file header is read here, the pixels are decoded in the background
+        auto size = ImageLibrary::readImageSize(juce::File(path)).toFloat();
+        
+        if (size.isEmpty())
+            size = { defaultImageSize, defaultImageSize };
+        
+        ImageLibrary::getInstance()->load(path);
+        
+        if (origin.x > position.x && origin.x + size.getWidth() > position.x + rowWidth)
+        {
+            origin = { position.x, origin.y + rowHeight + importedImageSpacing };
+            rowHeight = 0.0f;
+        }
+        
+        Shape shape;
+        shape.type = Tool::Image;
+        shape.bounds = size.withPosition(origin);
+        shape.imageFile = path;
+        shape.initializeRotationCenter();
+        const auto id = shapes.add(shape);
+        drawOrder.addShape(id);
+        markShapeDirty(shapes.getReference(id));
+        
+        origin.x += size.getWidth() + importedImageSpacing;
+        rowHeight = std::max(rowHeight, size.getHeight());
+    }
+    
+    repaint();
+}
+
+void MainComponent::imagesLoaded()
+{
+    // The document is unchanged, but what has been rendered so far shows
+    // placeholders. Instances are included for images inside symbols.
+    for (auto& shape : shapes)
+    {
+        if (shape.type == Tool::Image || shape.type == Tool::Instance)
+        {
+            const auto area = getShapeDrawnBounds(shape);
+            tileCache->invalidate(area);
+            progressiveRenderer.invalidate(area);
+            markSnapshotOutdated(shape);
+        }
+    }
+    
+    // A new snapshot makes the render thread draw the frame again
+    cachedFrame = {};
+    repaint();
+}
+
+void MainComponent::setPerformanceOverlayVisible(bool shouldBeVisible)
+{
+    performanceOverlay.setVisible(shouldBeVisible);
+    repaint();
+}
+
+void MainComponent::toggleTraceRecording()
+{
+    if (!TraceRecorder::isEnabled())
+    {
+        TraceRecorder::setEnabled(true);
+        return;
+    }
+    
+    TraceRecorder::setEnabled(false);
+    
+    auto traceFile = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                        .getNonexistentChildFile("UiDesigner-trace-" + juce::Time::getCurrentTime().formatted("%Y%m%d-%H%M%S"), ".json");
+    
+    if (TraceRecorder::writeChromeTrace(traceFile))
+        traceFile.revealToUser();
+    else
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Trace recording",
+                                               "Couldn't write " + traceFile.getFullPathName());
+}
+
+void MainComponent::createSymbolFromSelection()
+{
+    if (!shapes.contains(selectedShapeId) || isEditingText)
+        return;
+    
+    if (shapes.getReference(selectedShapeId).type == Tool::Instance)
+        return;
+    
+    // The selected shape acts as the container, e.g. a knob's body with its
+    // pointer and label on top of it
+    const auto area = shapes.getReference(selectedShapeId).getDrawnBounds();
+    juce::Array<Shape> masterShapes;
+    juce::Array<ShapeId> containedShapes;
+    
+    for (int position = drawOrder.getPosition(selectedShapeId); position < drawOrder.size(); ++position)
+    {
+        const auto id = drawOrder.getShape(position);
+        auto& shape = shapes.getReference(id);
+        
+        if (masterShapes.isEmpty() || (shape.type != Tool::Instance && area.contains(shape.getDrawnBounds())))
+        {
+            markShapeDirty(shape);
+            masterShapes.add(shape);
+            
+            if (id != selectedShapeId)
+                containedShapes.add(id);
+        }
+    }
+    
+    // One pass over the draw order and the snap index for all of them
+    drawOrder.removeShapes(containedShapes);
+    
+    if (!snapIndexNeedsRebuild && !snapIndex.removeShapes(containedShapes))
+        snapIndexNeedsRebuild = true;
+    
+    for (auto id : containedShapes)
+        shapes.remove(id);
+    
+    // The instance takes the container's place, and keeps its id
+    const int symbolId = symbolLibrary->addSymbol(std::move(masterShapes));
+    symbolSnapshot = nullptr;
+    auto& instance = shapes.getReference(selectedShapeId);
+    instance = symbolLibrary->createInstance(symbolId);
+    markShapeDirty(instance);
+    updateSelectionHandles();
+    updateToolPanelFromShape(&instance);
+    repaint();
+}
+
+void MainComponent::duplicateSelectedShape()
+{
+    if (!shapes.contains(selectedShapeId) || isEditingText)
+        return;
+    
+    auto copy = shapes.getReference(selectedShapeId);
+    copy.move(duplicateOffset, duplicateOffset);
+    
+    selectedShapeId = shapes.add(copy);
+    drawOrder.addShape(selectedShapeId);
+    markShapeDirty(shapes.getReference(selectedShapeId));
+    updateSelectionHandles();
+    repaint();
+}
+
+void MainComponent::bringSelectedShapeForward()    { restackSelectedShape(&DrawOrder::bringForward); }
+void MainComponent::sendSelectedShapeBackward()    { restackSelectedShape(&DrawOrder::sendBackward); }
+void MainComponent::bringSelectedShapeToFront()    { restackSelectedShape(&DrawOrder::bringToFront); }
+void MainComponent::sendSelectedShapeToBack()      { restackSelectedShape(&DrawOrder::sendToBack); }
+
+void MainComponent::restackSelectedShape(void (DrawOrder::*restack)(SlotId))
+{
+    if (!shapes.contains(selectedShapeId) || isEditingText)
+        return;
+    
+    // Only the stacking changes, so only the shape's own area needs redrawing
+    const int oldPosition = drawOrder.getPosition(selectedShapeId);
+    (drawOrder.*restack)(selectedShapeId);
+    
+    if (drawOrder.getPosition(selectedShapeId) != oldPosition)
+    {
+        markShapeDirty(shapes.getReference(selectedShapeId));
+        repaint();
+    }
+}
+
+void MainComponent::setParameterBindings(ParameterBindings* bindings)
+{
+    endControlDrag();
+    parameterBindings = bindings;
+    repaint();
+}
+
+int MainComponent::findFreeParameter(int startIndex) const
+{
+    for (int i = 0; i < ParameterBindings::numParameters; ++i)
+    {
+        const int index = (startIndex + i) % ParameterBindings::numParameters;
+        bool isUsed = false;
+        
+        for (auto& shape : shapes)
+            isUsed = isUsed || (shape.control != ControlType::None && shape.parameterIndex == index);
+        
+        if (!isUsed)
+            return index;
+    }
+    
+    return -1;
+}
+
+void MainComponent::cycleSelectedShapeControl()
+{
+    if (!shapes.contains(selectedShapeId))
+        return;
+    
+    auto& shape = shapes.getReference(selectedShapeId);
+    
+    if (shape.control == ControlType::None)
+    {
+        shape.parameterIndex = findFreeParameter(0);
+        
+        // Every parameter is taken already
+        if (shape.parameterIndex < 0)
+            return;
+    }
+    
+    markShapeDirty(shape);
+    
+    switch (shape.control)
+    {
+        case ControlType::None:     shape.control = ControlType::Knob; break;
+        case ControlType::Knob:     shape.control = ControlType::Slider; break;
+        case ControlType::Slider:   shape.control = ControlType::Toggle; break;
+        case ControlType::Toggle:   shape.control = ControlType::None; shape.parameterIndex = -1; break;
+    }
+    
+    markShapeDirty(shape);
+    repaint();
+}
+
+void MainComponent::bindSelectedShapeToNextParameter()
+{
+    if (!shapes.contains(selectedShapeId))
+        return;
+    
+    auto& shape = shapes.getReference(selectedShapeId);
+    
+    if (shape.control == ControlType::None)
+        return;
+    
+    const int index = findFreeParameter(shape.parameterIndex + 1);
+    
+    if (index < 0)
+        return;
+    
+    markShapeDirty(shape);
+    shape.parameterIndex = index;
+    markShapeDirty(shape);
+    repaint();
+}
+
+void MainComponent::setAudioAnalyser(AudioAnalyser* analyser)
+{
+    audioAnalyser = analyser;
+    repaint();
+}
+
+void MainComponent::repaintAudioDisplays()
+{
+    audioDisplayIds.removeIf([this](ShapeId id)
+    {
+        return !shapes.contains(id) || !isAudioDisplay(shapes.getReference(id));
+    });
+    
+    const auto viewTransform = getViewTransform();
+    
+    for (auto id : audioDisplayIds)
+        repaint(shapes.getReference(id).getDrawnBounds().transformedBy(viewTransform).getSmallestIntegerContainer().expanded(2));
+}
+
+void MainComponent::drawAudioDisplays(juce::Graphics& g)
+{
+    if (audioAnalyser == nullptr)
+        return;
+    
+    const auto clip = g.getClipBounds().toFloat();
+    
+    // The list is only tidied up on the vblank, so it may still hold
+    // shapes that are gone
+    for (auto id : audioDisplayIds)
+    {
+        if (!shapes.contains(id))
+            continue;
+        
+        const auto& shape = shapes.getReference(id);
+        
+        if (isAudioDisplay(shape) && shape.getDrawnBounds().intersects(clip))
+            drawAudioDisplay(g, shape);
+    }
+}
+
+void MainComponent::drawAudioDisplay(juce::Graphics& g, const Shape& shape)
+{
+    // The frame is part of the document, only the signal is drawn here
+    juce::Graphics::ScopedSaveState stateSave(g);
+    g.addTransform(juce::AffineTransform::rotation(shape.rotation, shape.rotationCenter.x, shape.rotationCenter.y));
+    
+    const auto area = shape.bounds.reduced(shape.style->strokeWidth);
+    g.reduceClipRegion(area.getSmallestIntegerContainer());
+    g.setColour(shape.style->strokeWidth > 0.0f ? shape.style->strokeColour : juce::Colours::darkgreen);
+    
+    const float lineThickness = 1.5f / viewScale;
+    
+    if (shape.type == Tool::Meter)
+    {
+        // RMS as a bar, peak as a line, along the longer side
+        const bool isVertical = area.getHeight() >= area.getWidth();
+        const float rms = juce::jmin(1.0f, audioAnalyser->getRms());
+        const float peak = juce::jmin(1.0f, audioAnalyser->getPeak());
+        
+        if (isVertical)
+        {
+            g.fillRect(area.withTop(area.getBottom() - area.getHeight() * rms));
+            g.fillRect(area.withTop(area.getBottom() - area.getHeight() * peak).withHeight(lineThickness));
+        }
+        else
+        {
+            g.fillRect(area.withWidth(area.getWidth() * rms));
+            g.fillRect(area.withX(area.getX() + area.getWidth() * peak - lineThickness).withWidth(lineThickness));
+        }
+        return;
+    }
+    
+    auto& path = frameArena.acquirePath();
+    
+    if (shape.type == Tool::Scope)
+    {
+        const auto& samples = audioAnalyser->getScope();
+        const float xScale = area.getWidth() / (float) (samples.size() - 1);
+        
+        for (size_t i = 0; i < samples.size(); ++i)
+        {
+            const juce::Point<float> point(area.getX() + (float) i * xScale,
+                                           area.getCentreY() - juce::jlimit(-1.0f, 1.0f, samples[i]) * area.getHeight() * 0.5f);
+            
+            if (i == 0)
+                path.startNewSubPath(point);
+            else
+                path.lineTo(point);
+        }
+        
+        g.strokePath(path, juce::PathStrokeType(lineThickness));
+    }
+    else
+    {
+        // Bins on a logarithmic frequency axis, filled down to the bottom
+        const auto& levels = audioAnalyser->getSpectrum();
+        const float logNumBins = std::log((float) levels.size());
+        
+        path.startNewSubPath(area.getBottomLeft());
+        
+        for (size_t i = 1; i < levels.size(); ++i)
+            path.lineTo(area.getX() + area.getWidth() * std::log((float) i) / logNumBins,
+                        area.getBottom() - levels[i] * area.getHeight());
+        
+        path.lineTo(area.getBottomRight());
+        path.closeSubPath();
+        g.fillPath(path);
+    }
+}
+
+void MainComponent::setControlPreviewEnabled(bool shouldPreview)
+{
+    if (shouldPreview == isPreviewingControls)
+        return;
+    
+    if (isEditingText)
+        finishTextEditing();
+    
+    endControlDrag();
+    isPreviewingControls = shouldPreview;
+    
+    // Handles would suggest the shapes can still be edited
+    if (isPreviewingControls)
+        deselectAllShapes();
+    
+    repaint();
+}
+
+bool MainComponent::beginControlDrag(juce::Point<float> position)
+{
+    if (parameterBindings == nullptr)
+        return false;
+    
+    const auto id = findTopmostShape(position, [](const Shape& shape) { return shape.control != ControlType::None; });
+    
+    if (id.isValid())
+    {
+        auto& shape = shapes.getReference(id);
+        
+        if (!juce::isPositiveAndBelow(shape.parameterIndex, ParameterBindings::numParameters))
+            return false;
+        
+        draggedControlId = id;
+        controlDragStart = position;
+        controlDragStartValue = parameterBindings->getValue(shape.parameterIndex);
+        parameterBindings->beginGesture(shape.parameterIndex);
+        
+        if (shape.control == ControlType::Toggle)
+            parameterBindings->setValue(shape.parameterIndex, controlDragStartValue < 0.5f ? 1.0f : 0.0f);
+        else
+            dragControl(position);
+        
+        return true;
+    }
+    
+    return false;
+}
+
+void MainComponent::dragControl(juce::Point<float> position)
+{
+    if (parameterBindings == nullptr || !shapes.contains(draggedControlId))
+        return;
+    
+    auto& shape = shapes.getReference(draggedControlId);
+    float value = controlDragStartValue;
+    
+    if (shape.control == ControlType::Knob)
+    {
+        // Screen distance, so the knob feels the same at every zoom level
+        value += (controlDragStart.y - position.y) * viewScale / knobDragPixels;
+    }
+    else if (shape.control == ControlType::Slider)
+    {
+        auto local = position.transformedBy(juce::AffineTransform::rotation(-shape.rotation,
+                                                                            shape.rotationCenter.x,
+                                                                            shape.rotationCenter.y));
+        const auto& bounds = shape.bounds;
+        
+        if (bounds.getWidth() >= bounds.getHeight())
+            value = (local.x - bounds.getX()) / juce::jmax(1.0f, bounds.getWidth());
+        else
+            value = (bounds.getBottom() - local.y) / juce::jmax(1.0f, bounds.getHeight());
+    }
+    else
+    {
+        return;
+    }
+    
+    // The repaint follows from the parameter change, like host automation
+    parameterBindings->setValue(shape.parameterIndex, value);
+}
+
+void MainComponent::endControlDrag()
+{
+    if (!draggedControlId.isValid())
+        return;
+    
+    if (parameterBindings != nullptr && shapes.contains(draggedControlId))
+        parameterBindings->endGesture(shapes.getReference(draggedControlId).parameterIndex);
+    
+    draggedControlId = {};
+}
+
+void MainComponent::repaintControls(juce::uint32 changedParameters)
+{
+    if (changedParameters == 0)
+        return;
+    
+    // Only the bound shapes are repainted, not the whole canvas
+    const auto viewTransform = getViewTransform();
+    
+    for (int parameterIndex = 0; parameterIndex < ParameterBindings::numParameters; ++parameterIndex)
+    {
+        if ((changedParameters & (1u << parameterIndex)) == 0)
+            continue;
+        
+        auto& ids = controlIdsByParameter[(size_t) parameterIndex];
+        
+        ids.removeIf([this, parameterIndex](ShapeId id)
+        {
+            return !shapes.contains(id) || !isBoundToParameter(shapes.getReference(id), parameterIndex);
+        });
+        
+        for (auto id : ids)
+            repaint(getShapeDrawnBounds(shapes.getReference(id)).transformedBy(viewTransform).getSmallestIntegerContainer().expanded(2));
+    }
+}
+
+void MainComponent::drawControlValues(juce::Graphics& g)
+{
+    if (parameterBindings == nullptr)
+        return;
+    
+    const auto clip = g.getClipBounds().toFloat();
+    
+    for (int parameterIndex = 0; parameterIndex < ParameterBindings::numParameters; ++parameterIndex)
+    {
+        const float value = parameterBindings->getValue(parameterIndex);
+        
+        // Stale entries are pruned by repaintControls, skipped here
+        for (auto id : controlIdsByParameter[(size_t) parameterIndex])
+        {
+            if (!shapes.contains(id))
+                continue;
+            
+            const auto& shape = shapes.getReference(id);
+            
+            if (!isBoundToParameter(shape, parameterIndex) || !getShapeDrawnBounds(shape).intersects(clip))
+                continue;
+            
+            juce::Graphics::ScopedSaveState stateSave(g);
+            FrameArena::ScopedPath scratchPath(frameArena);
+            g.addTransform(juce::AffineTransform::rotation(shape.rotation, shape.rotationCenter.x, shape.rotationCenter.y));
+            filmstripCache->drawControl(g, shape, value, scratchPath);
+        }
+    }
+}
+
+void MainComponent::exportSelectedFilmstrip()
+{
+    auto* shape = getSelectedShape();
+    
+    // Exported for sliders too, even though the canvas draws those directly
+    if (shape == nullptr || (shape->control != ControlType::Knob && shape->control != ControlType::Slider))
+        return;
+    
+    auto image = filmstripCache->renderAsset(*shape, filmstripAssetScale, symbolLibrary.get());
+    
+    auto file = juce::File::getSpecialLocation(juce::File::userDesktopDirectory)
+                    .getNonexistentChildFile(juce::String(shape->control == ControlType::Knob ? "knob" : "slider")
+                                                 + "-filmstrip-" + juce::String(FilmstripCache::numFrames), ".png");
+    
+    juce::FileOutputStream stream(file);
+    juce::PNGImageFormat png;
+    
+    if (stream.openedOk() && png.writeImageToStream(image, stream))
+        file.revealToUser();
+    else
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Filmstrip export",
+                                               "Couldn't write " + file.getFullPathName());
+}
+
+void MainComponent::startTextEditing(juce::Point<float> position, ShapeId existingShapeId)
+{
+    const Shape* existingShape = shapes.contains(existingShapeId) ? &shapes.getReference(existingShapeId) : nullptr;
+    
+    // The text being edited is drawn by the editor, not as part of the frame
+    cachedFrame = {};
+    isEditingText = true;
+    isEditingExistingText = (existingShape != nullptr);
+    
+    if (existingShape)
+    {
+        editingShapeId = existingShapeId;
+        
+        // The shape is hidden while the editor is showing
+        markShapeDirty(*existingShape);
+    }
+    
+    // Create and set up text editor
+    textEditor = std::make_unique<juce::TextEditor>("textEntry");
+    textEditor->setMultiLine(true, false);
+    textEditor->setReturnKeyStartsNewLine(false);
+    textEditor->setScrollbarsShown(false);
+    
+    // Set up font and style
+    juce::Font editorFont;
+    if (existingShape)
+    {
+        editorFont = existingShape->getFont();
+        textEditor->setColour(juce::TextEditor::textColourId, existingShape->style->fillColour);
+    }
+    else
+    {
+        editorFont = FontCache::getInstance()->getFont(currentStyle.fontFamily, currentStyle.fontSize);
+        textEditor->setColour(juce::TextEditor::textColourId, currentStyle.fillColour);
+    }
+    textEditor->setFont(editorFont);
+    
+    // Remove ALL possible sources of offset
+    textEditor->setBorder(juce::BorderSize<int>(0));
+    textEditor->setIndents(0, 0);
+    textEditor->setJustification(juce::Justification::topLeft);
+    textEditor->setLineSpacing(1.0f);
+    
+    // Make it transparent
+    textEditor->setColour(juce::TextEditor::backgroundColourId, juce::Colours::transparentWhite);
+    textEditor->setColour(juce::TextEditor::outlineColourId, juce::Colours::transparentWhite);
+    textEditor->setColour(juce::TextEditor::focusedOutlineColourId, juce::Colours::transparentWhite);
+    textEditor->setColour(juce::TextEditor::highlightColourId, juce::Colours::lightblue.withAlpha(0.3f));
+    
+    // Set position and initial size
+    if (existingShape)
+    {
+        auto bounds = existingShape->bounds;
+        textEditor->setBounds(bounds.toType<int>());
+        textEditor->setText(existingShape->text, false);
+        textEditor->selectAll();
+    }
+    else
+    {
+        // Initial size for new text
+        const float initialWidth = 200.0f;
+        currentEditorHeight = editorFont.getHeight();
+        textEditor->setBounds(position.x, position.y, initialWidth, currentEditorHeight);
+    }
+    
+    // The editor keeps document coordinates for its bounds, the view and any
+    // rotation of the text are applied as a component transform
+    updateTextEditorTransform();
+    
+    addAndMakeVisible(textEditor.get());
+    textEditor->grabKeyboardFocus();
+    
+    // Add text change listener to handle auto-resize
+    textEditor->onTextChange = [this]()
+    {
+        updateTextEditorSize();
+    };
+    
+    textEditor->onReturnKey = [this]()
+    {
+        finishTextEditing();
+    };
+    
+    textEditor->onFocusLost = [this]()
+    {
+        finishTextEditing();
+    };
+}
+
+void MainComponent::updateTextEditorSize()
+{
+    UIDESIGNER_TRACE_SCOPE("updateTextEditorSize");
+    
+    if (!textEditor)
+        return;
+    
+    // Store current transform before resizing
+    auto currentTransform = textEditor->getTransform();
+    
+    // Get current bounds to maintain position
+    auto bounds = textEditor->getBounds();
+    
+    // Calculate width based on actual text content using the font
+    juce::String currentText = textEditor->getText();
+    float textWidth = textEditor->getFont().getStringWidthFloat(currentText);
+    float newWidth;
+    
+    if (isEditingExistingText)
+    {
+        newWidth = textWidth + 10.0f;
+    }
+    else
+    {
+        newWidth = std::max(200.0f, textWidth + 10.0f);
+    }
+    
+    float textHeight = textEditor->getTextHeight();
+    
+    // Update editor bounds while maintaining position
+    textEditor->setBounds(bounds.getX(), bounds.getY(),
+                         newWidth, textHeight);
+    
+    // Reapply the transform after resizing
+    textEditor->setTransform(currentTransform);
+    
+    currentEditorHeight = textHeight;
+
+    // Update shape bounds if editing existing
+    if (isEditingExistingText && shapes.contains(editingShapeId))
+    {
+        auto& shape = shapes.getReference(editingShapeId);
+        
+        // Store rotation info
+        float rotation = shape.rotation;
+        juce::Point<float> rotationCenter = shape.rotationCenter;
+        
+        // Update bounds to match new text size
+        shape.bounds.setSize(newWidth, textHeight);
+        
+        // Maintain rotation
+        shape.rotation = rotation;
+        shape.rotationCenter = rotationCenter;
+        
+        // Update selection handles to match new bounds
+        updateSelectionHandles();
+    }
+    
+    repaint();
+}
+
+void MainComponent::updateTextEditorTransform()
+{
+    if (textEditor == nullptr)
+        return;
+    
+    auto transform = getViewTransform();
+    
+    if (isEditingExistingText && shapes.contains(editingShapeId))
+    {
+        const auto& shape = shapes.getReference(editingShapeId);
+        transform = juce::AffineTransform::rotation(shape.rotation,
+                                                    shape.rotationCenter.x,
+                                                    shape.rotationCenter.y).followedBy(transform);
+    }
+    
+    textEditor->setTransform(transform);
+}
+
+void MainComponent::finishTextEditing()
+{
+    if (!isEditingText || textEditor == nullptr)
+        return;
+        
+    juce::String newText = textEditor->getText();
+    if (newText.isNotEmpty())
+    {
+        if (isEditingExistingText && shapes.contains(editingShapeId))
+        {
+            // Update existing shape
+            auto& existingShape = shapes.getReference(editingShapeId);
+            
+            // Store rotation info
+            float rotation = existingShape.rotation;
+            juce::Point<float> rotationCenter = existingShape.rotationCenter;
+            
+            // Update text and recalculate bounds
+            existingShape.text = newText;
+            const auto font = existingShape.getFont();
+            float width = font.getStringWidthFloat(newText);
+            float height = font.getHeight();
+            
+            existingShape.bounds.setSize(width, height);
+            
+            // Restore rotation
+            existingShape.rotation = rotation;
+            existingShape.rotationCenter = rotationCenter;
+            
+            updateSelectionHandles();
+        }
+        else
+        {
+            // Create new shape (existing code for new text creation)
+            Shape textShape;
+            textShape.type = Tool::Text;
+            textShape.text = newText;
+            textShape.style = currentStyle;
+            
+            const auto font = textShape.getFont();
+            auto width = font.getStringWidthFloat(newText);
+            float ascent = font.getAscent();
+            float descent = font.getDescent();
+            float height = ascent + descent;
+            
+            auto editorBounds = textEditor->getBounds().toFloat();
+            textShape.bounds = juce::Rectangle<float>(
+                editorBounds.getX(),
+                editorBounds.getY(),
+                width,
+                height);
+                
+            textShape.initializeRotationCenter();
+            const auto id = shapes.add(textShape);
+            drawOrder.addShape(id);
+            markShapeDirty(shapes.getReference(id));
+        }
+    }
+    
+    // The edited shape shows up again, with its final bounds
+    if (shapes.contains(editingShapeId))
+        markShapeDirty(shapes.getReference(editingShapeId));
+    
+    removeChildComponent(textEditor.get());
+    textEditor = nullptr;
+    isEditingText = false;
+    isEditingExistingText = false;  // Reset the flag
+    editingShapeId = {};
+    repaint();
+}
+
+void MainComponent::updateToolPanelFromShape(const Shape* shape)
+{
+    if (toolWindow != nullptr)
+    {
+        auto& toolPanel = toolWindow->getToolPanel();
+        toolPanel.updateFromShape(shape);
+    }
+}
+
+void MainComponent::drawDimensionLabel(juce::Graphics& g, const Shape& shape)
+{
+    // Don't show dimensions for lines
+    if (shape.type == Tool::Line)
+        return;
+
+    if (!hasDimensionLabelGlyphs)
+        findDimensionLabelGlyphs();
+    
+    // "<width> × <height>", as indices into dimensionLabelGlyphs
+    int width = static_cast<int>(std::abs(shape.bounds.getWidth()));
+    int height = static_cast<int>(std::abs(shape.bounds.getHeight()));
+    
+    constexpr int spaceIndex = 10;
+    constexpr int timesIndex = 11;
+    std::array<int, 32> label;
+    int labelLength = 0;
+    
+    auto appendNumber = [&](int number)
+    {
+        std::array<int, 10> digits;
+        int numDigits = 0;
+        
+        do
+        {
+            digits[(size_t) numDigits++] = number % 10;
+            number /= 10;
+        }
+        while (number > 0);
+        
+        while (numDigits > 0)
+            label[(size_t) labelLength++] = digits[(size_t) --numDigits];
+    };
+    
+    appendNumber(width);
+    label[(size_t) labelLength++] = spaceIndex;
+    label[(size_t) labelLength++] = timesIndex;
+    label[(size_t) labelLength++] = spaceIndex;
+    appendNumber(height);
+    
+    float labelWidth = 0.0f;
+    
+    for (int i = 0; i < labelLength; ++i)
+        labelWidth += dimensionLabelAdvances[(size_t) label[(size_t) i]];
+
+    // Position text below the shape, in component coordinates
+    const auto viewTransform = getViewTransform();
+    auto shapeBounds = shape.bounds.transformedBy(viewTransform);
+    auto rotationCenter = shape.rotationCenter.transformedBy(viewTransform);
+    float centreX = shapeBounds.getCentreX();
+    float textY = shapeBounds.getBottom() + 15.0f;
+
+    // Draw with a light background for better visibility
+    float textWidth = labelWidth * 1.3f;
+    float textHeight = dimensionLabelFont.getHeight() * 1.3f;
+    juce::Rectangle<float> textBounds(centreX - textWidth / 2, textY, textWidth, textHeight);
+    
+    // Save the current graphics state before rotation
+    juce::Graphics::ScopedSaveState stateSave(g);
+    
+    // Calculate the adjusted rotation angle to keep text readable
+    float adjustedRotation = shape.rotation;
+    
+    // Normalize the rotation angle to be between -180 and 180 degrees
+    while (adjustedRotation > juce::MathConstants<float>::pi)
+        adjustedRotation -= 2.0f * juce::MathConstants<float>::pi;
+    while (adjustedRotation < -juce::MathConstants<float>::pi)
+        adjustedRotation += 2.0f * juce::MathConstants<float>::pi;
+    
+    bool flipText = false;
+    // If rotation is beyond ±90 degrees, flip the text by 180 degrees
+    if (adjustedRotation > juce::MathConstants<float>::halfPi ||
+        adjustedRotation < -juce::MathConstants<float>::halfPi)
+    {
+        flipText = true;
+    }
+    
+    // Apply the same rotation as the shape
+    if (shape.rotation != 0.0f)
+    {
+        g.addTransform(juce::AffineTransform::rotation(
+            shape.rotation,
+            rotationCenter.x,
+            rotationCenter.y));
+    }
+    
+    //Check if we need to flip the text, to make sure its not upside-down.
+    if (flipText)
+    {
+        g.addTransform(juce::AffineTransform::rotation(
+           juce::MathConstants<float>::pi,
+           textBounds.getCentreX(),
+           textBounds.getCentreY()));
+    }
+    
+    g.setColour(juce::Colours::blue);
+    g.fillRect(textBounds);
+    
+    // Centred the way drawText() would, glyph by glyph
+    g.setColour(juce::Colours::white);
+    g.setFont(dimensionLabelFont);
+    
+    auto& context = g.getInternalContext();
+    float x = textBounds.getCentreX() - labelWidth * 0.5f;
+    const float baseline = textBounds.getCentreY() - dimensionLabelFont.getHeight() * 0.5f + dimensionLabelFont.getAscent();
+    
+    for (int i = 0; i < labelLength; ++i)
+    {
+        const auto index = (size_t) label[(size_t) i];
+        context.drawGlyph(dimensionLabelGlyphs[index], juce::AffineTransform::translation(x, baseline));
+        x += dimensionLabelAdvances[index];
+    }
+}
+
+void MainComponent::findDimensionLabelGlyphs()
+{
+    // The digits, then space and multiplication sign, see drawDimensionLabel()
+    const auto characters = juce::String("0123456789 ") + juce::String(juce::CharPointer_UTF8("\xc3\x97"));
+    jassert(characters.length() == numDimensionLabelChars);
+    
+    for (int i = 0; i < numDimensionLabelChars; ++i)
+    {
+        juce::Array<int> glyphs;
+        juce::Array<float> offsets;
+        dimensionLabelFont.getGlyphPositions(juce::String::charToString(characters[i]), glyphs, offsets);
+        
+        dimensionLabelGlyphs[(size_t) i] = glyphs.isEmpty() ? 0 : glyphs.getFirst();
+        dimensionLabelAdvances[(size_t) i] = offsets.size() > 1 ? offsets[1] - offsets[0] : 0.0f;
+    }
+    
+    hasDimensionLabelGlyphs = true;
+}
+
+void MainComponent::showTools()
+{
+    auto& window = getToolWindow();
+    window.setVisible(true);
+    window.toFront(true);
+}
+
+ToolWindow& MainComponent::getToolWindow()
+{
+    if (toolWindow == nullptr)
+    {
+        UIDESIGNER_TRACE_SCOPE("createToolWindow");
+        
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        toolWindow = std::make_unique<ToolWindow>(*this);
+        
+        if (auto* shape = getSelectedShape())
+            toolWindow->getToolPanel().updateFromShape(shape);
+        
+        const auto toolWindowMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+        performanceOverlay.setStartupTimes(editorOpenMs, toolWindowMs);
+    }
+    
+    return *toolWindow;
+}
+
+void MainComponent::firstFramePainted()
+{
+    hasPaintedFirstFrame = true;
+    
+    if (openStartTicks != 0)
+    {
+        editorOpenMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - openStartTicks) * 1000.0;
+        performanceOverlay.setStartupTimes(editorOpenMs, -1.0);
+    }
+    
+    // The tool window is built once the first frame has been handed over
+    juce::MessageManager::callAsync([safeThis = juce::Component::SafePointer<MainComponent>(this)]
+    {
+        if (safeThis != nullptr)
+            safeThis->getToolWindow();
+    });
+}
+
+void MainComponent::prepareRotation(const juce::MouseEvent& e, MainComponent::Shape& shape)
+{
+    // Get the corners of the bounding rectangle
+    auto topLeft = shape.bounds.getTopLeft();
+    auto topRight = shape.bounds.getTopRight();
+    auto bottomLeft = shape.bounds.getBottomLeft();
+    auto bottomRight = shape.bounds.getBottomRight();
+    
+    // Rotate all corners around the current rotation center using the current rotation
+    auto rotatePoint = [&shape](juce::Point<float> point) {
+        return SelectionHandle::rotatePointAround(point, shape.rotationCenter, shape.rotation);
+    };
+    
+    auto rotatedTopLeft = rotatePoint(topLeft);
+    auto rotatedTopRight = rotatePoint(topRight);
+    auto rotatedBottomLeft = rotatePoint(bottomLeft);
+    auto rotatedBottomRight = rotatePoint(bottomRight);
+    
+    juce::Point<float> tempCenter = {
+        (rotatedTopLeft.x + rotatedTopRight.x + rotatedBottomLeft.x + rotatedBottomRight.x) / 4.0f,
+        (rotatedTopLeft.y + rotatedTopRight.y + rotatedBottomLeft.y + rotatedBottomRight.y) / 4.0f
+    };
+    
+    auto rotatePointReverse = [&shape, tempCenter](juce::Point<float> point) {
+        return SelectionHandle::rotatePointAround(point, tempCenter, -shape.rotation);
+    };
+    
+    rotatedTopLeft = rotatePointReverse(rotatedTopLeft);
+    rotatedTopRight = rotatePointReverse(rotatedTopRight);
+    rotatedBottomLeft = rotatePointReverse(rotatedBottomLeft);
+    rotatedBottomRight = rotatePointReverse(rotatedBottomRight);
+    
+    //Create new bounds from the back-rotated rectangle:
+    shape.bounds = juce::Rectangle<float>(rotatedTopLeft, rotatedBottomRight);
+    
+    // Calculate the center of the back-rotated rectangle
+    shape.rotationCenter = {
+        (rotatedTopLeft.x + rotatedTopRight.x + rotatedBottomLeft.x + rotatedBottomRight.x) / 4.0f,
+        (rotatedTopLeft.y + rotatedTopRight.y + rotatedBottomLeft.y + rotatedBottomRight.y) / 4.0f
+    };
+    
+    // Store initial angle for rotation
+    auto position = viewToDocument(e.position);
+    initialAngle = std::atan2(position.y - shape.rotationCenter.y,
+                             position.x - shape.rotationCenter.x);
+    initialRotation = shape.rotation;
+}
+
+
+void MainComponent::updateSelectionHandles()
+{
+    // clearQuick() keeps the storage reserved in the constructor, so
+    // refreshing the handles during a drag never touches the heap
+    if (shapes.contains(selectedShapeId))
+    {
+        selectionHandles.clearQuick();
+        const auto& shape = shapes.getReference(selectedShapeId);
+        
+        // Handles are kept in component coordinates so that they keep their
+        // size at any zoom level. The view only scales and translates, so the
+        // rotation angle carries over unchanged.
+        const auto viewTransform = getViewTransform();
+        const auto bounds = shape.bounds.transformedBy(viewTransform);
+        const auto rotationCenter = shape.rotationCenter.transformedBy(viewTransform);
+        const auto lineStart = shape.lineStart.transformedBy(viewTransform);
+        const auto lineEnd = shape.lineEnd.transformedBy(viewTransform);
+
+        if (shape.type == Tool::Line)
+        {
+            // For lines, only show handles at the endpoints
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::TopLeft));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::BottomRight));
+            
+            // Update handle positions for line endpoints
+            for (auto& handle : selectionHandles)
+            {
+                if (handle.getType() == SelectionHandle::Type::TopLeft)
+                {
+                    handle.updatePosition(juce::Rectangle<float>(lineStart.x - 4,
+                                                               lineStart.y - 4,
+                                                               8, 8),
+                                        shape.rotation,
+                                        rotationCenter);
+                }
+                else // BottomRight
+                {
+                    handle.updatePosition(juce::Rectangle<float>(lineEnd.x - 4,
+                                                               lineEnd.y - 4,
+                                                               8, 8),
+                                        shape.rotation,
+                                        rotationCenter);
+                }
+            }
+        }
+        else
+        {
+            // Add resize handles
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::TopLeft));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Top));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::TopRight));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Right));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::BottomRight));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Bottom));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::BottomLeft));
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Left));
+             
+            // Add rotation handle
+            selectionHandles.add(SelectionHandle(SelectionHandle::Type::Rotate));
+
+            // Update handle positions
+            for (auto& handle : selectionHandles)
+                handle.updatePosition(bounds, shape.rotation, rotationCenter);
+        }
+    }
+    else
+    {
+        selectionHandles.clearQuick();
+    }
+    
+    repaint();
+}
+
+//==================================================================
+
+ColorPickerWindow::ColorPickerWindow(const juce::String& name,
+                                     juce::Colour initialColor,
+                                    std::function<void(juce::Colour)> colorCallback)
+    : DocumentWindow(name, juce::Colours::lightgrey,
+                    DocumentWindow::closeButton | DocumentWindow::minimiseButton)
+{
+    colorSelector = std::make_unique<juce::ColourSelector>(
+        juce::ColourSelector::showColourspace |
+        juce::ColourSelector::showAlphaChannel |
+        juce::ColourSelector::showColourAtTop |
+        juce::ColourSelector::editableColour);
+    colorSelector->setCurrentColour(initialColor);
+    colorSelector->setSize(300, 400);
+    
+    colorSelector->addChangeListener(this);
+    this->colorCallback = std::move(colorCallback);
+    
+    setContentNonOwned(colorSelector.get(), true);
+    setUsingNativeTitleBar(true);
+    setResizable(true, false);
+    setAlwaysOnTop(true);
+    
+    centreWithSize(getWidth(), getHeight());
+    setVisible(true);
+    toFront(true);
+}
+
+void ColorPickerWindow::closeButtonPressed()
+{
+    setVisible(false);
+}
+
+void ColorPickerWindow::changeListenerCallback(juce::ChangeBroadcaster*)
+{
+    if (colorCallback)
+        colorCallback(colorSelector->getCurrentColour());
+}
+
+
+//-----------------------------------
+
+ToolPanel::ToolPanel(MainComponent& mainComponent) : owner(mainComponent)
+{
+ 
+    auto setupButton = [this](juce::TextButton& b, const juce::String& text)
+    {
+        b.setButtonText(text);
+        b.setColour(juce::TextButton::textColourOnId, juce::Colours::black);
+        b.setColour(juce::TextButton::textColourOffId, juce::Colours::black);
+        b.setColour(juce::TextButton::buttonColourId, juce::Colours::white);
+        b.setColour(juce::TextButton::buttonOnColourId, juce::Colours::grey);
+        addAndMakeVisible(b);
+
+    };
+    
+    auto setupShapeButton = [this, setupButton](juce::TextButton& b, const juce::String& text)
+    {
+        setupButton(b, text);
+        b.setClickingTogglesState(true);
+        b.setRadioGroupId(2);
+    };
+    
+    setupShapeButton(selectButton, "Select");
+    setupShapeButton(rectangleButton, "Rectangle");
+    setupShapeButton(ellipseButton, "Ellipse");
+    setupShapeButton(lineButton, "Line");
+    setupShapeButton(penButton, "Pen");
+    
+    selectButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Select);
+    };
+    rectangleButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Rectangle);
+    };
+    ellipseButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Ellipse);
+    };
+    lineButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Line);
+    };
+    penButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Freehand);
+    };
+
+    auto addLabel = [this](juce::Label& label, const juce::String& text)
+    {
+        label.setText(text, juce::dontSendNotification);
+        label.setColour(juce::Label::textColourId, juce::Colours::black);
+        addAndMakeVisible(label);
+    };
+    
+    strokeWidthSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
+    addAndMakeVisible(strokeWidthSlider);
+    cornerRadiusSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
+    addAndMakeVisible(cornerRadiusSlider);
+
+
+    fillToggle.setColour(juce::ToggleButton::textColourId, juce::Colours::black);
+    fillToggle.setColour(juce::ToggleButton::tickColourId, juce::Colours::black);
+    fillToggle.setColour(juce::ToggleButton::tickDisabledColourId, juce::Colours::black);
+    addAndMakeVisible(fillToggle);
+
+    
+    addAndMakeVisible(solidStrokeButton);
+    addAndMakeVisible(dashedStrokeButton);
+    addAndMakeVisible(dottedStrokeButton);
+    addAndMakeVisible(dashDotStrokeButton);
+    
+    setupButton(fillColorButton, "Fill Color");
+    setupButton(strokeColorButton, "Stroke Color");
+    
+    // Set up slider listeners
+    strokeWidthSlider.onValueChange = [this]
+    {
+        if (!updatingFromShape)
+            owner.queueSelectedShapeStrokeWidth((float)strokeWidthSlider.getValue());
+    };
+
+    cornerRadiusSlider.onValueChange = [this]
+    {
+        if (!updatingFromShape)
+            owner.queueSelectedShapeCornerRadius((float)cornerRadiusSlider.getValue());
+    };
+    
+    // stroke pattern button callbacks:
+    solidStrokeButton.onClick = [this]
+    {
+        if (!updatingFromShape)
+            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::Solid);
+    };
+
+    dashedStrokeButton.onClick = [this]
+    {
+        if (!updatingFromShape)
+            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::Dashed);
+    };
+
+    dottedStrokeButton.onClick = [this]
+    {
+        if (!updatingFromShape)
+            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::Dotted);
+    };
+
+    dashDotStrokeButton.onClick = [this]
+    {
+        if (!updatingFromShape)
+            owner.updateSelectedShapeStrokePattern(MainComponent::StrokePattern::DashDot);
+    };
+
+
+    // Set up slider properties
+    strokeWidthSlider.setRange(0.0, 20.0, 1.0);
+    strokeWidthSlider.setValue(0.0);
+    //strokeWidthSlider.addListener(&owner);
+    
+    cornerRadiusSlider.setRange(0.0, 50.0, 1.0);
+    cornerRadiusSlider.setValue(0.0);
+    //cornerRadiusSlider.addListener(&owner);
+    
+    // Labels
+    addLabel(strokeWidthLabel, "Stroke Width");
+    strokeWidthLabel.attachToComponent(&strokeWidthSlider, true);
+
+    addLabel(cornerRadiusLabel, "Corner Radius");
+    cornerRadiusLabel.attachToComponent(&cornerRadiusSlider, true);
+    
+    addLabel(fillColorLabel, "Fill Color");
+    addLabel(strokeColorLabel, "Stroke Color");
+    
+    // Color buttons
+    fillColorButton.onClick = [this]
+    {
+        showColorPicker(true);
+    };
+    strokeColorButton.onClick = [this]
+    {
+        showColorPicker(false);
+    };
+    
+    // Fill toggle
+    fillToggle.setButtonText("Enable Fill");
+    fillToggle.setToggleState(true, juce::dontSendNotification);
+    fillToggle.onClick = [this]
+    {
+        if (!updatingFromShape)
+            owner.updateSelectedShapeFill(fillToggle.getToggleState());
+    };
+
+    // Stroke pattern buttons setup
+    solidStrokeButton.setRadioGroupId(1);
+    solidStrokeButton.setClickingTogglesState(true);
+    dashedStrokeButton.setRadioGroupId(1);
+    dashedStrokeButton.setClickingTogglesState(true);
+    dottedStrokeButton.setRadioGroupId(1);
+    dottedStrokeButton.setClickingTogglesState(true);
+    dashDotStrokeButton.setRadioGroupId(1);
+    dashDotStrokeButton.setClickingTogglesState(true);
+
+    solidStrokeButton.setToggleState(true, juce::dontSendNotification);
+    
+    addLabel(widthLabel, "Width");
+    addLabel(heightLabel, "Height");
+    addAndMakeVisible(widthEditor);
+    addAndMakeVisible(heightEditor);
+
+    widthEditor.setInputRestrictions(6, "0123456789");
+    heightEditor.setInputRestrictions(6, "0123456789");
+
+    widthEditor.onReturnKey = [this]()
+    {
+        if (auto* shape = owner.getSelectedShape())
+        {
+            auto bounds = shape->bounds;
+            bounds.setWidth(widthEditor.getText().getFloatValue());
+            owner.updateSelectedShapeBounds(bounds);
+        }
+    };
+
+    heightEditor.onReturnKey = [this]()
+    {
+        if (auto* shape = owner.getSelectedShape())
+        {
+            auto bounds = shape->bounds;
+            bounds.setHeight(heightEditor.getText().getFloatValue());
+            owner.updateSelectedShapeBounds(bounds);
+        }
+    };
+    
+    setupShapeButton(textButton, "Text");
+    textButton.onClick = [this]
+    {
+        // Set default black color for text
+        owner.setFillColour(juce::Colours::black);
+        owner.setCurrentTool(MainComponent::Tool::Text);
+        
+        // Update the fill color button to show black
+        fillColorButton.setColour(juce::TextButton::buttonColourId, juce::Colours::black);
+    };
+    
+    setupShapeButton(meterButton, "Meter");
+    setupShapeButton(scopeButton, "Scope");
+    setupShapeButton(spectrumButton, "Spectrum");
+    
+    meterButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Meter);
+    };
+    scopeButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Scope);
+    };
+    spectrumButton.onClick = [this]
+    {
+        owner.setCurrentTool(MainComponent::Tool::Spectrum);
+    };
+    
+    // Not a drawing tool, the images are placed at their own size
+    setupButton(imageButton, "Image...");
+    imageButton.onClick = [this]
+    {
+        imageChooser = std::make_unique<juce::FileChooser>("Import Images", juce::File(), "*.png;*.jpg;*.jpeg;*.gif");
+        
+        auto flags = juce::FileBrowserComponent::openMode
+                   | juce::FileBrowserComponent::canSelectFiles
+                   | juce::FileBrowserComponent::canSelectMultipleItems;
+        
+        imageChooser->launchAsync(flags, [this](const juce::FileChooser& chooser)
+        {
+            juce::StringArray files;
+            
+            for (auto& file : chooser.getResults())
+                files.add(file.getFullPathName());
+            
+            owner.importImages(files);
+        });
+    };
+    
+    // Add text controls
+    fontSizeSlider.setRange(8.0, 72.0, 1.0);
+    fontSizeSlider.setValue(14.0);
+    fontSizeSlider.setColour(juce::Slider::textBoxTextColourId, juce::Colours::black);
+    fontSizeSlider.onValueChange = [this]
+    {
+        if (!updatingFromShape)
+            owner.queueSelectedShapeFontSize((float)fontSizeSlider.getValue());
+    };
+    addAndMakeVisible(fontSizeSlider);
+    addLabel(fontSizeLabel, "Font Size");
+    
+}
+
+ToolPanel::~ToolPanel()
+{
+    // Make sure we clean up any open color picker windows
+    deleteColorPickers();
+}
+
+void ToolPanel::resized()
+{
+    // Move the layout code from MainComponent::resized() to here
+    auto padding = 10;
+    auto buttonWidth = 100;
+    auto buttonHeight = 30;
+    auto colorButtonWidth = 60;
+    auto strokePatternWidth = 40;
+    auto y = padding;
+    
+    // Tool buttons
+    selectButton.setBounds(padding, y, buttonWidth, buttonHeight);
+    rectangleButton.setBounds(padding, y + buttonHeight + padding, buttonWidth, buttonHeight);
+    ellipseButton.setBounds(padding, y + (buttonHeight + padding) * 2, buttonWidth, buttonHeight);
+    lineButton.setBounds(padding, y + (buttonHeight + padding) * 3, buttonWidth, buttonHeight);
+    penButton.setBounds(padding, y + (buttonHeight + padding) * 4, buttonWidth, buttonHeight);
+    textButton.setBounds(padding, y + (buttonHeight + padding) * 5, buttonWidth, buttonHeight);
+    
+    // Audio displays and image import in a second column
+    auto x = padding * 2 + buttonWidth;
+    meterButton.setBounds(x, y, buttonWidth, buttonHeight);
+    scopeButton.setBounds(x, y + buttonHeight + padding, buttonWidth, buttonHeight);
+    spectrumButton.setBounds(x, y + (buttonHeight + padding) * 2, buttonWidth, buttonHeight);
+    imageButton.setBounds(x, y + (buttonHeight + padding) * 4, buttonWidth, buttonHeight);
+    
+    y = y + (buttonHeight + padding) * 6;
+    
+    // Style controls
+    auto labelWidth = 80;
+    strokeWidthSlider.setBounds(padding + labelWidth, y, 200, buttonHeight);
+    
+    y += buttonHeight + padding;
+    cornerRadiusSlider.setBounds(padding + labelWidth, y, 200, buttonHeight);
+    
+    y += buttonHeight + padding;
+    fillColorButton.setBounds(padding + labelWidth, y, colorButtonWidth, buttonHeight);
+    fillColorLabel.setBounds(padding, y, labelWidth, buttonHeight);
+    fillToggle.setBounds(padding + labelWidth + colorButtonWidth + padding, y, buttonWidth, buttonHeight);
+    
+    y += buttonHeight + padding;
+    strokeColorButton.setBounds(padding + labelWidth, y, colorButtonWidth, buttonHeight);
+    strokeColorLabel.setBounds(padding, y, labelWidth, buttonHeight);
+    
+    y += buttonHeight + padding;
+    solidStrokeButton.setBounds(padding, y, strokePatternWidth, buttonHeight);
+    dashedStrokeButton.setBounds(padding * 2 + strokePatternWidth, y, strokePatternWidth, buttonHeight);
+    dottedStrokeButton.setBounds(padding * 3 + strokePatternWidth * 2, y, strokePatternWidth, buttonHeight);
+    dashDotStrokeButton.setBounds(padding * 4 + strokePatternWidth * 3, y, strokePatternWidth, buttonHeight);
+    
+    y += buttonHeight + padding;
+    // Add font size control
+    fontSizeLabel.setBounds(padding, y, labelWidth, buttonHeight);
+    fontSizeSlider.setBounds(padding + labelWidth, y, 200, buttonHeight);
+    
+    y += buttonHeight + padding;
+    widthLabel.setBounds(padding, y, labelWidth, buttonHeight);
+    widthEditor.setBounds(padding + labelWidth, y, 60, buttonHeight);
+    
+    y += buttonHeight + padding;
+    heightLabel.setBounds(padding, y, labelWidth, buttonHeight);
+    heightEditor.setBounds(padding + labelWidth, y, 60, buttonHeight);
+}
+
+void ToolPanel::updateDimensionEditors(const MainComponent::Shape* shape)
+{
+    if (shape && shape->type != MainComponent::Tool::Line)
+    {
+        auto width = static_cast<int>(std::abs(shape->bounds.getWidth()));
+        auto height = static_cast<int>(std::abs(shape->bounds.getHeight()));
+        
+        if (width != shownWidth)
+            widthEditor.setText(juce::String(width), false);
+        if (height != shownHeight)
+            heightEditor.setText(juce::String(height), false);
+        
+        shownWidth = width;
+        shownHeight = height;
+        widthEditor.setEnabled(true);
+        heightEditor.setEnabled(true);
+    }
+    else
+    {
+        widthEditor.setText("--");
+        heightEditor.setText("--");
+        shownWidth = -1;
+        shownHeight = -1;
+        widthEditor.setEnabled(false);
+        heightEditor.setEnabled(false);
+    }
+}
+
+void ToolPanel::updateFromShape(const MainComponent::Shape* shape)
+{
+    UIDESIGNER_TRACE_SCOPE("ToolPanel::updateFromShape");
+    
+    updatingFromShape = true;
+    
+    if (shape)
+    {
+        // Update all controls to reflect the selected shape's properties
+        fillToggle.setToggleState(shape->style->hasFill, juce::dontSendNotification);
+        strokeWidthSlider.setValue(shape->style->strokeWidth, juce::dontSendNotification);
+        cornerRadiusSlider.setValue(shape->style->cornerRadius, juce::dontSendNotification);
+        
+        fillColorButton.setColour(juce::TextButton::buttonColourId, shape->style->fillColour);
+        strokeColorButton.setColour(juce::TextButton::buttonColourId, shape->style->strokeColour);
+        
+        // Update stroke pattern buttons
+        solidStrokeButton.setToggleState(shape->style->strokePattern == MainComponent::StrokePattern::Solid, juce::dontSendNotification);
+        dashedStrokeButton.setToggleState(shape->style->strokePattern == MainComponent::StrokePattern::Dashed, juce::dontSendNotification);
+        dottedStrokeButton.setToggleState(shape->style->strokePattern == MainComponent::StrokePattern::Dotted, juce::dontSendNotification);
+        dashDotStrokeButton.setToggleState(shape->style->strokePattern == MainComponent::StrokePattern::DashDot, juce::dontSendNotification);
+        
+        // Update dimension editors, forcing a refresh for the new selection
+        shownWidth = -1;
+        shownHeight = -1;
+        updateDimensionEditors(shape);
+        
+        // Update text-specific controls
+        if (shape->type == MainComponent::Tool::Text)
+            fontSizeSlider.setValue(shape->style->fontSize, juce::dontSendNotification);
+    }
+    else
+    {
+        updateDimensionEditors(nullptr);
+    }
+    
+    updatingFromShape = false;
+}
+
+void ToolPanel::deleteColorPickers()
+{
+    fillColorPicker = nullptr;
+    strokeColorPicker = nullptr;
+}
+
+void ToolPanel::showColorPicker(bool isFillColor)
+{
+    // If there's already a picker of this type, just focus it instead of creating a new one
+    if (isFillColor && fillColorPicker != nullptr)
+    {
+        fillColorPicker->setVisible(true);
+        fillColorPicker->toFront(true);
+        return;
+    }
+    else if (!isFillColor && strokeColorPicker != nullptr)
+    {
+        strokeColorPicker->setVisible(true);
+        strokeColorPicker->toFront(true);
+        return;
+    }
+
+    juce::String windowTitle = isFillColor ? "Fill Color" : "Stroke Color";
+    juce::Colour initialColor = isFillColor ?
+        fillColorButton.findColour(juce::TextButton::buttonColourId) :
+        strokeColorButton.findColour(juce::TextButton::buttonColourId);
+        
+    auto& picker = isFillColor ? fillColorPicker : strokeColorPicker;
+    picker = std::make_unique<ColorPickerWindow>(windowTitle, initialColor,
+        [this, isFillColor](juce::Colour newColour)
+        {
+            if (isFillColor)
+            {
+                fillColorButton.setColour(juce::TextButton::buttonColourId, newColour);
+                owner.queueSelectedShapeFillColour(newColour);
+            }
+            else
+            {
+                strokeColorButton.setColour(juce::TextButton::buttonColourId, newColour);
+                owner.queueSelectedShapeStrokeColour(newColour);
+            }
+        });
+
+    // Position the picker window relative to the button
+    auto &button = isFillColor ? fillColorButton : strokeColorButton;
+    auto buttonPos = button.getBounds().getTopRight();
+    auto screenPos = localPointToGlobal(buttonPos);
+    
+    // Offset it slightly so it doesn't cover the button
+    screenPos.addXY(10, 0);
+    
+    picker->setTopLeftPosition(screenPos.x, screenPos.y);
+}
+
+
+//-------------------------------------------
+
+ToolWindow::ToolWindow(MainComponent& mainComponent)
+    : DocumentWindow("Tools", juce::Colours::lightgrey,
+                    DocumentWindow::closeButton | DocumentWindow::minimiseButton)
+{
+    toolPanel = std::make_unique<ToolPanel>(mainComponent);
+    
+    const int width = 600;
+    const int height = 640;
+    
+    // Give the tool panel an initial size before setting it as content
+    toolPanel->setSize(width, height);
+    
+    // Use setContentNonOwned since we're managing ownership with unique_ptr
+    setContentNonOwned(toolPanel.get(), true);
+    
+    setUsingNativeTitleBar(true);
+    setResizable(true, false);
+    centreWithSize(width, height);
+    setVisible(true);
+    //Need to make the process the foreground, otherwise the tooltip window wont show up initially, on Mac at least.
+    juce::Process::makeForegroundProcess();
+    toFront(true);  // Bring window to front when created
+}
+
+void ToolWindow::closeButtonPressed()
+{
+    // Just hide the window when the user clicks the close button
+    setVisible(false);
+}
+
+ToolPanel& ToolWindow::getToolPanel()
+{
+    return *toolPanel;
+}
+
+
+#if JUCE_UNIT_TESTS
+
+// Draws nothing, so that painting into it counts only what the canvas itself
+// allocates. A real renderer allocates edge tables and saved states of its
+// own, which are JUCE's business.
+class DiscardingContext : public juce::LowLevelGraphicsContext
+{
+public:
+    explicit DiscardingContext(juce::Rectangle<int> area) : clip(area) {}
+    
+    bool isVectorDevice() const override { return false; }
+    void setOrigin(juce::Point<int>) override {}
+    void addTransform(const juce::AffineTransform&) override {}
+    float getPhysicalPixelScaleFactor() override { return 1.0f; }
+    
+    bool clipToRectangle(const juce::Rectangle<int>&) override { return true; }
+    bool clipToRectangleList(const juce::RectangleList<int>&) override { return true; }
+    void excludeClipRectangle(const juce::Rectangle<int>&) override {}
+    void clipToPath(const juce::Path&, const juce::AffineTransform&) override {}
+    void clipToImageAlpha(const juce::Image&, const juce::AffineTransform&) override {}
+    bool clipRegionIntersects(const juce::Rectangle<int>& area) override { return clip.intersects(area); }
+    juce::Rectangle<int> getClipBounds() const override { return clip; }
+    bool isClipEmpty() const override { return false; }
+    
+    void saveState() override {}
+    void restoreState() override {}
+    void beginTransparencyLayer(float) override {}
+    void endTransparencyLayer() override {}
+    
+    void setFill(const juce::FillType&) override {}
+    void setOpacity(float) override {}
+    void setInterpolationQuality(juce::Graphics::ResamplingQuality) override {}
+    
+    void fillRect(const juce::Rectangle<int>&, bool) override {}
+    void fillRect(const juce::Rectangle<float>&) override {}
+    void fillRectList(const juce::RectangleList<float>&) override {}
+    void fillPath(const juce::Path&, const juce::AffineTransform&) override {}
+    void drawImage(const juce::Image&, const juce::AffineTransform&) override {}
+    void drawLine(const juce::Line<float>&) override {}
+    
+    void setFont(const juce::Font& newFont) override { font = newFont; }
+    const juce::Font& getFont() override { return font; }
+    void drawGlyph(int, const juce::AffineTransform&) override {}
+    
+private:
+    juce::Rectangle<int> clip;
+    juce::Font font;
+};
+
+// Moves, resizes and rotates a shape in a populated document and checks that
+// neither the drag events nor the frames painted after them touch the heap.
+// The test stands in for the display: after each mouseDrag it runs the vblank
+// callback, which applies the drag, and paints the canvas.
+class DragAllocationTests : public juce::UnitTest
+{
+public:
+    DragAllocationTests() : juce::UnitTest("Drag allocations", "UiDesigner") {}
+    
+    void runTest() override
+    {
+        beginTest("Allocation counting");
+        
+        // A build that can't count would pass without checking anything
+        expect(AllocationCounter::isEnabled(), "Allocations can't be counted in this build, see AllocationCounter.h");
+        
+        if (!AllocationCounter::isEnabled())
+            return;
+        
+        MainComponent canvas;
+        canvas.setSize(800, 600);
+        canvas.setDocument(createGrid());
+        canvas.setCurrentTool(MainComponent::Tool::Select);
+        
+        beginTest("Moving a shape");
+        expectNoAllocations(countDragAllocations(canvas, { 105.0f, 105.0f }));
+        expect(canvas.getSelectedShape() != nullptr);
+        
+        beginTest("Resizing a shape");
+        auto bounds = canvas.getSelectedShape()->bounds.transformedBy(canvas.getViewTransform());
+        expectNoAllocations(countDragAllocations(canvas, bounds.getBottomRight()));
+        
+        beginTest("Rotating a shape");
+        bounds = canvas.getSelectedShape()->bounds.transformedBy(canvas.getViewTransform());
+        expectNoAllocations(countDragAllocations(canvas, { bounds.getCentreX(), bounds.getY() - 20.0f }));
+    }
+    
+private:
+    struct Allocations
+    {
+        juce::uint64 inEvents = 0;  // mouseDrag and the vblank that applies it
+        juce::uint64 inFrames = 0;  // paint
+    };
+    
+    void expectNoAllocations(const Allocations& allocations)
+    {
+        expectEquals(allocations.inEvents, (juce::uint64) 0, "allocations while handling drag events");
+        expectEquals(allocations.inFrames, (juce::uint64) 0, "allocations while painting");
+    }
+    
+    static std::shared_ptr<const DocumentSnapshot> createGrid()
+    {
+        MainComponent::Style style;
+        style.fillColour = juce::Colours::lightgrey;
+        style.strokeColour = juce::Colours::black;
+        style.strokeWidth = 1.0f;
+        style.hasFill = true;
+        
+        juce::Array<MainComponent::Shape> shapes;
+        
+        for (int row = 0; row < 40; ++row)
+        {
+            for (int column = 0; column < 40; ++column)
+            {
+                MainComponent::Shape shape;
+                shape.type = MainComponent::Tool::Rectangle;
+                shape.bounds = { 100.0f + (float) column * 15.0f, 100.0f + (float) row * 15.0f, 10.0f, 10.0f };
+                shape.style = style;
+                shape.initializeRotationCenter();
+                shapes.add(shape);
+            }
+        }
+        
+        return std::make_shared<DocumentSnapshot>(std::move(shapes), SymbolLibrary());
+    }
+    
+    static juce::MouseEvent createMouseEvent(MainComponent& canvas, juce::Point<float> position,
+                                             juce::Point<float> mouseDownPosition, bool wasDragged)
+    {
+        const auto now = juce::Time::getCurrentTime();
+        
+        return { juce::Desktop::getInstance().getMainMouseSource(), position,
+                 juce::ModifierKeys(juce::ModifierKeys::leftButtonModifier),
+                 juce::MouseInputSource::defaultPressure, juce::MouseInputSource::defaultOrientation,
+                 juce::MouseInputSource::defaultRotation, juce::MouseInputSource::defaultTiltX,
+                 juce::MouseInputSource::defaultTiltY, &canvas, &canvas, now, mouseDownPosition, now, 1, wasDragged };
+    }
+    
+    // Presses at start, drags and releases, painting a frame after each drag.
+    // The mouse down and the first frame may set up the drag and aren't counted.
+    static Allocations countDragAllocations(MainComponent& canvas, juce::Point<float> start)
+    {
+        DiscardingContext context(canvas.getLocalBounds());
+        juce::Graphics g(context);
+        Allocations allocations;
+        
+        canvas.mouseDown(createMouseEvent(canvas, start, start, false));
+        
+        auto position = start;
+        
+        for (int i = 0; i <= 50; ++i)
+        {
+            position += { 1.0f, 0.5f };
+            
+            const auto beforeEvent = AllocationCounter::getNumAllocationsOnThisThread();
+            canvas.mouseDrag(createMouseEvent(canvas, position, start, true));
+            canvas.handleVBlank();
+            
+            const auto beforeFrame = AllocationCounter::getNumAllocationsOnThisThread();
+            canvas.paint(g);
+            
+            const auto afterFrame = AllocationCounter::getNumAllocationsOnThisThread();
+            
+            if (i > 0)
+            {
+                allocations.inEvents += beforeFrame - beforeEvent;
+                allocations.inFrames += afterFrame - beforeFrame;
+            }
+        }
+        
+        canvas.mouseUp(createMouseEvent(canvas, position, start, true));
+        
+        return allocations;
+    }
+};
+
+static DragAllocationTests dragAllocationTests;
+
+#endif
@@ -1,316 +1,764 @@
-/*
-  ==============================================================================
-
-    MainComponent.h
-    Created: 11 Nov 2024 10:52:48pm
-    Author:  Martin S
-
-    You may use this code under the terms of the GPL v3 (see
-    www.gnu.org/licenses) or also the licensed attached to this project.
-
-    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
-    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
-    DISCLAIMED.
- 
-  ==============================================================================
-*/
-
-// MainComponent.h
-#pragma once
-#include <JuceHeader.h>
-
-class StrokePatternButton : public juce::Button
-{
-public:
-    StrokePatternButton(const juce::String& name);
-    
-    void paintButton(juce::Graphics& g, bool isMouseOver, bool isButtonDown) override;
-    
-private:
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StrokePatternButton)
-};
-
-class SelectionHandle
-{
-public:
-    enum class Type
-    {
-        TopLeft,
-        Top,
-        TopRight,
-        Right,
-        BottomRight,
-        Bottom,
-        BottomLeft,
-        Left,
-        Rotate    // Handle for rotation
-    };
-
-    SelectionHandle();
-    SelectionHandle(Type type);
-    
-    SelectionHandle(const SelectionHandle& other);
-    SelectionHandle& operator=(const SelectionHandle& other);
-
-    static juce::Point<float> rotatePointAround(juce::Point<float> point,
-                                                juce::Point<float> center,
-                                                float angleInRadians);
-    
-    void updatePosition(const juce::Rectangle<float>& bounds, float rotationAngle, const juce::Point<float>& rotationCenter);
-
-    void paint(juce::Graphics& g);
-
-    bool hitTest(juce::Point<float> point) const;
-
-    Type getType() const { return handleType; }
-    juce::Point<float> getPosition() const { return position; }
-    juce::Rectangle<float> getBounds() const { return handleBounds; }
-
-private:
-    Type handleType;
-    juce::Point<float> position;
-    juce::Rectangle<float> handleBounds;
-    juce::Rectangle<float> bounds_;  // Reference to the shape bounds
-};
-
-//Forward declaration
-class ToolWindow;
-
-class MainComponent : public juce::Component,
-                      public juce::ChangeListener,
-                      public juce::KeyListener
-{
-public:
-    enum class Tool
-    {
-        Rectangle,
-        Ellipse,
-        Line,
-        Text,
-        Select
-    };
-
-    enum class StrokePattern
-    {
-        Solid,
-        Dashed,
-        Dotted,
-        DashDot
-    };
-
-    struct Style
-    {
-        juce::Colour fillColour;
-        juce::Colour strokeColour;
-        float strokeWidth;
-        StrokePattern strokePattern;
-        bool hasFill;
-        float cornerRadius = 0.0f;
-        float fontSize = 14.0f;
-        juce::String fontFamily = "Arial";
-        bool textStretchEnabled = false;
-    };
-
-    struct Shape
-    {
-        Tool type;
-        juce::Rectangle<float> bounds;
-        Style style;
-        float rotation = 0.0f;
-        juce::Point<float> rotationCenter;
-        juce::Point<float> lineStart;
-        juce::Point<float> lineEnd;
-        juce::String text;
-        juce::Font font;
-        bool isEditing = false;  // Track if text is being edited
-        
-        bool hitTest(juce::Point<float> point) const;
-        void initializeRotationCenter();
-        void move(float dx, float dy);
-        void drawText(juce::Graphics& g) const;
-
-    };
-
-    MainComponent();
-    ~MainComponent() {}
-
-    void paint(juce::Graphics& g) override;
-     
-    void resized() override;
-
-    void mouseDown(const juce::MouseEvent& e) override;
-    void mouseDoubleClick(const juce::MouseEvent& e) override;
-    void mouseDrag(const juce::MouseEvent& e) override;
-
-    void mouseUp(const juce::MouseEvent& e) override;
-    
-    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
-    
-    bool keyPressed(const juce::KeyPress& key, Component *originatingComponent) override;
-    bool keyStateChanged (bool isKeyDown, Component *originatingComponent) override;
-    
-    void deselectAllShapes();
-    void setCurrentTool(Tool tool);
-    void setFillEnabled(bool enabled);
-    void setFillColour(juce::Colour colour);
-    void setStrokeColour(juce::Colour colour);
-    void setStrokeWidth(float width);
-    void setCornerRadius(float radius);
-    void setStrokePattern(StrokePattern pattern);
-    
-    void updateSelectedShapeFill(bool enabled);
-    void updateSelectedShapeFillColour(juce::Colour colour);
-    void updateSelectedShapeStrokeColour(juce::Colour colour);
-    void updateSelectedShapeStrokeWidth(float width);
-    void updateSelectedShapeCornerRadius(float radius);
-    void updateSelectedShapeStrokePattern(StrokePattern pattern);
-    void updateSelectedShapeFontSize(float size);
-        
-    const Shape* getSelectedShape() const;
-    void updateSelectedShapeBounds(const juce::Rectangle<float>& newBounds);
-    
-    void startTextEditing(juce::Point<float> position, const Shape* existingShape = nullptr);
-    void finishTextEditing();
-    
-private:
-    
-    void updateTextEditorSize();
-    void updateToolPanelFromShape(const Shape* shape);
-    void drawDimensionLabel(juce::Graphics& g, const Shape& shape);
-    void showTools();
-    void prepareRotation(const juce::MouseEvent& e, Shape& shape);
-    void applyStyle(juce::Graphics& g, const Style& style);
-
-    template<typename PathFunction>
-    void drawStrokedPath(juce::Graphics& g, const Style& style, PathFunction&& pathFunc);
-
-    void updateSelectionHandles();
-    void handleShapeManipulation(const juce::MouseEvent& e);
-    void rotateShape(const juce::MouseEvent& e);
-    void resizeShape(const juce::MouseEvent& e);
-    
-    std::unique_ptr<ToolWindow> toolWindow;
-    juce::TextButton showToolsButton;
-    
-    // State
-    Tool currentTool = Tool::Rectangle;
-    Style currentStyle;
-    bool isDrawing = false;
-    bool currentlyEditingFillColour = false;
-    juce::Point<float> dragStart;
-    juce::Point<float> dragEnd;
-    juce::Array<Shape> shapes;
-    
-    // Selection related members
-    int selectedShapeIndex = -1;
-    juce::Array<SelectionHandle> selectionHandles;
-    bool isDraggingShape = false;
-    bool isDraggingHandle = false;
-    SelectionHandle::Type activeHandle = SelectionHandle::Type::TopLeft;
-    juce::Point<float> lastMousePosition;
-    float initialRotation = 0.0f;
-    float initialAngle = 0.0f;
-    
-    //Text tool related:
-    bool isEditingText = false;
-    bool isEditingExistingText = false;
-    int editingShapeIndex = -1;
-    float currentEditorHeight = 0.0f;
-    std::unique_ptr<juce::TextEditor> textEditor;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
-};
-
-//==================================================================
-
-class ColorPickerWindow : public juce::DocumentWindow, public juce::ChangeListener
-{
-public:
-    ColorPickerWindow(const juce::String& name,
-                      juce::Colour initialColor,
-                      std::function<void(juce::Colour)> colorCallback);
-    
-    void closeButtonPressed() override;
-    
-    void changeListenerCallback(juce::ChangeBroadcaster*) override;
-    
-private:
-    std::unique_ptr<juce::ColourSelector> colorSelector;
-    std::function<void(juce::Colour)> colorCallback;
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ColorPickerWindow)
-};
-
-class ToolPanel : public juce::Component
-{
-public:
-    ToolPanel(MainComponent& mainComponent);
-    
-    ~ToolPanel();
-
-    void resized() override;
-
-    void updateDimensionEditors(const MainComponent::Shape* shape);
-    void updateFromShape(const MainComponent::Shape* shape);
-    
-private:
-    
-    void deleteColorPickers();
-    
-    void showColorPicker(bool isFillColor);
-    MainComponent& owner;
-    
-    // Keep track of our color picker windows
-    std::unique_ptr<ColorPickerWindow> fillColorPicker;
-    std::unique_ptr<ColorPickerWindow> strokeColorPicker;
-    
-    juce::TextButton selectButton;
-    juce::TextButton rectangleButton;
-    juce::TextButton ellipseButton;
-    juce::TextButton lineButton;
-    
-    juce::Slider strokeWidthSlider;
-    juce::Label strokeWidthLabel;
-    juce::Slider cornerRadiusSlider;
-    juce::Label cornerRadiusLabel;
-    
-    juce::TextButton fillColorButton;
-    juce::TextButton strokeColorButton;
-    juce::Label fillColorLabel;
-    juce::Label strokeColorLabel;
-    
-    StrokePatternButton solidStrokeButton{ "Solid" };
-    StrokePatternButton dashedStrokeButton{ "Dashed" };
-    StrokePatternButton dottedStrokeButton{ "Dotted" };
-    StrokePatternButton dashDotStrokeButton{ "Dash-Dot" };
-    
-    juce::ToggleButton fillToggle;
-    
-    juce::Label widthLabel;
-    juce::Label heightLabel;
-    juce::TextEditor widthEditor;
-    juce::TextEditor heightEditor;
-    
-    juce::TextButton textButton;
-    juce::Slider fontSizeSlider;
-    juce::Label fontSizeLabel;
-    
-    bool updatingFromShape = false;  // prevent feedback loops
-    
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ToolPanel)
-};
-
-class ToolWindow : public juce::DocumentWindow
-{
-public:
-    ToolWindow(MainComponent& mainComponent);
-
-    void closeButtonPressed() override;
-    
-    ToolPanel& getToolPanel();
-
-private:
-    std::unique_ptr<ToolPanel> toolPanel;
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ToolWindow)
-};
+/*
+  ==============================================================================
+
+    MainComponent.h
+    Created: 11 Nov 2024 10:52:48pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+ 
+  ==============================================================================
+*/
+
+// MainComponent.h
+#pragma once
+#include <JuceHeader.h>
+#include <mutex>
+#include "AllocationCounter.h"
+#include "FrameArena.h"
+#include "BackgroundRenderer.h"
+#include "DrawOrder.h"
+#include "ImageLibrary.h"
+#include "ParameterBindings.h"
+#include "PerformanceOverlay.h"
+#include "ProgressiveRenderer.h"
+#include "SnapIndex.h"
+#include "StrokeSimplifier.h"
+#include "TileCache.h"
+#include "TraceRecorder.h"
+
+class StrokePatternButton : public juce::Button
+{
+public:
+    StrokePatternButton(const juce::String& name);
+    
+    void paintButton(juce::Graphics& g, bool isMouseOver, bool isButtonDown) override;
+    
+private:
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StrokePatternButton)
+};
+
+class SelectionHandle
+{
+public:
+    enum class Type
+    {
+        TopLeft,
+        Top,
+        TopRight,
+        Right,
+        BottomRight,
+        Bottom,
+        BottomLeft,
+        Left,
+        Rotate    // Handle for rotation
+    };
+
+    SelectionHandle();
+    SelectionHandle(Type type);
+    
+    SelectionHandle(const SelectionHandle& other);
+    SelectionHandle& operator=(const SelectionHandle& other);
+
+    static juce::Point<float> rotatePointAround(juce::Point<float> point,
+                                                juce::Point<float> center,
+                                                float angleInRadians);
+    
+    void updatePosition(const juce::Rectangle<float>& bounds, float rotationAngle, const juce::Point<float>& rotationCenter);
+
+    // Temporary paths come from the arena
+    void paint(juce::Graphics& g, FrameArena& arena);
+
+    bool hitTest(juce::Point<float> point) const;
+
+    Type getType() const { return handleType; }
+    juce::Point<float> getPosition() const { return position; }
+    juce::Rectangle<float> getBounds() const { return handleBounds; }
+
+private:
+    static constexpr float handleSize = 8.0f;
+    
+    static const juce::Path& getRotateIcon();
+    
+    Type handleType;
+    juce::Point<float> position;
+    juce::Rectangle<float> handleBounds;
+    juce::Rectangle<float> bounds_;  // Reference to the shape bounds
+};
+
+//Forward declaration
+class ToolWindow;
+class SymbolLibrary;
+class DocumentSnapshot;
+class AudioAnalyser;
+class FilmstripCache;
+
+class MainComponent : public juce::Component,
+                      public juce::ChangeListener,
+                      public juce::KeyListener,
+                      public juce::FileDragAndDropTarget,
+                      private RenderClient
+{
+public:
+    enum class Tool
+    {
+        Rectangle,
+        Ellipse,
+        Line,
+        Text,
+        Select,
+        Instance,   // only a shape type: a placed copy of a symbol, see SymbolLibrary
+        Meter,      // live audio displays: drawn like rectangles, with the
+        Scope,      // signal from the AudioAnalyser on top
+        Spectrum,
+        Freehand,   // pen strokes, simplified while drawing, see StrokeSimplifier
+        Image       // only a shape type: a bitmap from a file, see ImageLibrary
+    };
+
+    enum class RenderMode
+    {
+        Direct,         // every shape is drawn in paint()
+        Tiled,          // cached tiles, see TileCache
+        Progressive,    // refined over several frames, see ProgressiveRenderer
+        Threaded        // rendered on a separate thread, see BackgroundRenderer
+    };
+
+    enum class StrokePattern
+    {
+        Solid,
+        Dashed,
+        Dotted,
+        DashDot
+    };
+
+    // How a shape bound to a plugin parameter behaves as a control
+    enum class ControlType
+    {
+        None,
+        Knob,       // vertical drag, value shown as an arc
+        Slider,     // follows the mouse along the longer side
+        Toggle      // flips on click
+    };
+
+    struct Style
+    {
+        juce::Colour fillColour;
+        juce::Colour strokeColour;
+        float strokeWidth = 0.0f;
+        StrokePattern strokePattern = StrokePattern::Solid;
+        bool hasFill = false;
+        float cornerRadius = 0.0f;
+        float fontSize = 14.0f;
+        juce::String fontFamily = "Arial";
+        bool textStretchEnabled = false;
+        
+        bool operator==(const Style& other) const;
+        bool operator!=(const Style& other) const { return !operator==(other); }
+    };
+    
+    // A style as stored in the StyleTable, with what is looked up from it
+    // once rather than every time it's drawn
+    struct InternedStyle
+    {
+        explicit InternedStyle(const Style& s) : style(s) {}
+        
+        // From the FontCache, sharing its typeface. Only looked up the first
+        // time it's asked for, so interning the style of a shape that draws
+        // no text never loads a typeface.
+        const juce::Font& getFont() const;
+        
+        const Style style;
+        
+    private:
+        mutable std::once_flag fontLookup;
+        mutable juce::Font font;
+    };
+    
+    // A shape's style, shared with every other shape that looks the same.
+    // Handles point into the StyleTable, so equal styles are stored once and
+    // comparing two handles is a pointer compare. The style behind a handle
+    // never changes: edit() copies it, applies the change and interns the
+    // result.
+    class StyleHandle
+    {
+    public:
+        StyleHandle();
+        StyleHandle(const Style& newStyle);
+        
+        const Style& operator*() const { return entry->style; }
+        const Style* operator->() const { return &entry->style; }
+        const Style* get() const { return &entry->style; }
+        
+        // Needs no lock once the font was looked up, unlike asking the FontCache
+        const juce::Font& getFont() const { return entry->getFont(); }
+        
+        bool operator==(const StyleHandle& other) const { return entry == other.entry; }
+        bool operator!=(const StyleHandle& other) const { return entry != other.entry; }
+        
+        template<typename EditFunction>
+        void edit(EditFunction&& editFunction)
+        {
+            Style copy = entry->style;
+            editFunction(copy);
+            
+            if (copy != entry->style)
+                *this = StyleHandle(copy);
+        }
+        
+    private:
+        std::shared_ptr<const InternedStyle> entry;
+    };
+
+    struct Shape
+    {
+        Tool type;
+        juce::Rectangle<float> bounds;
+        StyleHandle style;
+        float rotation = 0.0f;
+        juce::Point<float> rotationCenter;
+        juce::Point<float> lineStart;
+        juce::Point<float> lineEnd;
+        juce::String text;
+        bool isEditing = false;  // Track if text is being edited
+        int symbolId = -1;       // instances only
+        ControlType control = ControlType::None;
+        int parameterIndex = -1; // see ParameterBindings
+        juce::String imageFile;  // images only, see ImageLibrary
+        
+        // Freehand strokes only: the simplified points, relative to the bounds
+        // (0 to 1 across each side), so that moving and resizing leave them
+        // alone. They never change after drawing and are shared between copies.
+        std::shared_ptr<const juce::Array<juce::Point<float>>> points;
+        
+        bool hitTest(juce::Point<float> point) const;
+        juce::Rectangle<float> getDrawnBounds() const;
+        void initializeRotationCenter();
+        void move(float dx, float dy);
+        void drawText(juce::Graphics& g) const;
+        
+        // Adds the curve through the freehand points, in document coordinates
+        void addFreehandCurve(juce::Path& path) const;
+        
+        // Text shapes don't own a font, it comes with their style
+        const juce::Font& getFont() const { return style.getFont(); }
+
+    };
+    
+    // Stays valid while the shape exists, whatever else is added or removed
+    using ShapeId = SlotId;
+    
+    // Lines and freehand strokes have no inside: they ignore the fill and
+    // are always stroked at least one unit wide
+    static bool isOpenPath(Tool type) { return type == Tool::Line || type == Tool::Freehand; }
+
+    // What the editor leaves behind in the processor when it closes, so that
+    // reopening it shows the last frame right away and keeps the rendered tiles
+    struct EditorState
+    {
+        std::shared_ptr<const DocumentSnapshot> document;   // what the frame shows
+        juce::Image frame;
+        float frameScale = 1.0f;    // physical pixels per component pixel
+        float viewScale = 1.0f;
+        juce::Point<float> viewOffset;
+        RenderMode renderMode = RenderMode::Direct;
+        std::unique_ptr<TileCache> tileCache;
+    };
+
+    MainComponent();
+    ~MainComponent() override;
+
+    void paint(juce::Graphics& g) override;
+     
+    void resized() override;
+
+    void mouseDown(const juce::MouseEvent& e) override;
+    void mouseDoubleClick(const juce::MouseEvent& e) override;
+    void mouseDrag(const juce::MouseEvent& e) override;
+
+    void mouseUp(const juce::MouseEvent& e) override;
+    void mouseWheelMove(const juce::MouseEvent& e, const juce::MouseWheelDetails& wheel) override;
+    void mouseMagnify(const juce::MouseEvent& e, float scaleFactor) override;
+    
+    void changeListenerCallback(juce::ChangeBroadcaster* source) override;
+    
+    bool keyPressed(const juce::KeyPress& key, Component *originatingComponent) override;
+    bool keyStateChanged (bool isKeyDown, Component *originatingComponent) override;
+    
+    bool isInterestedInFileDrag(const juce::StringArray& files) override;
+    void filesDropped(const juce::StringArray& files, int x, int y) override;
+    
+    void deselectAllShapes();
+    void setCurrentTool(Tool tool);
+    void setFillEnabled(bool enabled);
+    void setFillColour(juce::Colour colour);
+    void setStrokeColour(juce::Colour colour);
+    void setStrokeWidth(float width);
+    void setCornerRadius(float radius);
+    void setStrokePattern(StrokePattern pattern);
+    
+    void updateSelectedShapeFill(bool enabled);
+    void updateSelectedShapeFillColour(juce::Colour colour);
+    void updateSelectedShapeStrokeColour(juce::Colour colour);
+    void updateSelectedShapeStrokeWidth(float width);
+    void updateSelectedShapeCornerRadius(float radius);
+    void updateSelectedShapeStrokePattern(StrokePattern pattern);
+    void updateSelectedShapeFontSize(float size);
+    
+    // Coalesced versions for continuous controls (sliders, colour pickers).
+    // Only the latest value is applied, once per display frame.
+    void queueSelectedShapeFillColour(juce::Colour colour);
+    void queueSelectedShapeStrokeColour(juce::Colour colour);
+    void queueSelectedShapeStrokeWidth(float width);
+    void queueSelectedShapeCornerRadius(float radius);
+    void queueSelectedShapeFontSize(float size);
+        
+    const Shape* getSelectedShape() const;
+    void updateSelectedShapeBounds(const juce::Rectangle<float>& newBounds);
+    
+    // Turns the selected shape, together with the shapes in front of it that
+    // lie within it, into a symbol and puts an instance in their place
+    void createSymbolFromSelection();
+    
+    // Duplicating an instance only adds another placement of its symbol
+    void duplicateSelectedShape();
+    
+    // Restacks the selected shape, cmd/ctrl + ] and [ move it up or down by
+    // one, with shift to the front or back
+    void bringSelectedShapeForward();
+    void sendSelectedShapeBackward();
+    void bringSelectedShapeToFront();
+    void sendSelectedShapeToBack();
+    
+    // The parameters shapes can be bound to. Without them controls can still
+    // be designed, but show no value.
+    void setParameterBindings(ParameterBindings* bindings);
+    
+    // Cycles the selected shape through the control types, binding it to a
+    // free parameter, or moves it on to the next parameter
+    void cycleSelectedShapeControl();
+    void bindSelectedShapeToNextParameter();
+    
+    // Snapping to the edges and centres of other shapes and to equal gaps
+    // while moving and resizing, toggled with cmd/ctrl + shift + G
+    void setSnappingEnabled(bool shouldSnap);
+    bool isSnappingEnabled() const { return snappingEnabled; }
+    
+    // Writes the selected knob or slider, at every position, to a PNG on the desktop
+    void exportSelectedFilmstrip();
+    
+    // Where the meter, scope and spectrum shapes get their signal from
+    void setAudioAnalyser(AudioAnalyser* analyser);
+    
+    // While previewing, bound shapes act as controls instead of being edited
+    void setControlPreviewEnabled(bool shouldPreview);
+    bool isControlPreviewEnabled() const { return isPreviewingControls; }
+    
+    void startTextEditing(juce::Point<float> position, ShapeId existingShapeId = {});
+    void finishTextEditing();
+    
+    // Loads the typefaces of all text in the document in the background
+    void prewarmDocumentFonts();
+    
+    // Adds an image shape at its own size for each PNG, JPEG or GIF file, in
+    // rows across the view, starting at its top left or at a drop position.
+    // The files are decoded in the background.
+    void importImages(const juce::StringArray& files);
+    void importImages(const juce::StringArray& files, juce::Point<float> position);
+    
+    // Replaces the whole document, e.g. with one restored by the host
+    void setDocument(std::shared_ptr<const DocumentSnapshot> document);
+    
+    // Called with each finished version of the document, never in the middle
+    // of a drag or a text edit
+    std::function<void(std::shared_ptr<const DocumentSnapshot>)> onDocumentChanged;
+    
+    // For the editor that is closing: hands the tiles over with the state,
+    // so the component mustn't be painted again afterwards
+    std::unique_ptr<EditorState> saveEditorState();
+    void restoreEditorState(std::unique_ptr<EditorState> state);
+    
+    // When the host asked for the editor. The time from there to the first
+    // painted frame is shown in the HUD, or -1 until that frame is painted.
+    void setOpenStartTicks(juce::int64 ticks) { openStartTicks = ticks; }
+    double getEditorOpenMs() const { return editorOpenMs; }
+    
+    void setPerformanceOverlayVisible(bool shouldBeVisible);
+    bool isPerformanceOverlayVisible() const { return performanceOverlay.isVisible(); }
+    
+    // Starts recording trace spans, or stops and writes them to a Chrome trace file on the desktop
+    void toggleTraceRecording();
+    
+    // The view maps document coordinates, which shapes are stored in, to
+    // component coordinates. anchor is a point in component coordinates
+    // that stays in place while zooming.
+    juce::AffineTransform getViewTransform() const;
+    juce::Point<float> viewToDocument(juce::Point<float> position) const;
+    float getViewScale() const { return viewScale; }
+    void setViewScale(float newScale, juce::Point<float> anchor);
+    void panView(juce::Point<float> delta);
+    void resetView();
+    
+    // Cycled with cmd/ctrl + shift + R
+    void setRenderMode(RenderMode newMode);
+    RenderMode getRenderMode() const { return renderMode; }
+    
+private:
+    // RenderClient
+    void renderDocument(juce::Graphics& g, float scale) override;
+    std::shared_ptr<const RenderSource> getDocumentSnapshot() override;
+    
+    // Must be called before and after every change to a shape
+    void markShapeDirty(const Shape& shape);
+    void markSymbolDirty(int symbolId);
+    void markSnapshotOutdated(const Shape& changedShape);
+    std::shared_ptr<const DocumentSnapshot> createFullSnapshot(ShapeId hiddenShape);
+    std::shared_ptr<const DocumentSnapshot> createUpdatedSnapshot();
+    
+    // Calls edit(Style&, Tool) for each shape of a symbol's master. All
+    // instances follow.
+    template<typename EditFunction>
+    void editSymbolStyle(int symbolId, EditFunction&& edit);
+    
+    void updateTextEditorSize();
+    void updateToolPanelFromShape(const Shape* shape);
+    void drawDimensionLabel(juce::Graphics& g, const Shape& shape);
+    void findDimensionLabelGlyphs();
+    void drawControlValues(juce::Graphics& g);
+    
+    // The signal is drawn over the finished scene, so shapes stacked above a
+    // display don't hide it. Displays are meant to sit on top of the layout,
+    // keep them there.
+    void drawAudioDisplays(juce::Graphics& g);
+    void drawAudioDisplay(juce::Graphics& g, const Shape& shape);
+    void repaintAudioDisplays();
+    void repaintControls(juce::uint32 changedParameters);
+    bool beginControlDrag(juce::Point<float> position);
+    void dragControl(juce::Point<float> position);
+    void endControlDrag();
+    int findFreeParameter(int startIndex) const;
+    void addToLiveShapeIndexes(ShapeId id, const Shape& shape);
+    juce::Rectangle<float> getShapeDrawnBounds(const Shape& shape) const;
+    void imagesLoaded();
+    void showTools();
+    ToolWindow& getToolWindow();
+    void firstFramePainted();
+    void prepareRotation(const juce::MouseEvent& e, Shape& shape);
+
+    void updateSelectionHandles();
+    void handleShapeManipulation(juce::Point<float> position);
+    void rotateShape(juce::Point<float> position);
+    void resizeShape(juce::Point<float> position);
+    void applyPendingUpdates();
+    
+    // The topmost shape at the position that passes the filter, or an invalid id
+    template<typename Filter>
+    ShapeId findTopmostShape(juce::Point<float> position, Filter&& filter) const;
+    void restackSelectedShape(void (DrawOrder::*restack)(SlotId));
+    
+    // Snapping, see SnapIndex
+    struct AxisSnap
+    {
+        float offset = 0.0f;
+        const SnapIndex::Edge* edge = nullptr;              // aligned with this edge
+        const SnapIndex::Edge* gapBefore = nullptr;         // or centred between these
+        const SnapIndex::Edge* gapAfter = nullptr;
+    };
+    
+    static juce::Rectangle<float> getSnapBounds(const Shape& shape);
+    static bool canSnapResize(const Shape& shape);
+    void beginSnapDrag();
+    void endSnapDrag();
+    void removeFromSnapIndex(ShapeId id);
+    void updateFreehandOutline();
+    AxisSnap findAxisSnap(SnapIndex::Axis axis, juce::Rectangle<float> bounds, float maxDistance) const;
+    juce::Point<float> getMoveSnapOffset(juce::Rectangle<float> bounds);
+    void snapResizedEdges(Shape& shape);
+    void addSnapGuides(SnapIndex::Axis axis, const AxisSnap& snap, juce::Rectangle<float> snappedBounds);
+    void addSnapGuide(bool isVertical, float position, juce::Range<float> span);
+    void drawSnapGuides(juce::Graphics& g);
+    void handleVBlank();
+    void publishDocument();
+    juce::Rectangle<int> getFrameBounds(float pixelScale) const;
+    void viewChanged();
+    void updateTextEditorTransform();
+    
+    // Built after the first frame is on screen, or by showTools() if that
+    // comes first, so it doesn't add to the time it takes to open the editor
+    std::unique_ptr<ToolWindow> toolWindow;
+    juce::TextButton showToolsButton;
+    
+    juce::int64 openStartTicks = 0;
+    double editorOpenMs = -1.0;
+    bool hasPaintedFirstFrame = false;
+    
+    // State
+    Tool currentTool = Tool::Rectangle;
+    Style currentStyle;
+    bool isDrawing = false;
+    bool currentlyEditingFillColour = false;
+    juce::Point<float> dragStart;
+    juce::Point<float> dragEnd;
+    StrokeSimplifier freehandStroke;
+    juce::Path freehandOutline;         // of the finished curve, when the style allows it
+    int numOutlinedFreehandPoints = 0;  // kept points that freehandOutline covers
+    SlotMap<Shape> shapes;      // identified by ShapeId, stored in no particular order
+    DrawOrder drawOrder;        // stacking order
+    std::unique_ptr<SymbolLibrary> symbolLibrary;
+    
+    static constexpr float duplicateOffset = 10.0f;
+    
+    // How far a simplified freehand stroke may stray from the mouse, on screen
+    static constexpr float freehandTolerancePixels = 0.75f;
+    
+    // For images whose size can't be read from the file header
+    static constexpr float defaultImageSize = 100.0f;
+    static constexpr float importedImageSpacing = 10.0f;
+    
+    // Selection related members
+    ShapeId selectedShapeId;
+    juce::Array<SelectionHandle> selectionHandles;  // storage reserved up front, see updateSelectionHandles()
+    bool isDraggingShape = false;
+    bool isDraggingHandle = false;
+    SelectionHandle::Type activeHandle = SelectionHandle::Type::TopLeft;
+    juce::Point<float> lastMousePosition;
+    float initialRotation = 0.0f;
+    float initialAngle = 0.0f;
+    
+    // Snapping: the dragged shape itself is left out of the index until the
+    // drag ends. Everything else that changes shapes rebuilds it on the next drag.
+    struct SnapGuide
+    {
+        bool isVertical = false;
+        float position = 0.0f;          // x of a vertical guide, y of a horizontal one
+        juce::Range<float> span;
+    };
+    
+    static constexpr float snapDistancePixels = 6.0f;
+    static constexpr int maxSnapGuides = 6;
+    
+    SnapIndex snapIndex;
+    bool snapIndexNeedsRebuild = true;
+    bool snappingEnabled = true;
+    juce::Rectangle<float> unsnappedBounds;    // where resizing alone would have put the shape
+    juce::Point<float> snapOffset;              // applied to the moved shape this frame
+    std::array<SnapGuide, maxSnapGuides> snapGuides;
+    int numSnapGuides = 0;
+    
+    // View: zoomed with cmd/ctrl + wheel or pinch, panned with the wheel or a
+    // middle-button drag
+    static constexpr float minViewScale = 0.01f;
+    static constexpr float maxViewScale = 64.0f;
+    static constexpr float wheelPanSpeed = 200.0f;
+    static constexpr float wheelZoomSpeed = 2.0f;
+    
+    float viewScale = 1.0f;
+    juce::Point<float> viewOffset;      // always whole pixels
+    juce::Point<float> panRemainder;
+    bool isPanningView = false;
+    juce::Point<float> lastPanPosition;
+    
+    // Controls bound to plugin parameters, previewed with cmd/ctrl + E
+    static constexpr float knobDragPixels = 200.0f;
+    static constexpr float filmstripAssetScale = 2.0f;
+    
+    ParameterBindings* parameterBindings = nullptr;
+    AudioAnalyser* audioAnalyser = nullptr;
+    
+    // Meters, scopes and spectrums, so the vblank doesn't walk the document
+    // to find them. A superset: ids are added by markShapeDirty and pruned by
+    // repaintAudioDisplays.
+    juce::Array<ShapeId> audioDisplayIds;
+    
+    // Bound controls by parameter, so a parameter change only touches its
+    // own controls. Kept like audioDisplayIds and pruned by repaintControls.
+    std::array<juce::Array<ShapeId>, ParameterBindings::numParameters> controlIdsByParameter;
+    std::unique_ptr<FilmstripCache> filmstripCache;
+    bool isPreviewingControls = false;
+    ShapeId draggedControlId;
+    float controlDragStartValue = 0.0f;
+    juce::Point<float> controlDragStart;
+    
+    // Input coalescing: drags and property edits are collected between
+    // display frames and applied once per vblank
+    struct PendingStyleEdits
+    {
+        std::optional<juce::Colour> fillColour;
+        std::optional<juce::Colour> strokeColour;
+        std::optional<float> strokeWidth;
+        std::optional<float> cornerRadius;
+        std::optional<float> fontSize;
+    };
+    
+    bool hasPendingDrag = false;
+    juce::Point<float> pendingDragPosition;
+    PendingStyleEdits pendingStyleEdits;
+    juce::VBlankAttachment vBlankAttachment { this, [this] { handleVBlank(); } };
+    
+    //Text tool related:
+    bool isEditingText = false;
+    bool isEditingExistingText = false;
+    ShapeId editingShapeId;
+    float currentEditorHeight = 0.0f;
+    std::unique_ptr<juce::TextEditor> textEditor;
+    
+    // Paint temporaries: per-frame ones come from the arena, which is reset
+    // at the end of every paint, the dimension label is cached across frames
+    FrameArena frameArena;
+    juce::Font dimensionLabelFont { 14.0f };
+    
+    // The label only ever shows digits and " × ", so their glyphs are looked
+    // up once and changing sizes are drawn without building any text
+    static constexpr int numDimensionLabelChars = 12;
+    std::array<int, numDimensionLabelChars> dimensionLabelGlyphs {};
+    std::array<float, numDimensionLabelChars> dimensionLabelAdvances {};
+    bool hasDimensionLabelGlyphs = false;
+    
+    // Rendering
+    static constexpr double progressiveSliceBudgetMs = 8.0;
+    
+    RenderMode renderMode = RenderMode::Direct;
+    std::unique_ptr<TileCache> tileCache;
+    ProgressiveRenderer progressiveRenderer;
+    BackgroundRenderer backgroundRenderer;
+    std::shared_ptr<const DocumentSnapshot> documentSnapshot;
+    
+    // Edits are published once they've settled, so that a run of slider
+    // ticks or key presses hands the processor one version, not dozens
+    static constexpr juce::uint32 publishDelayMs = 250;
+    
+    bool hasUnpublishedChanges = false;
+    juce::uint32 lastEditTime = 0;
+    
+    // What changed since documentSnapshot was taken. Unless the stacking
+    // order changed as well, the next snapshot only copies the chunks that
+    // hold the changed shapes, see getDocumentSnapshot().
+    static constexpr int maxSnapshotChanges = 64;
+    
+    bool isSnapshotOutdated = true;
+    bool snapshotNeedsFullRebuild = true;
+    juce::Array<ShapeId> shapesChangedSinceSnapshot;    // storage reserved in the constructor
+    juce::uint32 snapshotDrawOrderVersion = 0;
+    ShapeId snapshotHiddenShape;                        // the text being edited, left out
+    std::shared_ptr<const SymbolLibrary> symbolSnapshot; // shared by snapshots until the symbols change
+    
+    // The frame saved by the previous editor, shown until anything changes
+    juce::Image cachedFrame;
+    float cachedFrameScale = 1.0f;
+    
+    // Performance HUD, toggled with cmd/ctrl + shift + P
+    PerformanceOverlay performanceOverlay;
+    
+    // Stands in for the display, see handleVBlank()
+    friend class DragAllocationTests;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainComponent)
+};
+
+//==================================================================
+
+class ColorPickerWindow : public juce::DocumentWindow, public juce::ChangeListener
+{
+public:
+    ColorPickerWindow(const juce::String& name,
+                      juce::Colour initialColor,
+                      std::function<void(juce::Colour)> colorCallback);
+    
+    void closeButtonPressed() override;
+    
+    void changeListenerCallback(juce::ChangeBroadcaster*) override;
+    
+private:
+    std::unique_ptr<juce::ColourSelector> colorSelector;
+    std::function<void(juce::Colour)> colorCallback;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ColorPickerWindow)
+};
+
+class ToolPanel : public juce::Component
+{
+public:
+    ToolPanel(MainComponent& mainComponent);
+    
+    ~ToolPanel();
+
+    void resized() override;
+
+    void updateDimensionEditors(const MainComponent::Shape* shape);
+    void updateFromShape(const MainComponent::Shape* shape);
+    
+private:
+    
+    void deleteColorPickers();
+    
+    void showColorPicker(bool isFillColor);
+    MainComponent& owner;
+    
+    // Keep track of our color picker windows
+    std::unique_ptr<ColorPickerWindow> fillColorPicker;
+    std::unique_ptr<ColorPickerWindow> strokeColorPicker;
+    
+    juce::TextButton selectButton;
+    juce::TextButton rectangleButton;
+    juce::TextButton ellipseButton;
+    juce::TextButton lineButton;
+    juce::TextButton penButton;
+    
+    juce::Slider strokeWidthSlider;
+    juce::Label strokeWidthLabel;
+    juce::Slider cornerRadiusSlider;
+    juce::Label cornerRadiusLabel;
+    
+    juce::TextButton fillColorButton;
+    juce::TextButton strokeColorButton;
+    juce::Label fillColorLabel;
+    juce::Label strokeColorLabel;
+    
+    StrokePatternButton solidStrokeButton{ "Solid" };
+    StrokePatternButton dashedStrokeButton{ "Dashed" };
+    StrokePatternButton dottedStrokeButton{ "Dotted" };
+    StrokePatternButton dashDotStrokeButton{ "Dash-Dot" };
+    
+    juce::ToggleButton fillToggle;
+    
+    juce::Label widthLabel;
+    juce::Label heightLabel;
+    juce::TextEditor widthEditor;
+    juce::TextEditor heightEditor;
+    
+    juce::TextButton textButton;
+    juce::TextButton meterButton;
+    juce::TextButton scopeButton;
+    juce::TextButton spectrumButton;
+    juce::TextButton imageButton;
+    std::unique_ptr<juce::FileChooser> imageChooser;
+    juce::Slider fontSizeSlider;
+    juce::Label fontSizeLabel;
+    
+    bool updatingFromShape = false;  // prevent feedback loops
+    
+    // Last values written to the dimension editors, to skip redundant setText calls
+    int shownWidth = -1;
+    int shownHeight = -1;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ToolPanel)
+};
+
+class ToolWindow : public juce::DocumentWindow
+{
+public:
+    ToolWindow(MainComponent& mainComponent);
+
+    void closeButtonPressed() override;
+    
+    ToolPanel& getToolPanel();
+
+private:
+    std::unique_ptr<ToolPanel> toolPanel;
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ToolWindow)
+};
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    ParameterBindings.cpp
+    Created: 18 Oct 2026 8:12:31pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "ParameterBindings.h"
+
+ParameterBindings::ParameterBindings(juce::AudioProcessor& processor)
+{
+    for (int i = 0; i < numParameters; ++i)
+    {
+        const bool isLevel = i == levelParameter;
+        auto* parameter = new juce::AudioParameterFloat(juce::ParameterID("control" + juce::String(i + 1), 1),
+                                                        isLevel ? "Level" : "Control " + juce::String(i + 1),
+                                                        0.0f, 1.0f, isLevel ? 1.0f : 0.5f);
+        processor.addParameter(parameter);
+        parameter->addListener(this);
+        parameters.add(parameter);
+    }
+}
+
+ParameterBindings::~ParameterBindings()
+{
+    for (auto* parameter : parameters)
+        parameter->removeListener(this);
+}
+
+juce::AudioParameterFloat& ParameterBindings::getParameter(int index) const
+{
+    jassert(juce::isPositiveAndBelow(index, numParameters));
+    return *parameters.getUnchecked(index);
+}
+
+float ParameterBindings::getValue(int index) const
+{
+    return getParameter(index).getValue();
+}
+
+void ParameterBindings::beginGesture(int index)
+{
+    getParameter(index).beginChangeGesture();
+}
+
+void ParameterBindings::setValue(int index, float normalisedValue)
+{
+    getParameter(index).setValueNotifyingHost(juce::jlimit(0.0f, 1.0f, normalisedValue));
+}
+
+void ParameterBindings::endGesture(int index)
+{
+    getParameter(index).endChangeGesture();
+}
+
+juce::uint32 ParameterBindings::takeChangedParameters()
+{
+    return changedParameters.exchange(0);
+}
+
+void ParameterBindings::parameterValueChanged(int parameterIndex, float)
+{
+    // May be the audio thread: no locks, no allocation
+    const auto index = parameterIndex - parameters.getFirst()->getParameterIndex();
+
+    if (juce::isPositiveAndBelow(index, numParameters))
+        changedParameters.fetch_or(1u << index);
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    ParameterBindings.h
+    Created: 18 Oct 2026 8:12:31pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// ParameterBindings.h
+#pragma once
+#include <JuceHeader.h>
+
+// The fixed set of plugin parameters that shapes on the canvas can be bound
+// to as controls. Hosts expect the parameter list to stay the same, so the
+// parameters are created up front and the document only stores indices.
+//
+// Values travel between the threads through the parameters' own atomics.
+// Changes from any thread, including host automation on the audio thread,
+// only set a bit in an atomic mask, which the editor collects once per frame
+// to repaint the controls concerned.
+class ParameterBindings : private juce::AudioProcessorParameter::Listener
+{
+public:
+    static constexpr int numParameters = 16;
+    static constexpr int levelParameter = 0;    // also the plugin's output gain
+
+    // Adds the parameters to the processor
+    explicit ParameterBindings(juce::AudioProcessor& processor);
+    ~ParameterBindings() override;
+
+    juce::AudioParameterFloat& getParameter(int index) const;
+
+    // Normalised value, safe to call from any thread
+    float getValue(int index) const;
+
+    // For dragging a control on the canvas, message thread only
+    void beginGesture(int index);
+    void setValue(int index, float normalisedValue);
+    void endGesture(int index);
+
+    // Returns one bit per parameter changed since the last call and clears them
+    juce::uint32 takeChangedParameters();
+
+private:
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int, bool) override {}
+
+    juce::Array<juce::AudioParameterFloat*> parameters;    // owned by the processor
+    std::atomic<juce::uint32> changedParameters { 0 };
+
+    static_assert(numParameters <= 32, "one bit per parameter");
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterBindings)
+};
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+    PerformanceOverlay.cpp
+    Created: 18 Oct 2026 9:31:05am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "PerformanceOverlay.h"
+#include "AllocationCounter.h"
+
+void PerformanceOverlay::setVisible(bool shouldBeVisible)
+{
+    visible = shouldBeVisible;
+
+    // Start with a clean history so stale numbers don't show up
+    historyPosition = 0;
+    historySize = 0;
+    previousFrameStartTicks = 0;
+}
+
+void PerformanceOverlay::beginFrame(juce::Rectangle<int> repaintArea)
+{
+    if (!visible)
+        return;
+
+    previousFrameStartTicks = frameStartTicks;
+    frameStartTicks = juce::Time::getHighResolutionTicks();
+    allocationsAtFrameStart = AllocationCounter::getNumAllocationsOnThisThread();
+
+    for (auto& ms : sectionMs)
+        ms = 0.0;
+
+    shapesDrawn = 0;
+    shapesCulled = 0;
+    shapesOccluded = 0;
+    shapesBatched = 0;
+    shapesSimplified = 0;
+    drawCalls = 0;
+    tileStats = {};
+    progressiveStats = {};
+    backgroundStats = {};
+    repaintedArea = repaintArea;
+}
+
+void PerformanceOverlay::beginSection(Section section)
+{
+    if (!visible)
+        return;
+
+    currentSection = section;
+    sectionStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void PerformanceOverlay::endSection()
+{
+    if (visible)
+        sectionMs[(int) currentSection] += ticksToMs(juce::Time::getHighResolutionTicks() - sectionStartTicks);
+}
+
+void PerformanceOverlay::addRenderStatistics(int numDrawn, int numCulled, int numOccluded, int numBatched,
+                                             int numSimplified, int numDrawCalls)
+{
+    if (!visible)
+        return;
+
+    shapesDrawn += numDrawn;
+    shapesCulled += numCulled;
+    shapesOccluded += numOccluded;
+    shapesBatched += numBatched;
+    shapesSimplified += numSimplified;
+    drawCalls += numDrawCalls;
+}
+
+void PerformanceOverlay::setTileStatistics(const TileCache::Statistics& stats)
+{
+    if (visible)
+        tileStats = stats;
+}
+
+void PerformanceOverlay::setProgressiveStatistics(const ProgressiveRenderer::Statistics& stats)
+{
+    if (visible)
+        progressiveStats = stats;
+}
+
+void PerformanceOverlay::setStartupTimes(double newEditorOpenMs, double newToolWindowMs)
+{
+    editorOpenMs = newEditorOpenMs;
+    toolWindowMs = newToolWindowMs;
+}
+
+void PerformanceOverlay::setBackgroundRenderStatistics(const BackgroundRenderer::Statistics& stats)
+{
+    if (visible)
+        backgroundStats = stats;
+}
+
+void PerformanceOverlay::setFrameArenaStatistics(const FrameArena::Statistics& stats)
+{
+    if (visible)
+        arenaStats = stats;
+}
+
+double PerformanceOverlay::ticksToMs(juce::int64 ticks)
+{
+    return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+}
+
+void PerformanceOverlay::paint(juce::Graphics& g, juce::Rectangle<int> componentBounds)
+{
+    if (!visible)
+        return;
+
+    // Take the measurements before building any strings for the HUD itself
+    auto allocations = AllocationCounter::getNumAllocationsOnThisThread() - allocationsAtFrameStart;
+    lastFrameMs = ticksToMs(juce::Time::getHighResolutionTicks() - frameStartTicks);
+    lastIntervalMs = previousFrameStartTicks != 0 ? ticksToMs(frameStartTicks - previousFrameStartTicks) : 0.0;
+
+    frameHistory[historyPosition] = lastFrameMs;
+    intervalHistory[historyPosition] = lastIntervalMs;
+    historyPosition = (historyPosition + 1) % numHistoryFrames;
+    historySize = std::min(historySize + 1, numHistoryFrames);
+
+    double averageFrameMs = 0.0;
+    double worstFrameMs = 0.0;
+    double averageIntervalMs = 0.0;
+    for (int i = 0; i < historySize; ++i)
+    {
+        averageFrameMs += frameHistory[i];
+        worstFrameMs = std::max(worstFrameMs, frameHistory[i]);
+        averageIntervalMs += intervalHistory[i];
+    }
+    if (historySize > 0)
+    {
+        averageFrameMs /= historySize;
+        averageIntervalMs /= historySize;
+    }
+
+    auto repaintedPixels = (double) repaintedArea.getWidth() * repaintedArea.getHeight();
+    auto totalPixels = std::max(1.0, (double) componentBounds.getWidth() * componentBounds.getHeight());
+
+    juce::StringArray lines;
+    lines.add("Paint: " + juce::String(lastFrameMs, 2) + " ms  (avg " + juce::String(averageFrameMs, 2)
+              + ", max " + juce::String(worstFrameMs, 2) + ")");
+    lines.add("Interval: " + juce::String(lastIntervalMs, 1) + " ms  (avg " + juce::String(averageIntervalMs, 1) + ")");
+    lines.add("  shapes " + juce::String(sectionMs[(int) Section::Shapes], 2) + " ms"
+              + "  selection " + juce::String(sectionMs[(int) Section::Selection], 2) + " ms"
+              + "  labels " + juce::String(sectionMs[(int) Section::Labels], 2) + " ms");
+    lines.add("Shapes drawn " + juce::String(shapesDrawn) + ", culled " + juce::String(shapesCulled)
+              + ", occluded " + juce::String(shapesOccluded));
+    lines.add("  batched " + juce::String(shapesBatched) + ", simplified " + juce::String(shapesSimplified)
+              + ", draw calls " + juce::String(drawCalls));
+    if (tileStats.tilesVisible > 0)
+        lines.add("Tiles: " + juce::String(tileStats.tilesVisible) + " visible, " + juce::String(tileStats.tilesStale)
+                  + " stale, " + juce::String(tileStats.tilesQueued) + " pending, " + juce::String(tileStats.tilesCached) + " cached");
+    if (progressiveStats.slices > 0)
+        lines.add("Progressive: " + juce::String(progressiveStats.itemsDone) + " of " + juce::String(progressiveStats.itemsTotal)
+                  + (progressiveStats.complete ? " (done), " : ", ") + juce::String(progressiveStats.slices)
+                  + " slices, last " + juce::String(progressiveStats.lastSliceMs, 1) + " ms");
+    if (backgroundStats.framesPresented > 0)
+        lines.add("Render thread: " + juce::String(backgroundStats.framesPresented) + " frames, last "
+                  + juce::String(backgroundStats.lastFrameMs, 1) + " ms" + (backgroundStats.upToDate ? "" : ", pending"));
+    lines.add("Repainted " + juce::String(repaintedArea.getWidth()) + " x " + juce::String(repaintedArea.getHeight())
+              + " (" + juce::String(100.0 * repaintedPixels / totalPixels, 0) + "%)");
+
+    lines.add("Frame arena: " + juce::String(arenaStats.bytesUsed / 1024.0, 1) + " KB, high-water "
+              + juce::String(arenaStats.highWaterBytes / 1024.0, 1) + " of " + juce::String(arenaStats.bytesReserved / 1024.0, 1) + " KB");
+    lines.add("  paths " + juce::String(arenaStats.pathsUsed) + ", high-water " + juce::String(arenaStats.highWaterPaths));
+
+    if (editorOpenMs >= 0.0)
+        lines.add("Editor open: " + juce::String(editorOpenMs, 1) + " ms to first frame"
+                  + (toolWindowMs >= 0.0 ? ", tools " + juce::String(toolWindowMs, 1) + " ms" : juce::String()));
+
+    if (AllocationCounter::isEnabled())
+        lines.add("Allocations this frame: " + juce::String((juce::int64) allocations));
+    else
+        lines.add("Allocations this frame: n/a (counting disabled)");
+
+    const float lineHeight = 14.0f;
+    const float padding = 6.0f;
+    const float width = 300.0f;
+    juce::Rectangle<float> hudBounds(componentBounds.getRight() - width - padding,
+                                     padding,
+                                     width,
+                                     lines.size() * lineHeight + padding * 2);
+
+    juce::Graphics::ScopedSaveState stateSave(g);
+    g.setColour(juce::Colours::black.withAlpha(0.75f));
+    g.fillRoundedRectangle(hudBounds, 4.0f);
+
+    g.setColour(juce::Colours::white);
+    g.setFont(juce::Font(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain));
+
+    auto textArea = hudBounds.reduced(padding);
+    for (auto& line : lines)
+        g.drawText(line, textArea.removeFromTop(lineHeight), juce::Justification::centredLeft, false);
+}
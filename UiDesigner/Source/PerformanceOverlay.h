@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    PerformanceOverlay.h
+    Created: 18 Oct 2026 9:31:05am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// PerformanceOverlay.h
+#pragma once
+#include <JuceHeader.h>
+#include "BackgroundRenderer.h"
+#include "FrameArena.h"
+#include "ProgressiveRenderer.h"
+#include "TileCache.h"
+
+// Collects per-frame paint statistics for the canvas and draws them as a HUD.
+// All counting functions return immediately while the overlay is hidden, so
+// the calls can stay in the paint path permanently.
+class PerformanceOverlay
+{
+public:
+    enum class Section
+    {
+        Shapes,
+        Selection,
+        Labels,
+        NumSections
+    };
+
+    PerformanceOverlay() = default;
+
+    void setVisible(bool shouldBeVisible);
+    bool isVisible() const { return visible; }
+
+    void beginFrame(juce::Rectangle<int> repaintArea);
+    void beginSection(Section section);
+    void endSection();
+    // Adds up over all renders of the frame, e.g. one per tile
+    void addRenderStatistics(int shapesDrawn, int shapesCulled, int shapesOccluded, int shapesBatched,
+                             int shapesSimplified, int drawCalls);
+    void setTileStatistics(const TileCache::Statistics& stats);
+    void setProgressiveStatistics(const ProgressiveRenderer::Statistics& stats);
+    void setBackgroundRenderStatistics(const BackgroundRenderer::Statistics& stats);
+    void setFrameArenaStatistics(const FrameArena::Statistics& stats);
+
+    // Kept for the lifetime of the editor, unlike the per-frame numbers
+    void setStartupTimes(double editorOpenMs, double toolWindowMs);
+
+    // Finishes the frame statistics and draws the HUD in the top-right corner
+    void paint(juce::Graphics& g, juce::Rectangle<int> componentBounds);
+
+private:
+    static double ticksToMs(juce::int64 ticks);
+
+    static constexpr int numHistoryFrames = 60;
+
+    bool visible = false;
+
+    juce::int64 frameStartTicks = 0;
+    juce::int64 previousFrameStartTicks = 0;
+    juce::uint64 allocationsAtFrameStart = 0;
+    juce::int64 sectionStartTicks = 0;
+    Section currentSection = Section::Shapes;
+
+    double sectionMs[(int) Section::NumSections] = {};
+    int shapesDrawn = 0;
+    int shapesCulled = 0;
+    int shapesOccluded = 0;
+    int shapesBatched = 0;
+    int shapesSimplified = 0;
+    int drawCalls = 0;
+    juce::Rectangle<int> repaintedArea;
+    FrameArena::Statistics arenaStats;
+    TileCache::Statistics tileStats;
+    ProgressiveRenderer::Statistics progressiveStats;
+    BackgroundRenderer::Statistics backgroundStats;
+
+    double editorOpenMs = -1.0;      // createEditor() to the end of the first paint
+    double toolWindowMs = -1.0;      // building the tool window afterwards
+
+    double lastFrameMs = 0.0;
+    double lastIntervalMs = 0.0;
+    double frameHistory[numHistoryFrames] = {};
+    double intervalHistory[numHistoryFrames] = {};
+    int historyPosition = 0;
+    int historySize = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceOverlay)
+};
@@ -1,41 +1,115 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-UiDesignerAudioProcessorEditor::UiDesignerAudioProcessorEditor (UiDesignerAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
-{
-    // Make sure that before the constructor has finished, you've set the
-    // editor's size to whatever you need it to be.
-    setSize (800, 600);
-    
-    addAndMakeVisible(mainComp);
-}
-
-UiDesignerAudioProcessorEditor::~UiDesignerAudioProcessorEditor()
-{
-}
-
-//==============================================================================
-void UiDesignerAudioProcessorEditor::paint (juce::Graphics& g)
-{
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
-}
-
-void UiDesignerAudioProcessorEditor::resized()
-{
-    mainComp.setBounds(getLocalBounds());
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+
+//==============================================================================
+UiDesignerAudioProcessorEditor::UiDesignerAudioProcessorEditor (UiDesignerAudioProcessor& p, juce::int64 openStartTicks)
+    : AudioProcessorEditor (&p), audioProcessor (p)
+{
+    mainComp.setOpenStartTicks (openStartTicks);
+    
+    // Make sure that before the constructor has finished, you've set the
+    // editor's size to whatever you need it to be.
+    setSize (800, 600);
+    
+    addAndMakeVisible(mainComp);
+    
+    // Reopening picks up where the last editor left off, including its last
+    // frame, so there's something on screen before anything is rendered.
+    // A restore from before the editor opened is already the latest version.
+    audioProcessor.takeRestoredDocument();
+    
+    if (auto document = audioProcessor.getDocumentHandoff().getLatest())
+        mainComp.setDocument (std::move (document));
+    
+    mainComp.restoreEditorState (audioProcessor.takeEditorState());
+    
+    mainComp.onDocumentChanged = [this] (std::shared_ptr<const DocumentSnapshot> document)
+    {
+        audioProcessor.getDocumentHandoff().publish (std::move (document));
+    };
+    
+    mainComp.setParameterBindings (&audioProcessor.getParameterBindings());
+    mainComp.setAudioAnalyser (&audioProcessor.getAudioAnalyser());
+    audioProcessor.getDocumentRestoredBroadcaster().addChangeListener (this);
+}
+
+UiDesignerAudioProcessorEditor::~UiDesignerAudioProcessorEditor()
+{
+    audioProcessor.getDocumentRestoredBroadcaster().removeChangeListener (this);
+    mainComp.setParameterBindings (nullptr);
+    audioProcessor.storeEditorState (mainComp.saveEditorState());
+}
+
+//==============================================================================
+void UiDesignerAudioProcessorEditor::paint (juce::Graphics& g)
+{
+    // mainComp is opaque and covers the whole editor, so JUCE clips it out
+    // and this normally isn't called at all
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+}
+
+void UiDesignerAudioProcessorEditor::resized()
+{
+    mainComp.setBounds(getLocalBounds());
+}
+
+void UiDesignerAudioProcessorEditor::changeListenerCallback (juce::ChangeBroadcaster*)
+{
+    // The editor may have published an edit between the restore and this
+    // message, so the restored version is published again to replace it
+    if (auto document = audioProcessor.takeRestoredDocument())
+    {
+        mainComp.setDocument (document);
+        audioProcessor.getDocumentHandoff().publish (std::move (document));
+    }
+}
+
+#if JUCE_UNIT_TESTS
+
+// Opens the editor the way a host would and paints it once, which is when
+// the editor counts its first frame as shown
+class EditorOpenTimeTests : public juce::UnitTest
+{
+public:
+    EditorOpenTimeTests() : juce::UnitTest ("Editor open time", "UiDesigner") {}
+
+    void runTest() override
+    {
+        beginTest ("Open to first frame");
+
+        UiDesignerAudioProcessor processor;
+        std::unique_ptr<juce::AudioProcessorEditor> editor (processor.createEditor());
+
+        auto* canvas = dynamic_cast<MainComponent*> (editor->getChildComponent (0));
+        expect (canvas != nullptr);
+
+        if (canvas == nullptr)
+            return;
+
+        expectEquals (canvas->getEditorOpenMs(), -1.0);
+        editor->createComponentSnapshot (editor->getLocalBounds());
+
+        const auto openMs = canvas->getEditorOpenMs();
+        logMessage ("Editor open to first frame: " + juce::String (openMs, 1) + " ms");
+
+        expectGreaterOrEqual (openMs, 0.0);
+        expectLessThan (openMs, maxOpenMs);
+    }
+
+private:
+    // Generous, so that a loaded test machine doesn't fail it. Opening
+    // normally takes a small fraction of this.
+    static constexpr double maxOpenMs = 500.0;
+};
+
+static EditorOpenTimeTests editorOpenTimeTests;
+
+#endif
@@ -1,36 +1,41 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin editor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-#include "PluginProcessor.h"
-#include "MainComponent.h"
-
-//==============================================================================
-/**
-*/
-class UiDesignerAudioProcessorEditor  : public juce::AudioProcessorEditor
-{
-public:
-    UiDesignerAudioProcessorEditor (UiDesignerAudioProcessor&);
-    ~UiDesignerAudioProcessorEditor() override;
-
-    //==============================================================================
-    void paint (juce::Graphics&) override;
-    void resized() override;
-
-private:
-    // This reference is provided as a quick way for your editor to
-    // access the processor object that created it.
-    UiDesignerAudioProcessor& audioProcessor;
-    
-    MainComponent mainComp;
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UiDesignerAudioProcessorEditor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include "MainComponent.h"
+
+//==============================================================================
+/**
+*/
+class UiDesignerAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                        private juce::ChangeListener
+{
+public:
+    // openStartTicks is when the host asked for the editor, see createEditor()
+    UiDesignerAudioProcessorEditor (UiDesignerAudioProcessor&, juce::int64 openStartTicks);
+    ~UiDesignerAudioProcessorEditor() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    // Picks up a document restored by the host
+    void changeListenerCallback (juce::ChangeBroadcaster*) override;
+
+    // This reference is provided as a quick way for your editor to
+    // access the processor object that created it.
+    UiDesignerAudioProcessor& audioProcessor;
+    
+    MainComponent mainComp;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UiDesignerAudioProcessorEditor)
+};
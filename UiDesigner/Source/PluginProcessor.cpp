@@ -1,191 +1,249 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#include "PluginProcessor.h"
-#include "PluginEditor.h"
-
-//==============================================================================
-UiDesignerAudioProcessor::UiDesignerAudioProcessor()
-#ifndef JucePlugin_PreferredChannelConfigurations
-     : AudioProcessor (BusesProperties()
-                     #if ! JucePlugin_IsMidiEffect
-                      #if ! JucePlugin_IsSynth
-                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
-                      #endif
-                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
-                     #endif
-                       )
-#endif
-{
-}
-
-UiDesignerAudioProcessor::~UiDesignerAudioProcessor()
-{
-}
-
-//==============================================================================
-const juce::String UiDesignerAudioProcessor::getName() const
-{
-    return JucePlugin_Name;
-}
-
-bool UiDesignerAudioProcessor::acceptsMidi() const
-{
-   #if JucePlugin_WantsMidiInput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool UiDesignerAudioProcessor::producesMidi() const
-{
-   #if JucePlugin_ProducesMidiOutput
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-bool UiDesignerAudioProcessor::isMidiEffect() const
-{
-   #if JucePlugin_IsMidiEffect
-    return true;
-   #else
-    return false;
-   #endif
-}
-
-double UiDesignerAudioProcessor::getTailLengthSeconds() const
-{
-    return 0.0;
-}
-
-int UiDesignerAudioProcessor::getNumPrograms()
-{
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
-}
-
-int UiDesignerAudioProcessor::getCurrentProgram()
-{
-    return 0;
-}
-
-void UiDesignerAudioProcessor::setCurrentProgram (int index)
-{
-}
-
-const juce::String UiDesignerAudioProcessor::getProgramName (int index)
-{
-    return {};
-}
-
-void UiDesignerAudioProcessor::changeProgramName (int index, const juce::String& newName)
-{
-}
-
-//==============================================================================
-void UiDesignerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
-{
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
-}
-
-void UiDesignerAudioProcessor::releaseResources()
-{
-    // When playback stops, you can use this as an opportunity to free up any
-    // spare memory, etc.
-}
-
-#ifndef JucePlugin_PreferredChannelConfigurations
-bool UiDesignerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
-{
-  #if JucePlugin_IsMidiEffect
-    juce::ignoreUnused (layouts);
-    return true;
-  #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
-        return false;
-
-    // This checks if the input layout matches the output layout
-   #if ! JucePlugin_IsSynth
-    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
-        return false;
-   #endif
-
-    return true;
-  #endif
-}
-#endif
-
-void UiDesignerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
-{
-    juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
-
-    // In case we have more outputs than inputs, this code clears any output
-    // channels that didn't contain input data, (because these aren't
-    // guaranteed to be empty - they may contain garbage).
-    // This is here to avoid people getting screaming feedback
-    // when they first compile a plugin, but obviously you don't need to keep
-    // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
-
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
-    {
-        auto* channelData = buffer.getWritePointer (channel);
-
-        // ..do something to the data...
-    }
-}
-
-//==============================================================================
-bool UiDesignerAudioProcessor::hasEditor() const
-{
-    return true; // (change this to false if you choose to not supply an editor)
-}
-
-juce::AudioProcessorEditor* UiDesignerAudioProcessor::createEditor()
-{
-    return new UiDesignerAudioProcessorEditor (*this);
-}
-
-//==============================================================================
-void UiDesignerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
-{
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-}
-
-void UiDesignerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
-{
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-}
-
-//==============================================================================
-// This creates new instances of the plugin..
-juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
-{
-    return new UiDesignerAudioProcessor();
-}
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#include "PluginProcessor.h"
+#include "PluginEditor.h"
+#include "DocumentSerializer.h"
+
+//==============================================================================
+UiDesignerAudioProcessor::UiDesignerAudioProcessor()
+#ifndef JucePlugin_PreferredChannelConfigurations
+     : AudioProcessor (BusesProperties()
+                     #if ! JucePlugin_IsMidiEffect
+                      #if ! JucePlugin_IsSynth
+                       .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                      #endif
+                       .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
+                     #endif
+                       )
+#endif
+{
+}
+
+UiDesignerAudioProcessor::~UiDesignerAudioProcessor()
+{
+}
+
+//==============================================================================
+const juce::String UiDesignerAudioProcessor::getName() const
+{
+    return JucePlugin_Name;
+}
+
+bool UiDesignerAudioProcessor::acceptsMidi() const
+{
+   #if JucePlugin_WantsMidiInput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool UiDesignerAudioProcessor::producesMidi() const
+{
+   #if JucePlugin_ProducesMidiOutput
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+bool UiDesignerAudioProcessor::isMidiEffect() const
+{
+   #if JucePlugin_IsMidiEffect
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+double UiDesignerAudioProcessor::getTailLengthSeconds() const
+{
+    return 0.0;
+}
+
+int UiDesignerAudioProcessor::getNumPrograms()
+{
+    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+                // so this should be at least 1, even if you're not really implementing programs.
+}
+
+int UiDesignerAudioProcessor::getCurrentProgram()
+{
+    return 0;
+}
+
+void UiDesignerAudioProcessor::setCurrentProgram (int index)
+{
+}
+
+const juce::String UiDesignerAudioProcessor::getProgramName (int index)
+{
+    return {};
+}
+
+void UiDesignerAudioProcessor::changeProgramName (int index, const juce::String& newName)
+{
+}
+
+//==============================================================================
+void UiDesignerAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
+{
+    // Short ramps so dragging the level doesn't click
+    level.reset (sampleRate, 0.02);
+    level.setCurrentAndTargetValue (parameterBindings.getValue (ParameterBindings::levelParameter));
+    audioAnalyser.prepare (sampleRate);
+}
+
+void UiDesignerAudioProcessor::releaseResources()
+{
+    // When playback stops, you can use this as an opportunity to free up any
+    // spare memory, etc.
+}
+
+#ifndef JucePlugin_PreferredChannelConfigurations
+bool UiDesignerAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+  #if JucePlugin_IsMidiEffect
+    juce::ignoreUnused (layouts);
+    return true;
+  #else
+    // This is the place where you check if the layout is supported.
+    // In this template code we only support mono or stereo.
+    // Some plugin hosts, such as certain GarageBand versions, will only
+    // load plugins that support stereo bus layouts.
+    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
+     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+        return false;
+
+    // This checks if the input layout matches the output layout
+   #if ! JucePlugin_IsSynth
+    if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
+        return false;
+   #endif
+
+    return true;
+  #endif
+}
+#endif
+
+void UiDesignerAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    juce::ScopedNoDenormals noDenormals;
+    auto totalNumInputChannels  = getTotalNumInputChannels();
+    auto totalNumOutputChannels = getTotalNumOutputChannels();
+
+    // In case we have more outputs than inputs, this code clears any output
+    // channels that didn't contain input data, (because these aren't
+    // guaranteed to be empty - they may contain garbage).
+    // This is here to avoid people getting screaming feedback
+    // when they first compile a plugin, but obviously you don't need to keep
+    // this code if your algorithm always overwrites all the output channels.
+    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+        buffer.clear (i, 0, buffer.getNumSamples());
+
+    // The level parameter is read from its atomic, whoever moved it last
+    // (a control on the canvas or host automation). No locks, no allocation.
+    level.setTargetValue (parameterBindings.getValue (ParameterBindings::levelParameter));
+
+    const auto startGain = level.getCurrentValue();
+    level.skip (buffer.getNumSamples());
+    const auto endGain = level.getCurrentValue();
+
+    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+        buffer.applyGainRamp (channel, 0, buffer.getNumSamples(), startGain, endGain);
+
+    // Only hands results to the editor through FIFOs, see AudioAnalyser
+    audioAnalyser.process (buffer, totalNumOutputChannels);
+}
+
+//==============================================================================
+bool UiDesignerAudioProcessor::hasEditor() const
+{
+    return true; // (change this to false if you choose to not supply an editor)
+}
+
+juce::AudioProcessorEditor* UiDesignerAudioProcessor::createEditor()
+{
+    // The editor measures how long it takes from here to its first frame
+    const auto openStartTicks = juce::Time::getHighResolutionTicks();
+    return new UiDesignerAudioProcessorEditor (*this, openStartTicks);
+}
+
+//==============================================================================
+void UiDesignerAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    juce::XmlElement state ("UIDESIGNER_STATE");
+
+    {
+        // Hosts may save from any thread while the editor is busy, so this only
+        // ever sees a finished version of the document and never waits for it
+        DocumentHandoff::ScopedReader reader (documentHandoff);
+
+        if (auto* document = reader.get())
+            state.addChildElement (DocumentSerializer::toXml (*document).release());
+    }
+
+    auto* parameters = state.createNewChildElement ("PARAMETERS");
+
+    for (int i = 0; i < ParameterBindings::numParameters; ++i)
+        parameters->setAttribute (parameterBindings.getParameter (i).getParameterID(), parameterBindings.getValue (i));
+
+    copyXmlToBinary (state, destData);
+}
+
+void UiDesignerAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    auto xml = getXmlFromBinary (data, sizeInBytes);
+
+    if (xml == nullptr || ! xml->hasTagName ("UIDESIGNER_STATE"))
+        return;
+
+    if (auto* parameters = xml->getChildByName ("PARAMETERS"))
+    {
+        for (int i = 0; i < ParameterBindings::numParameters; ++i)
+        {
+            auto& parameter = parameterBindings.getParameter (i);
+
+            if (parameters->hasAttribute (parameter.getParameterID()))
+                parameter.setValueNotifyingHost ((float) parameters->getDoubleAttribute (parameter.getParameterID()));
+        }
+    }
+
+    if (auto* documentXml = xml->getChildByName ("UIDESIGNER_DOCUMENT"))
+    {
+        if (auto document = DocumentSerializer::fromXml (*documentXml))
+        {
+            documentHandoff.publish (document);
+
+            // The document an editor hasn't taken yet is swapped out and
+            // freed after the lock, which can take a while for a big one
+            {
+                const juce::SpinLock::ScopedLockType sl (restoredDocumentLock);
+                std::swap (restoredDocument, document);
+            }
+
+            document = nullptr;
+
+            documentRestored.sendChangeMessage();
+        }
+    }
+}
+
+std::shared_ptr<const DocumentSnapshot> UiDesignerAudioProcessor::takeRestoredDocument()
+{
+    const juce::SpinLock::ScopedLockType sl (restoredDocumentLock);
+    return std::move (restoredDocument);
+}
+
+//==============================================================================
+// This creates new instances of the plugin..
+juce::AudioProcessor* JUCE_CALLTYPE createPluginFilter()
+{
+    return new UiDesignerAudioProcessor();
+}
@@ -1,59 +1,93 @@
-/*
-  ==============================================================================
-
-    This file contains the basic framework code for a JUCE plugin processor.
-
-  ==============================================================================
-*/
-
-#pragma once
-
-#include <JuceHeader.h>
-
-//==============================================================================
-/**
-*/
-class UiDesignerAudioProcessor  : public juce::AudioProcessor
-{
-public:
-    //==============================================================================
-    UiDesignerAudioProcessor();
-    ~UiDesignerAudioProcessor() override;
-
-    //==============================================================================
-    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
-    void releaseResources() override;
-
-   #ifndef JucePlugin_PreferredChannelConfigurations
-    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
-   #endif
-
-    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
-
-    //==============================================================================
-    juce::AudioProcessorEditor* createEditor() override;
-    bool hasEditor() const override;
-
-    //==============================================================================
-    const juce::String getName() const override;
-
-    bool acceptsMidi() const override;
-    bool producesMidi() const override;
-    bool isMidiEffect() const override;
-    double getTailLengthSeconds() const override;
-
-    //==============================================================================
-    int getNumPrograms() override;
-    int getCurrentProgram() override;
-    void setCurrentProgram (int index) override;
-    const juce::String getProgramName (int index) override;
-    void changeProgramName (int index, const juce::String& newName) override;
-
-    //==============================================================================
-    void getStateInformation (juce::MemoryBlock& destData) override;
-    void setStateInformation (const void* data, int sizeInBytes) override;
-
-private:
-    //==============================================================================
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UiDesignerAudioProcessor)
-};
+/*
+  ==============================================================================
+
+    This file contains the basic framework code for a JUCE plugin processor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AudioAnalyser.h"
+#include "DocumentHandoff.h"
+#include "MainComponent.h"
+#include "ParameterBindings.h"
+
+//==============================================================================
+/**
+*/
+class UiDesignerAudioProcessor  : public juce::AudioProcessor
+{
+public:
+    //==============================================================================
+    UiDesignerAudioProcessor();
+    ~UiDesignerAudioProcessor() override;
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override;
+    void releaseResources() override;
+
+   #ifndef JucePlugin_PreferredChannelConfigurations
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
+   #endif
+
+    void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override;
+    bool hasEditor() const override;
+
+    //==============================================================================
+    const juce::String getName() const override;
+
+    bool acceptsMidi() const override;
+    bool producesMidi() const override;
+    bool isMidiEffect() const override;
+    double getTailLengthSeconds() const override;
+
+    //==============================================================================
+    int getNumPrograms() override;
+    int getCurrentProgram() override;
+    void setCurrentProgram (int index) override;
+    const juce::String getProgramName (int index) override;
+    void changeProgramName (int index, const juce::String& newName) override;
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock& destData) override;
+    void setStateInformation (const void* data, int sizeInBytes) override;
+
+    //==============================================================================
+    // The editor publishes each finished version of the document here
+    DocumentHandoff& getDocumentHandoff() { return documentHandoff; }
+
+    // The parameters shapes on the canvas can be bound to
+    ParameterBindings& getParameterBindings() { return parameterBindings; }
+
+    // Feeds the meter, scope and spectrum shapes
+    AudioAnalyser& getAudioAnalyser() { return audioAnalyser; }
+
+    // Notifies the editor when the host has restored a different document.
+    // The editor takes that document from here rather than from the handoff,
+    // where one of its own versions may have been published in the meantime.
+    juce::ChangeBroadcaster& getDocumentRestoredBroadcaster() { return documentRestored; }
+    std::shared_ptr<const DocumentSnapshot> takeRestoredDocument();
+
+    // Kept between the editor closing and the next one opening
+    void storeEditorState (std::unique_ptr<MainComponent::EditorState> state) { editorState = std::move (state); }
+    std::unique_ptr<MainComponent::EditorState> takeEditorState() { return std::move (editorState); }
+
+private:
+    //==============================================================================
+    ParameterBindings parameterBindings { *this };
+    juce::LinearSmoothedValue<float> level;
+    AudioAnalyser audioAnalyser;
+
+    DocumentHandoff documentHandoff;
+    juce::ChangeBroadcaster documentRestored;
+    juce::SpinLock restoredDocumentLock;
+    std::shared_ptr<const DocumentSnapshot> restoredDocument;
+    std::unique_ptr<MainComponent::EditorState> editorState;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UiDesignerAudioProcessor)
+};
@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    ProgressiveRenderer.cpp
+    Created: 18 Oct 2026 3:22:51pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "ProgressiveRenderer.h"
+#include "TraceRecorder.h"
+
+bool ProgressiveRenderer::matchesView(juce::Rectangle<int> bounds, float viewScale,
+                                      juce::Point<int> viewOffset, float newPixelScale) const
+{
+    return hasPass
+        && bounds == viewBounds
+        && viewScale == scale
+        && viewOffset == offset
+        && newPixelScale == pixelScale;
+}
+
+bool ProgressiveRenderer::pan(juce::Rectangle<int> bounds, float viewScale,
+                              juce::Point<int> viewOffset, float newPixelScale)
+{
+    if (!hasPass || bounds != viewBounds || viewScale != scale || newPixelScale != pixelScale)
+        return false;
+
+    const auto shift = (viewOffset - offset).toFloat() * pixelScale;
+    const auto pixelShift = shift.roundToInt();
+
+    if (shift.getDistanceFrom(pixelShift.toFloat()) > 0.001f)
+        return false;
+
+    const auto imageBounds = accumulated.getBounds();
+    const auto keptArea = imageBounds.getIntersection(imageBounds.translated(pixelShift.x, pixelShift.y));
+
+    if (keptArea.isEmpty())
+        return false;
+
+    UIDESIGNER_TRACE_SCOPE("ProgressiveRenderer::pan");
+
+    accumulated.moveImageSection(keptArea.getX(), keptArea.getY(),
+                                 keptArea.getX() - pixelShift.x, keptArea.getY() - pixelShift.y,
+                                 keptArea.getWidth(), keptArea.getHeight());
+    offset = viewOffset;
+
+    // What came into view is cleared and redrawn from the live document
+    // once the pass is complete, and in the meantime by the remaining slices
+    juce::RectangleList<int> exposedAreas(imageBounds);
+    exposedAreas.subtract(keptArea);
+
+    const auto imageToDocument = getImageTransform().inverted();
+
+    for (auto& area : exposedAreas)
+    {
+        accumulated.clear(area);
+        changedAreas.add(area.toFloat().transformedBy(imageToDocument));
+    }
+
+    return true;
+}
+
+void ProgressiveRenderer::start(std::shared_ptr<const RenderSource> newSource, juce::Rectangle<int> bounds,
+                                float viewScale, juce::Point<int> viewOffset, float newPixelScale)
+{
+    source = std::move(newSource);
+    viewBounds = bounds;
+    scale = viewScale;
+    offset = viewOffset;
+    pixelScale = newPixelScale;
+
+    const int width = juce::jmax(1, juce::roundToInt(bounds.getWidth() * pixelScale));
+    const int height = juce::jmax(1, juce::roundToInt(bounds.getHeight() * pixelScale));
+
+    // Reuse the images when the size hasn't changed
+    if (accumulated.getWidth() != width || accumulated.getHeight() != height)
+    {
+        accumulated = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+        layer = juce::Image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    }
+    else
+    {
+        accumulated.clear(accumulated.getBounds());
+    }
+
+    hasPass = true;
+    nextItem = source->getNumItems();
+    numSlices = 0;
+    changedAreas.clear();
+}
+
+bool ProgressiveRenderer::renderNextSlice(double budgetMs)
+{
+    if (!hasPass || nextItem == 0)
+        return false;
+
+    UIDESIGNER_TRACE_SCOPE("ProgressiveRenderer::renderNextSlice");
+
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
+    const int end = nextItem;
+    const int begin = juce::jmax(0, end - itemsPerSlice);
+
+    // Render the slice on its own layer...
+    layer.clear(layer.getBounds());
+    {
+        const RasterTarget target { layer, getImageTransform() };
+
+        juce::Graphics g(layer);
+        g.addTransform(target.documentToImage);
+        source->renderRange(g, scale, arena, begin, end, &target);
+    }
+
+    // ...and put everything in front of it on top. The images swap roles,
+    // so the layer becomes the new accumulated image without a copy.
+    if (end != source->getNumItems())
+    {
+        juce::Graphics g(layer);
+        g.drawImageAt(accumulated, 0, 0);
+    }
+
+    std::swap(accumulated, layer);
+    arena.reset();
+
+    nextItem = begin;
+    ++numSlices;
+
+    // Aim the next slice at the budget based on how long this one took
+    lastSliceMs = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks) * 1000.0;
+    const double itemsPerMs = (end - begin) / juce::jmax(0.01, lastSliceMs);
+    itemsPerSlice = juce::jlimit(minItemsPerSlice, maxItemsPerSlice, (int) (itemsPerMs * budgetMs));
+
+    return true;
+}
+
+void ProgressiveRenderer::invalidate(juce::Rectangle<float> documentArea)
+{
+    if (hasPass && !documentArea.isEmpty())
+        changedAreas.add(documentArea);
+}
+
+void ProgressiveRenderer::draw(juce::Graphics& g, RenderClient& client)
+{
+    if (!hasPass)
+        return;
+
+    if (isComplete() && !changedAreas.isEmpty())
+    {
+        UIDESIGNER_TRACE_SCOPE("ProgressiveRenderer::redrawChangedAreas");
+
+        const auto transform = getImageTransform();
+
+        for (auto& area : changedAreas)
+        {
+            // One extra pixel around the area for anti-aliasing
+            auto pixelArea = area.transformedBy(transform).getSmallestIntegerContainer().expanded(1)
+                                 .getIntersection(accumulated.getBounds());
+
+            if (pixelArea.isEmpty())
+                continue;
+
+            accumulated.clear(pixelArea);
+
+            juce::Graphics imageGraphics(accumulated);
+            imageGraphics.reduceClipRegion(pixelArea);
+            imageGraphics.addTransform(transform);
+            client.renderDocument(imageGraphics, scale);
+        }
+
+        changedAreas.clear();
+    }
+
+    g.drawImageTransformed(accumulated, juce::AffineTransform::scale(1.0f / pixelScale)
+                                            .translated(viewBounds.getPosition().toFloat()));
+}
+
+ProgressiveRenderer::Statistics ProgressiveRenderer::getStatistics() const
+{
+    Statistics stats;
+    stats.itemsTotal = source != nullptr ? source->getNumItems() : 0;
+    stats.itemsDone = stats.itemsTotal - nextItem;
+    stats.slices = numSlices;
+    stats.lastSliceMs = lastSliceMs;
+    stats.complete = isComplete();
+    return stats;
+}
+
+juce::AffineTransform ProgressiveRenderer::getImageTransform() const
+{
+    // Document coordinates to pixels in the image
+    return juce::AffineTransform::scale(scale)
+               .translated(offset.toFloat() - viewBounds.getPosition().toFloat())
+               .scaled(pixelScale);
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ProgressiveRenderer.h
+    Created: 18 Oct 2026 3:22:51pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// ProgressiveRenderer.h
+#pragma once
+#include <JuceHeader.h>
+#include "RenderSource.h"
+
+// Renders the whole view into an offscreen image in short time slices, so
+// that a huge document never blocks the message thread for long.
+//
+// Items are processed front to back: each slice renders the next range of
+// items further back into a layer and puts the image so far on top of it.
+// The front-most content therefore appears first and the image refines until
+// everything is in. Slices are run by the owner, typically once per vblank,
+// and input is handled in between.
+//
+// A running pass draws from a snapshot. Edits made meanwhile are collected
+// and redrawn from the live document once the pass is complete. Panning
+// keeps the pass: the image is moved along and only the strips that come
+// into view are redrawn, the same way as edited areas.
+class ProgressiveRenderer
+{
+public:
+    struct Statistics
+    {
+        int itemsDone = 0;
+        int itemsTotal = 0;
+        int slices = 0;
+        double lastSliceMs = 0.0;
+        bool complete = false;
+    };
+
+    ProgressiveRenderer() = default;
+
+    // True if the current pass was started for this view
+    bool matchesView(juce::Rectangle<int> bounds, float viewScale, juce::Point<int> viewOffset, float pixelScale) const;
+
+    // Moves the current pass to a new offset if nothing else about the view
+    // changed and the move is by whole pixels. Returns false if the view
+    // needs a new pass.
+    bool pan(juce::Rectangle<int> bounds, float viewScale, juce::Point<int> viewOffset, float pixelScale);
+
+    // Starts a new pass, dropping the current image
+    void start(std::shared_ptr<const RenderSource> source, juce::Rectangle<int> bounds,
+               float viewScale, juce::Point<int> viewOffset, float pixelScale);
+
+    // Forces a new pass the next time the owner checks matchesView()
+    void restart() { hasPass = false; }
+
+    // Renders for about budgetMs. Returns true if the image changed.
+    bool renderNextSlice(double budgetMs);
+
+    bool isComplete() const { return hasPass && nextItem == 0; }
+
+    // Marks an area, in document coordinates, as changed since the snapshot
+    void invalidate(juce::Rectangle<float> documentArea);
+
+    // Draws the image in component coordinates. Once the pass is complete,
+    // changed areas are redrawn from the live document first.
+    void draw(juce::Graphics& g, RenderClient& client);
+
+    Statistics getStatistics() const;
+
+private:
+    juce::AffineTransform getImageTransform() const;
+
+    static constexpr int minItemsPerSlice = 16;
+    static constexpr int maxItemsPerSlice = 1 << 16;
+
+    bool hasPass = false;
+    std::shared_ptr<const RenderSource> source;
+    juce::Rectangle<int> viewBounds;
+    float scale = 1.0f;
+    juce::Point<int> offset;
+    float pixelScale = 1.0f;
+
+    juce::Image accumulated;    // everything in front of nextItem
+    juce::Image layer;          // scratch image for the next slice
+    int nextItem = 0;           // items below this index are still to do
+    int itemsPerSlice = 256;    // adapted to the time budget as slices run
+    int numSlices = 0;
+    double lastSliceMs = 0.0;
+
+    juce::RectangleList<float> changedAreas;
+    FrameArena arena;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ProgressiveRenderer)
+};
@@ -0,0 +1,449 @@
+/*
+  ==============================================================================
+
+    RectRasterizer.cpp
+    Created: 19 Oct 2026 1:17:52am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "RectRasterizer.h"
+
+#if UIDESIGNER_USE_SSE2
+ #include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Whole pixels for both 3 and 4 byte formats, and three SSE registers
+    constexpr int patternBytes = 48;
+
+    void fillBytes(juce::uint8* dest, size_t numBytes, const juce::uint8* pattern, bool useSse2)
+    {
+        size_t i = 0;
+
+       #if UIDESIGNER_USE_SSE2
+        if (useSse2)
+        {
+            const auto p0 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern));
+            const auto p1 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 16));
+            const auto p2 = _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 32));
+
+            for (; i + patternBytes <= numBytes; i += patternBytes)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), p0);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 16), p1);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 32), p2);
+            }
+        }
+       #else
+        juce::ignoreUnused(useSse2);
+       #endif
+
+        for (; i < numBytes; ++i)
+            dest[i] = pattern[i % patternBytes];
+    }
+
+    // dest = source + dest * inverseAlpha / 256 for every byte, the same as
+    // JUCE's PixelARGB::blend() and PixelRGB::blend() with a premultiplied source
+    void blendBytes(juce::uint8* dest, size_t numBytes, const juce::uint8* pattern, juce::uint32 inverseAlpha, bool useSse2)
+    {
+        size_t i = 0;
+
+       #if UIDESIGNER_USE_SSE2
+        if (useSse2)
+        {
+            const auto zero = _mm_setzero_si128();
+            const auto factor = _mm_set1_epi16((short) inverseAlpha);
+            const __m128i source[3] = { _mm_load_si128(reinterpret_cast<const __m128i*>(pattern)),
+                                        _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 16)),
+                                        _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 32)) };
+
+            for (; i + patternBytes <= numBytes; i += patternBytes)
+            {
+                for (int k = 0; k < 3; ++k)
+                {
+                    auto* address = reinterpret_cast<__m128i*>(dest + i + 16 * k);
+                    const auto d = _mm_loadu_si128(address);
+                    const auto low = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), factor), 8);
+                    const auto high = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), factor), 8);
+                    _mm_storeu_si128(address, _mm_adds_epu8(_mm_packus_epi16(low, high), source[k]));
+                }
+            }
+        }
+       #else
+        juce::ignoreUnused(useSse2);
+       #endif
+
+        for (; i < numBytes; ++i)
+            dest[i] = (juce::uint8) juce::jmin(255u, (juce::uint32) pattern[i % patternBytes] + ((dest[i] * inverseAlpha) >> 8));
+    }
+}
+
+RectRasterizer::RectRasterizer(const RasterTarget& target)
+    : image(target.image),
+      pixels(image, juce::Image::BitmapData::readWrite),
+      transform(target.documentToImage),
+      pixelsPerUnit(std::sqrt(std::abs(target.documentToImage.getDeterminant()))),
+      hasAlpha(image.getFormat() == juce::Image::ARGB)
+{
+    jassert(canDrawInto(image));
+    jassert(transform.mat01 == 0.0f && transform.mat10 == 0.0f);
+}
+
+bool RectRasterizer::canDrawInto(const juce::Image& target)
+{
+    const auto format = target.getFormat();
+    return (format == juce::Image::RGB || format == juce::Image::ARGB)
+           && dynamic_cast<juce::SoftwareImageType*>(target.createType().get()) != nullptr;
+}
+
+void RectRasterizer::fillRectangle(juce::Rectangle<float> area, float cornerRadius, juce::Colour colour)
+{
+    fillRegion(toPixels(area, cornerRadius), {}, colour);
+}
+
+void RectRasterizer::strokeRectangle(juce::Rectangle<float> area, float cornerRadius, float strokeWidth, juce::Colour colour)
+{
+    // Like Path::addRoundedRectangle(), which the stroke would otherwise follow
+    cornerRadius = juce::jmin(cornerRadius, area.getWidth() * 0.5f, area.getHeight() * 0.5f);
+
+    // Mitered corners stay square on the outside
+    const float halfWidth = strokeWidth * 0.5f;
+    const auto outer = toPixels(area.expanded(halfWidth), cornerRadius > 0.0f ? cornerRadius + halfWidth : 0.0f);
+
+    RoundedRect inner;
+    if (area.getWidth() > strokeWidth && area.getHeight() > strokeWidth)
+        inner = toPixels(area.reduced(halfWidth), juce::jmax(0.0f, cornerRadius - halfWidth));
+
+    fillRegion(outer, inner, colour);
+}
+
+RectRasterizer::RoundedRect RectRasterizer::toPixels(juce::Rectangle<float> area, float cornerRadius) const
+{
+    RoundedRect result;
+    result.area = area.transformedBy(transform);
+    result.radius = juce::jlimit(0.0f, juce::jmin(result.area.getWidth(), result.area.getHeight()) * 0.5f,
+                                 cornerRadius * pixelsPerUnit);
+    return result;
+}
+
+float RectRasterizer::getEdgeCoverage(float start, float end, int pixel)
+{
+    return juce::jlimit(0.0f, 1.0f, juce::jmin(end, (float) pixel + 1.0f) - juce::jmax(start, (float) pixel));
+}
+
+float RectRasterizer::getCoverage(const RoundedRect& shape, int x, int y)
+{
+    const auto& area = shape.area;
+    float coverage = getEdgeCoverage(area.getX(), area.getRight(), x) * getEdgeCoverage(area.getY(), area.getBottom(), y);
+
+    if (shape.radius > 0.0f && coverage > 0.0f)
+    {
+        // In a corner, the distance from the pixel centre to the circle
+        const float centreX = (float) x + 0.5f;
+        const float centreY = (float) y + 0.5f;
+        const float circleX = juce::jlimit(area.getX() + shape.radius, area.getRight() - shape.radius, centreX);
+        const float circleY = juce::jlimit(area.getY() + shape.radius, area.getBottom() - shape.radius, centreY);
+
+        if (circleX != centreX && circleY != centreY)
+        {
+            const float distance = std::hypot(centreX - circleX, centreY - circleY);
+            coverage = juce::jmin(coverage, juce::jlimit(0.0f, 1.0f, shape.radius + 0.5f - distance));
+        }
+    }
+
+    return coverage;
+}
+
+RectRasterizer::Span RectRasterizer::getSolidSpan(const RoundedRect& shape, int y)
+{
+    // The pixels of the row whose coverage is that of the row itself, i.e.
+    // away from the left and right edges and outside the corner arcs
+    const auto& area = shape.area;
+    const float coverage = getEdgeCoverage(area.getY(), area.getBottom(), y);
+
+    if (coverage <= 0.0f)
+        return {};
+
+    float inset = 0.0f;
+
+    if (shape.radius > 0.0f)
+    {
+        const float centreY = (float) y + 0.5f;
+        const float dy = juce::jmax(area.getY() + shape.radius - centreY, centreY - (area.getBottom() - shape.radius), 0.0f);
+
+        if (dy > 0.0f)
+        {
+            const float solidRadius = shape.radius - 0.5f;
+            inset = dy < solidRadius ? shape.radius - std::sqrt(solidRadius * solidRadius - dy * dy) : shape.radius;
+        }
+    }
+
+    const int start = (int) std::ceil(area.getX() + inset);
+    const int end = (int) std::floor(area.getRight() - inset);
+
+    if (end <= start)
+        return {};
+
+    return { start, end, coverage };
+}
+
+void RectRasterizer::fillRegion(const RoundedRect& outer, const RoundedRect& inner, juce::Colour colour)
+{
+    const auto bounds = outer.area.getSmallestIntegerContainer().getIntersection({ pixels.width, pixels.height });
+    const bool hasInner = !inner.area.isEmpty();
+    const auto innerBounds = inner.area.getSmallestIntegerContainer();
+
+    for (int y = bounds.getY(); y < bounds.getBottom(); ++y)
+    {
+        // Runs of uniform coverage, in order: the outer span left of the
+        // inner shape, the difference where both are solid, and the outer
+        // span right of it. Everything else is done pixel by pixel.
+        Span runs[3];
+        int numRuns = 0;
+
+        const auto addRun = [&](int start, int end, float coverage)
+        {
+            if (end > start)
+                runs[numRuns++] = { start, end, coverage };
+        };
+
+        const auto outerSpan = getSolidSpan(outer, y);
+
+        if (hasInner && y >= innerBounds.getY() && y < innerBounds.getBottom())
+        {
+            const auto innerSpan = getSolidSpan(inner, y);
+            addRun(outerSpan.start, juce::jmin(outerSpan.end, innerBounds.getX()), outerSpan.coverage);
+
+            if (innerSpan.end > innerSpan.start)
+                addRun(juce::jmax(outerSpan.start, innerSpan.start), juce::jmin(outerSpan.end, innerSpan.end),
+                       outerSpan.coverage - innerSpan.coverage);
+
+            addRun(juce::jmax(outerSpan.start, innerBounds.getRight()), outerSpan.end, outerSpan.coverage);
+        }
+        else
+        {
+            addRun(outerSpan.start, outerSpan.end, outerSpan.coverage);
+        }
+
+        int x = bounds.getX();
+        int run = 0;
+
+        while (x < bounds.getRight())
+        {
+            while (run < numRuns && runs[run].end <= x)
+                ++run;
+
+            if (run < numRuns && runs[run].start <= x)
+            {
+                const int end = juce::jmin(runs[run].end, bounds.getRight());
+                blendSpan(y, x, end, colour, runs[run].coverage);
+                x = end;
+                continue;
+            }
+
+            const int next = run < numRuns ? juce::jmin(runs[run].start, bounds.getRight()) : bounds.getRight();
+
+            for (; x < next; ++x)
+            {
+                const float coverage = getCoverage(outer, x, y) - (hasInner ? getCoverage(inner, x, y) : 0.0f);
+
+                if (coverage > 0.0f)
+                    blendPixel(x, y, colour, coverage);
+            }
+        }
+    }
+}
+
+void RectRasterizer::blendSpan(int y, int start, int end, juce::Colour colour, float coverage)
+{
+    const int alpha = juce::roundToInt(colour.getFloatAlpha() * coverage * 255.0f);
+
+    if (alpha <= 0 || end <= start)
+        return;
+
+    // One colour and coverage for the whole span, so every byte is blended
+    // the same way and the pattern only depends on the pixel format
+    const auto source = colour.withAlpha((juce::uint8) juce::jmin(alpha, 255)).getPixelARGB();
+    alignas(16) juce::uint8 pattern[patternBytes];
+
+    for (int i = 0; i < patternBytes; i += pixels.pixelStride)
+    {
+        if (hasAlpha)
+            reinterpret_cast<juce::PixelARGB*>(pattern + i)->set(source);
+        else
+            reinterpret_cast<juce::PixelRGB*>(pattern + i)->set(source);
+    }
+
+    auto* dest = pixels.getPixelPointer(start, y);
+    const auto numBytes = (size_t) (end - start) * (size_t) pixels.pixelStride;
+
+    if (alpha >= 255)
+        fillBytes(dest, numBytes, pattern, useSse2);
+    else
+        blendBytes(dest, numBytes, pattern, 0x100u - source.getAlpha(), useSse2);
+}
+
+void RectRasterizer::blendPixel(int x, int y, juce::Colour colour, float coverage)
+{
+    const int alpha = juce::roundToInt(colour.getFloatAlpha() * coverage * 255.0f);
+
+    if (alpha <= 0)
+        return;
+
+    const auto source = colour.withAlpha((juce::uint8) juce::jmin(alpha, 255)).getPixelARGB();
+    auto* dest = pixels.getPixelPointer(x, y);
+
+    if (hasAlpha)
+        reinterpret_cast<juce::PixelARGB*>(dest)->blend(source);
+    else
+        reinterpret_cast<juce::PixelRGB*>(dest)->blend(source);
+}
+
+#if JUCE_UNIT_TESTS
+
+// Draws random rectangles into two equal images, once with the rasterizer and
+// once through a Graphics context, and compares them byte by byte
+class RectRasterizerTests : public juce::UnitTest
+{
+public:
+    RectRasterizerTests() : juce::UnitTest("RectRasterizer", "UiDesigner") {}
+
+    void runTest() override
+    {
+        for (auto format : { juce::Image::RGB, juce::Image::ARGB })
+        {
+            const juce::String formatName = format == juce::Image::RGB ? "RGB" : "ARGB";
+
+            beginTest(formatName + ", plain loops");
+            compareWithGraphics(format, false);
+
+           #if UIDESIGNER_USE_SSE2
+            beginTest(formatName + ", SSE2");
+            compareWithGraphics(format, true);
+           #endif
+        }
+    }
+
+private:
+    static constexpr int imageSize = 64;    // wide enough for spans of whole SSE2 patterns
+    static constexpr int numShapes = 250;
+
+    // Per byte, out of 255. Straight edges only differ by rounding. Along
+    // rounded corners JUCE flattens the arcs, which the distance to the
+    // circle doesn't, so anti-aliased pixels there may differ by more.
+    static constexpr int maxStraightDifference = 3;
+    static constexpr int maxRoundedDifference = 26;
+
+    void compareWithGraphics(juce::Image::PixelFormat format, bool useSse2)
+    {
+        auto& random = getRandom();
+        int worstStraight = 0;
+        int worstRounded = 0;
+
+        for (int i = 0; i < numShapes; ++i)
+        {
+            const bool isStroke = random.nextBool();
+            const bool isRounded = random.nextBool();
+
+            const auto transform = juce::AffineTransform::scale(0.5f + random.nextFloat() * 2.5f)
+                                       .translated(random.nextFloat() * 8.0f - 4.0f, random.nextFloat() * 8.0f - 4.0f);
+
+            // Chosen in pixels, some of them partly outside the image
+            const auto pixelArea = juce::Rectangle<float>(random.nextFloat() * 64.0f - 8.0f, random.nextFloat() * 64.0f - 8.0f,
+                                                          1.0f + random.nextFloat() * 48.0f, 1.0f + random.nextFloat() * 48.0f);
+            const auto area = pixelArea.transformedBy(transform.inverted());
+
+            const float cornerRadius = isRounded ? random.nextFloat() * 0.6f * juce::jmin(area.getWidth(), area.getHeight()) : 0.0f;
+            const float strokeWidth = 0.25f + random.nextFloat() * 5.0f;
+            const auto colour = juce::Colour((juce::uint32) random.nextInt()).withAlpha(random.nextBool() ? 1.0f : 0.1f + random.nextFloat() * 0.9f);
+            const auto background = juce::Colour((juce::uint32) random.nextInt())
+                                        .withAlpha(format == juce::Image::RGB ? 1.0f : random.nextFloat());
+
+            auto expected = createImage(format, background);
+            {
+                juce::Graphics g(expected);
+                g.addTransform(transform);
+                g.setColour(colour);
+
+                if (isStroke)
+                {
+                    juce::Path outline;
+                    outline.addRoundedRectangle(area, cornerRadius);
+                    g.strokePath(outline, juce::PathStrokeType(strokeWidth, juce::PathStrokeType::mitered));
+                }
+                else if (isRounded)
+                {
+                    g.fillRoundedRectangle(area, cornerRadius);
+                }
+                else
+                {
+                    g.fillRect(area);
+                }
+            }
+
+            auto actual = createImage(format, background);
+            {
+                RectRasterizer rasterizer({ actual, transform });
+                rasterizer.useSse2 = useSse2;
+
+                if (isStroke)
+                    rasterizer.strokeRectangle(area, cornerRadius, strokeWidth, colour);
+                else
+                    rasterizer.fillRectangle(area, cornerRadius, colour);
+            }
+
+            const int difference = getMaxDifference(expected, actual);
+            auto& worst = isRounded ? worstRounded : worstStraight;
+            worst = juce::jmax(worst, difference);
+
+            expectLessOrEqual(difference, isRounded ? maxRoundedDifference : maxStraightDifference,
+                              juce::String(isStroke ? "stroke " : "fill ") + pixelArea.toString()
+                                  + ", radius " + juce::String(cornerRadius) + ", width " + juce::String(strokeWidth));
+        }
+
+        logMessage("Largest difference: " + juce::String(worstStraight) + " straight, "
+                   + juce::String(worstRounded) + " rounded");
+    }
+
+    static juce::Image createImage(juce::Image::PixelFormat format, juce::Colour background)
+    {
+        juce::Image image(format, imageSize, imageSize, true, juce::SoftwareImageType());
+        juce::Graphics(image).fillAll(background);
+        return image;
+    }
+
+    static int getMaxDifference(const juce::Image& first, const juce::Image& second)
+    {
+        const juce::Image::BitmapData a(first, juce::Image::BitmapData::readOnly);
+        const juce::Image::BitmapData b(second, juce::Image::BitmapData::readOnly);
+        int result = 0;
+
+        for (int y = 0; y < a.height; ++y)
+        {
+            for (int x = 0; x < a.width; ++x)
+            {
+                const auto* p = a.getPixelPointer(x, y);
+                const auto* q = b.getPixelPointer(x, y);
+
+                for (int i = 0; i < a.pixelStride; ++i)
+                    result = juce::jmax(result, std::abs((int) p[i] - (int) q[i]));
+            }
+        }
+
+        return result;
+    }
+};
+
+static RectRasterizerTests rectRasterizerTests;
+
+#endif
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    RenderSource.h
+    Created: 18 Oct 2026 3:22:51pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// RenderSource.h
+#pragma once
+#include <JuceHeader.h>
+#include "FrameArena.h"
+#include "RectRasterizer.h"
+
+// Something that draws the document into a Graphics context that is already
+// set up in document coordinates. Instances handed to background threads or
+// kept across frames are snapshots and must never change afterwards.
+class RenderSource
+{
+public:
+    virtual ~RenderSource() = default;
+
+    // Number of items in z-order
+    virtual int getNumItems() const = 0;
+
+    // Draws the items in [begin, end), back to front. When g renders into an
+    // offscreen software image, passing it as the target lets simple shapes
+    // be written to its pixels directly.
+    virtual void renderRange(juce::Graphics& g, float viewScale, FrameArena& arena, int begin, int end,
+                             const RasterTarget* target = nullptr) const = 0;
+
+    void render(juce::Graphics& g, float viewScale, FrameArena& arena, const RasterTarget* target = nullptr) const
+    {
+        renderRange(g, viewScale, arena, 0, getNumItems(), target);
+    }
+};
+
+// Implemented by the owner of the live document, which the renderers draw from
+class RenderClient
+{
+public:
+    virtual ~RenderClient() = default;
+
+    // Renders the current document on the message thread
+    virtual void renderDocument(juce::Graphics& g, float viewScale) = 0;
+
+    // Returns an immutable copy of the document
+    virtual std::shared_ptr<const RenderSource> getDocumentSnapshot() = 0;
+};
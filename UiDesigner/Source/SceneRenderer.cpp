@@ -0,0 +1,1051 @@
+/*
+  ==============================================================================
+
+    SceneRenderer.cpp
+    Created: 18 Oct 2026 11:04:12am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "SceneRenderer.h"
+
+SceneRenderer::SceneRenderer(juce::Graphics& graphics, FrameArena& frameArena, float pixelsPerUnit,
+                             const SymbolLibrary* symbolLibrary, const RasterTarget* target)
+    : g(graphics), arena(frameArena), viewScale(pixelsPerUnit), symbols(symbolLibrary)
+{
+    if (target != nullptr && RectRasterizer::canDrawInto(target->image))
+        rasterizer.emplace(*target);
+}
+
+void SceneRenderer::drawShapes(const Shape* const* shapes, int numShapes)
+{
+    auto* visibility = arena.allocateArray<Visibility>((size_t) numShapes);
+    findVisibleShapes(shapes, numShapes, visibility);
+
+    for (int i = 0; i < numShapes; ++i)
+    {
+        const auto& shape = *shapes[i];
+
+        if (visibility[i] == Visibility::Culled)
+        {
+            ++stats.shapesCulled;
+            continue;
+        }
+
+        if (visibility[i] == Visibility::Occluded)
+        {
+            ++stats.shapesOccluded;
+            continue;
+        }
+
+        ++stats.shapesDrawn;
+
+        if (shape.type == Tool::Instance)
+        {
+            flushBatch();
+            drawInstance(shape);
+            continue;
+        }
+
+        if (shape.type == Tool::Image)
+        {
+            flushBatch();
+            drawImage(shape);
+            continue;
+        }
+
+        auto state = getShapeState(shape);
+
+        if (state.isDot || state.isGreeked)
+            ++stats.shapesSimplified;
+
+        if (canRasterize(shape, state))
+        {
+            flushBatch();
+            rasterizeShape(shape, state);
+        }
+        else if (isBatchable(shape, state))
+        {
+            if (batch.numShapes > 0
+                && (!matchesBatch(state) || overlapsBatchStrokes(shape) || batch.numShapes == maxBatchSize))
+                flushBatch();
+
+            addToBatch(shape, state);
+        }
+        else
+        {
+            // Keep the z-order: everything merged so far goes below this shape
+            flushBatch();
+            drawShape(shape, state);
+        }
+    }
+
+    flushBatch();
+}
+
+juce::Rectangle<float> SceneRenderer::getDrawnBounds(const Shape& shape) const
+{
+    return shape.type == Tool::Instance && symbols != nullptr ? symbols->getDrawnBounds(shape)
+                                                              : shape.getDrawnBounds();
+}
+
+juce::Rectangle<float> SceneRenderer::getOccludingArea(const Shape& shape) const
+{
+    const bool drawnAsRectangle = shape.type == Tool::Rectangle || shape.type == Tool::Meter
+                                  || shape.type == Tool::Scope || shape.type == Tool::Spectrum;
+
+    if (!drawnAsRectangle || !shape.style->hasFill || !shape.style->fillColour.isOpaque())
+        return {};
+
+    // Quarter turns keep the rectangle axis-aligned
+    const float quarterTurns = shape.rotation / juce::MathConstants<float>::halfPi;
+
+    if (std::abs(quarterTurns - std::round(quarterTurns)) > 1.0e-4f)
+        return {};
+
+    auto area = getFillArea(shape);
+
+    if (std::max(area.getWidth(), area.getHeight()) * viewScale < minVisibleShapePixels)
+        return {};
+
+    // Only the part inside the rounded corners, less the anti-aliased pixel
+    // along the edges, is covered for sure
+    return area.reduced(shape.style->cornerRadius + 1.0f / viewScale);
+}
+
+void SceneRenderer::findVisibleShapes(const Shape* const* shapes, int numShapes, Visibility* visibility) const
+{
+    const auto clip = g.getClipBounds().toFloat();
+    juce::Rectangle<float> occluders[maxOccluders];
+    int numOccluders = 0;
+
+    for (int i = numShapes; --i >= 0;)
+    {
+        const auto& shape = *shapes[i];
+        const auto drawnBounds = getDrawnBounds(shape);
+
+        // Skip shapes that lie completely outside the area being repainted
+        if (!g.clipRegionIntersects(drawnBounds.getSmallestIntegerContainer()))
+        {
+            visibility[i] = Visibility::Culled;
+            continue;
+        }
+
+        const auto visibleArea = drawnBounds.getIntersection(clip);
+        bool isCovered = false;
+
+        for (int j = 0; j < numOccluders && !isCovered; ++j)
+            isCovered = occluders[j].contains(visibleArea);
+
+        visibility[i] = isCovered ? Visibility::Occluded : Visibility::Visible;
+
+        if (isCovered)
+            continue;
+
+        const auto occludingArea = getOccludingArea(shape).getIntersection(clip);
+
+        if (occludingArea.isEmpty())
+            continue;
+
+        if (numOccluders < maxOccluders)
+        {
+            occluders[numOccluders++] = occludingArea;
+            continue;
+        }
+
+        // Too many, keep the larger ones
+        auto* smallest = std::min_element(occluders, occluders + maxOccluders, [](const auto& a, const auto& b)
+        {
+            return a.getWidth() * a.getHeight() < b.getWidth() * b.getHeight();
+        });
+
+        if (smallest->getWidth() * smallest->getHeight() < occludingArea.getWidth() * occludingArea.getHeight())
+            *smallest = occludingArea;
+    }
+}
+
+void SceneRenderer::drawShape(const Shape& shape)
+{
+    if (shape.type == Tool::Instance)
+        drawInstance(shape);
+    else if (shape.type == Tool::Image)
+        drawImage(shape);
+    else
+        drawShape(shape, getShapeState(shape));
+}
+
+void SceneRenderer::drawShape(const Shape& shape, const ShapeState& state)
+{
+    if (state.isDot)
+    {
+        g.setColour(state.fillColour);
+        g.fillRect(getDotBounds(shape));
+        ++stats.drawCalls;
+        return;
+    }
+
+    // Rotated shapes and stretched text change the transform, which is put
+    // back by restoring the saved state. Undoing it with the inverse would
+    // leave the context on its slower, fully transformed path for the rest
+    // of the frame, and add up rounding errors.
+    const bool stretchesText = shape.type == Tool::Text && shape.style->textStretchEnabled && !state.isGreeked;
+    std::optional<juce::Graphics::ScopedSaveState> stateSave;
+
+    if (shape.rotation != 0.0f || stretchesText)
+        stateSave.emplace(g);
+
+    if (shape.rotation != 0.0f)
+        g.addTransform(juce::AffineTransform::rotation(shape.rotation, shape.rotationCenter.x, shape.rotationCenter.y));
+
+    if (state.isGreeked)
+    {
+        g.setColour(state.fillColour);
+        g.fillRect(getGreekingBar(shape));
+        ++stats.drawCalls;
+    }
+    else
+    {
+        // Dashes that would blur together on screen are drawn as a solid stroke
+        Style style = *shape.style;
+        if (!areDashesVisible(style.strokePattern))
+            style.strokePattern = StrokePattern::Solid;
+
+        switch (shape.type)
+        {
+            case Tool::Rectangle:
+            case Tool::Meter:
+            case Tool::Scope:
+            case Tool::Spectrum:
+                drawRectangle(shape.bounds, style);
+                break;
+            case Tool::Ellipse:
+                drawEllipse(shape.bounds, style);
+                break;
+            case Tool::Line:
+                drawLine(shape.lineStart, shape.lineEnd, style);
+                break;
+            case Tool::Freehand:
+            {
+                FrameArena::ScopedPath curve(arena);
+                shape.addFreehandCurve(curve);
+                drawFreehand(curve, style);
+                break;
+            }
+            case Tool::Text:
+                shape.drawText(g);
+                ++stats.drawCalls;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+void SceneRenderer::drawInstance(const Shape& instance)
+{
+    const auto* symbol = symbols != nullptr ? symbols->getSymbol(instance.symbolId) : nullptr;
+
+    if (symbol == nullptr)
+        return;
+
+    UIDESIGNER_TRACE_SCOPE("SceneRenderer::drawInstance");
+
+    const auto transform = SymbolLibrary::getInstanceTransform(instance, *symbol);
+    const float instanceScale = std::sqrt(std::abs(transform.getDeterminant()));
+
+    // The context's scale factor covers the view and the display, so this is
+    // the resolution the instance ends up at on screen
+    const float pixelsPerUnit = g.getInternalContext().getPhysicalPixelScaleFactor() * instanceScale;
+
+    std::optional<juce::Colour> fillOverride;
+    if (instance.style->hasFill)
+        fillOverride = instance.style->fillColour;
+
+    if (auto cached = symbol->getImage(pixelsPerUnit, fillOverride); cached.image.isValid())
+    {
+        g.drawImageTransformed(cached.image, juce::AffineTransform::scale(1.0f / cached.scale)
+                                                 .translated(symbol->drawnArea.getPosition())
+                                                 .followedBy(transform));
+        ++stats.drawCalls;
+    }
+    else
+    {
+        juce::Graphics::ScopedSaveState stateSave(g);
+        g.addTransform(transform);
+
+        // Zoomed in too far for the image, draw the master's shapes instead.
+        // The symbol keeps the recoloured copies, so they aren't made per frame.
+        const auto filledShapes = fillOverride ? symbol->getShapesWithFill(*fillOverride) : nullptr;
+        const auto& masterShapes = filledShapes != nullptr ? *filledShapes : symbol->shapes;
+        auto** drawList = arena.allocateArray<const Shape*>((size_t) masterShapes.size());
+
+        for (int i = 0; i < masterShapes.size(); ++i)
+            drawList[i] = &masterShapes.getReference(i);
+
+        SceneRenderer masterRenderer(g, arena, viewScale * instanceScale);
+        masterRenderer.drawShapes(drawList, masterShapes.size());
+        stats.drawCalls += masterRenderer.getStatistics().drawCalls;
+    }
+}
+
+void SceneRenderer::drawImage(const Shape& shape)
+{
+    auto* library = ImageLibrary::getInstance();
+
+    // The context's scale factor covers the view and the display, so this is
+    // the size the image ends up at on screen
+    const float pixelsPerUnit = g.getInternalContext().getPhysicalPixelScaleFactor();
+    const auto image = library->getImage(shape.imageFile, shape.bounds.getWidth() * pixelsPerUnit,
+                                         shape.bounds.getHeight() * pixelsPerUnit);
+
+    // The rotation goes into the geometry, the context's transform is left alone
+    const auto rotation = juce::AffineTransform::rotation(shape.rotation,
+                                                          shape.rotationCenter.x,
+                                                          shape.rotationCenter.y);
+
+    if (image.isValid())
+    {
+        // Images are drawn with the opacity of the current colour
+        g.setOpacity(1.0f);
+        g.drawImageTransformed(image, juce::AffineTransform::scale(shape.bounds.getWidth() / (float) image.getWidth(),
+                                                                   shape.bounds.getHeight() / (float) image.getHeight())
+                                          .translated(shape.bounds.getPosition())
+                                          .followedBy(rotation));
+    }
+    else
+    {
+        // Placeholder while decoding, crossed out if the file can't be read
+        g.setColour(juce::Colours::lightgrey);
+
+        if (shape.rotation != 0.0f)
+        {
+            FrameArena::ScopedPath outline(arena);
+            outline->addRectangle(shape.bounds);
+            g.fillPath(outline, rotation);
+        }
+        else
+        {
+            g.fillRect(shape.bounds);
+        }
+
+        if (library->getStatus(shape.imageFile) == ImageLibrary::Status::Failed)
+        {
+            const float lineWidth = 1.0f / viewScale;
+            g.setColour(juce::Colours::grey);
+            g.drawLine({ shape.bounds.getTopLeft().transformedBy(rotation),
+                         shape.bounds.getBottomRight().transformedBy(rotation) }, lineWidth);
+            g.drawLine({ shape.bounds.getTopRight().transformedBy(rotation),
+                         shape.bounds.getBottomLeft().transformedBy(rotation) }, lineWidth);
+        }
+    }
+
+    ++stats.drawCalls;
+}
+
+void SceneRenderer::drawRectangle(const juce::Rectangle<float>& bounds, const Style& style)
+{
+    if (style.hasFill)
+    {
+        g.setColour(style.fillColour);
+
+        if (style.cornerRadius > 0.0f)
+        {
+            // Graphics::fillRoundedRectangle() would build a new path
+            FrameArena::ScopedPath outline(arena);
+            outline->addRoundedRectangle(bounds, style.cornerRadius);
+            g.fillPath(outline);
+        }
+        else
+        {
+            g.fillRect(bounds);
+        }
+
+        ++stats.drawCalls;
+    }
+
+    if (style.strokeWidth > 0.0f && style.strokePattern == StrokePattern::Solid)
+    {
+        FrameArena::ScopedPath outline(arena);
+        addRectangleStroke(outline, bounds, style.cornerRadius, style.strokeWidth);
+        g.setColour(style.strokeColour);
+        g.fillPath(outline);
+        ++stats.drawCalls;
+    }
+    else if (style.strokeWidth > 0.0f)
+    {
+        drawStrokedPath(style, [&](juce::Path& path)
+        {
+            if (style.cornerRadius > 0.0f)
+                path.addRoundedRectangle(bounds, style.cornerRadius);
+            else
+                path.addRectangle(bounds);
+        });
+    }
+}
+
+void SceneRenderer::drawEllipse(const juce::Rectangle<float>& bounds, const Style& style)
+{
+    if (style.hasFill)
+    {
+        g.setColour(style.fillColour);
+        g.fillEllipse(bounds);
+        ++stats.drawCalls;
+    }
+
+    if (style.strokeWidth > 0.0f)
+    {
+        drawStrokedPath(style, [&](juce::Path& path)
+        {
+            path.addEllipse(bounds);
+        });
+    }
+}
+
+void SceneRenderer::drawLine(juce::Point<float> lineStart, juce::Point<float> lineEnd, const Style& style)
+{
+    Style lineStyle = style;
+    lineStyle.strokeWidth = std::max(1.0f, style.strokeWidth);
+
+    if (style.strokePattern == StrokePattern::Solid && lineStart != lineEnd)
+    {
+        FrameArena::ScopedPath outline(arena);
+        addLineStroke(outline, lineStart, lineEnd, lineStyle.strokeWidth);
+        g.setColour(style.strokeColour);
+        g.fillPath(outline);
+        ++stats.drawCalls;
+        return;
+    }
+
+    drawStrokedPath(lineStyle, [&](juce::Path& path)
+    {
+        path.startNewSubPath(lineStart);
+        path.lineTo(lineEnd);
+    });
+}
+
+void SceneRenderer::drawFreehand(const juce::Path& curve, const Style& style)
+{
+    Style curveStyle = style;
+    curveStyle.strokeWidth = std::max(1.0f, style.strokeWidth);
+
+    // Mitered joins would spike wherever the hand turned sharply
+    strokePath(curve, curveStyle, juce::PathStrokeType::curved, juce::PathStrokeType::rounded);
+}
+
+void SceneRenderer::addFreehandOutline(juce::Path& outline, const juce::Path& curve, const Style& style)
+{
+    // The pieces meet with round caps on either side, which is what a round
+    // join would have drawn there. They all run the same way, so their
+    // outlines overlap with the same winding and fill as one.
+    juce::Path pieceOutline;
+    juce::PathStrokeType(std::max(1.0f, style.strokeWidth), juce::PathStrokeType::curved, juce::PathStrokeType::rounded)
+        .createStrokedPath(pieceOutline, curve);
+    outline.addPath(pieceOutline);
+}
+
+void SceneRenderer::fillFreehandOutline(const juce::Path& outline, const Style& style)
+{
+    g.setColour(style.strokeColour);
+    g.fillPath(outline);
+    ++stats.drawCalls;
+}
+
+// Runs the other way round from Path::addRoundedRectangle(), which goes
+// clockwise from the top edge
+static void addReversedRoundedRectangle(juce::Path& path, juce::Rectangle<float> area, float radius)
+{
+    radius = juce::jmin(radius, area.getWidth() * 0.5f, area.getHeight() * 0.5f);
+
+    if (radius <= 0.0f)
+    {
+        path.startNewSubPath(area.getTopLeft());
+        path.lineTo(area.getBottomLeft());
+        path.lineTo(area.getBottomRight());
+        path.lineTo(area.getTopRight());
+        path.closeSubPath();
+        return;
+    }
+
+    const float left = area.getX() + radius;
+    const float right = area.getRight() - radius;
+    const float top = area.getY() + radius;
+    const float bottom = area.getBottom() - radius;
+    constexpr float quarterTurn = juce::MathConstants<float>::halfPi;
+
+    // Arc angles run clockwise from 12 o'clock, so these go anticlockwise.
+    // Each arc is joined to the end of the previous one by a straight line.
+    path.startNewSubPath(right, area.getY());
+    path.addCentredArc(left, top, radius, radius, 0.0f, 0.0f, -quarterTurn);
+    path.addCentredArc(left, bottom, radius, radius, 0.0f, -quarterTurn, -2.0f * quarterTurn);
+    path.addCentredArc(right, bottom, radius, radius, 0.0f, -2.0f * quarterTurn, -3.0f * quarterTurn);
+    path.addCentredArc(right, top, radius, radius, 0.0f, -3.0f * quarterTurn, -4.0f * quarterTurn);
+    path.closeSubPath();
+}
+
+void SceneRenderer::addRectangleStroke(juce::Path& path, juce::Rectangle<float> area, float cornerRadius, float strokeWidth)
+{
+    const float halfWidth = strokeWidth * 0.5f;
+
+    // Rounded corners grow and shrink with the edges. Mitered square corners
+    // stay square on both sides, and so does the inside of a corner that's
+    // rounded less than half the stroke width.
+    if (cornerRadius > 0.0f)
+        path.addRoundedRectangle(area.expanded(halfWidth), cornerRadius + halfWidth);
+    else
+        path.addRectangle(area.expanded(halfWidth));
+
+    const auto inner = area.reduced(halfWidth);
+
+    // A stroke wider than the rectangle covers all of it
+    if (!inner.isEmpty())
+        addReversedRoundedRectangle(path, inner, cornerRadius - halfWidth);
+}
+
+void SceneRenderer::addLineStroke(juce::Path& path, juce::Point<float> lineStart, juce::Point<float> lineEnd,
+                                  float strokeWidth)
+{
+    // Square caps reach half the stroke width past either end
+    const auto line = juce::Line<float>(lineStart, lineEnd);
+    const float halfWidth = strokeWidth * 0.5f;
+    const auto extension = (lineEnd - lineStart) * (halfWidth / line.getLength());
+
+    path.addLineSegment({ lineStart - extension, lineEnd + extension }, strokeWidth);
+}
+
+bool SceneRenderer::shapeFills(const Shape& shape)
+{
+    // Lines and freehand strokes ignore the fill setting
+    return !MainComponent::isOpenPath(shape.type) && shape.style->hasFill;
+}
+
+bool SceneRenderer::shapeStrokes(const Shape& shape)
+{
+    return MainComponent::isOpenPath(shape.type) || shape.style->strokeWidth > 0.0f;
+}
+
+float SceneRenderer::getStrokeWidth(const Shape& shape)
+{
+    return MainComponent::isOpenPath(shape.type) ? std::max(1.0f, shape.style->strokeWidth) : shape.style->strokeWidth;
+}
+
+juce::Rectangle<float> SceneRenderer::getFillArea(const Shape& shape)
+{
+    if (shape.rotation == 0.0f)
+        return shape.bounds;
+
+    return shape.bounds.transformedBy(juce::AffineTransform::rotation(shape.rotation,
+                                                                      shape.rotationCenter.x,
+                                                                      shape.rotationCenter.y));
+}
+
+juce::Rectangle<float> SceneRenderer::getStrokeArea(const Shape& shape)
+{
+    // Square caps and right-angled mitered corners stay within half the
+    // stroke width of the outline
+    auto area = shape.type == Tool::Line ? juce::Rectangle<float>(shape.lineStart, shape.lineEnd) : shape.bounds;
+    area = area.expanded(getStrokeWidth(shape) * 0.5f);
+
+    if (shape.rotation != 0.0f)
+        area = area.transformedBy(juce::AffineTransform::rotation(shape.rotation,
+                                                                  shape.rotationCenter.x,
+                                                                  shape.rotationCenter.y));
+    return area;
+}
+
+SceneRenderer::ShapeState SceneRenderer::getShapeState(const Shape& shape) const
+{
+    ShapeState state;
+
+    // The stroke area is the tightest box around everything the shape touches
+    auto area = getStrokeArea(shape);
+
+    if (std::max(area.getWidth(), area.getHeight()) * viewScale < minVisibleShapePixels)
+    {
+        state.isDot = true;
+        state.fills = true;
+        state.fillColour = shapeFills(shape) || shape.type == Tool::Text ? shape.style->fillColour
+                                                                         : shape.style->strokeColour;
+        return state;
+    }
+
+    if (shape.type == Tool::Text)
+    {
+        state.isGreeked = shape.bounds.getHeight() * viewScale < minReadableTextPixels;
+        state.fills = true;
+        state.fillColour = shape.style->fillColour;
+        return state;
+    }
+
+    state.style = shape.style.get();
+    state.fills = shapeFills(shape);
+    state.strokes = shapeStrokes(shape);
+    state.fillColour = shape.style->fillColour;
+    state.strokeColour = shape.style->strokeColour;
+    state.strokeWidth = getStrokeWidth(shape);
+    state.solidStroke = shape.style->strokePattern == StrokePattern::Solid || !areDashesVisible(shape.style->strokePattern);
+    return state;
+}
+
+bool SceneRenderer::areDashesVisible(StrokePattern pattern) const
+{
+    // Shortest gap of each pattern, see drawStrokedPath()
+    const float smallestGap = pattern == StrokePattern::Dotted ? 4.0f : 6.0f;
+    return pattern == StrokePattern::Solid || smallestGap * viewScale >= minVisibleDashGapPixels;
+}
+
+bool SceneRenderer::isBatchable(const Shape& shape, const ShapeState& state)
+{
+    // Text has no outline, and freehand strokes need round joins
+    if ((shape.type == Tool::Text || shape.type == Tool::Freehand) && !state.isDot && !state.isGreeked)
+        return false;
+
+    // Overlapping translucent shapes blend with each other, which a merged
+    // path can't reproduce
+    if (state.fills && !state.fillColour.isOpaque())
+        return false;
+
+    if (state.strokes && (!state.strokeColour.isOpaque() || !state.solidStroke))
+        return false;
+
+    return state.fills || state.strokes;
+}
+
+bool SceneRenderer::canRasterize(const Shape& shape, const ShapeState& state) const
+{
+    const bool drawnAsRectangle = shape.type == Tool::Rectangle || shape.type == Tool::Meter
+                                  || shape.type == Tool::Scope || shape.type == Tool::Spectrum;
+
+    return rasterizer.has_value() && drawnAsRectangle && shape.rotation == 0.0f
+           && !state.isDot && state.solidStroke && (state.fills || state.strokes);
+}
+
+void SceneRenderer::rasterizeShape(const Shape& shape, const ShapeState& state)
+{
+    const float cornerRadius = shape.style->cornerRadius;
+
+    if (state.fills)
+    {
+        rasterizer->fillRectangle(shape.bounds, cornerRadius, state.fillColour);
+        ++stats.drawCalls;
+    }
+
+    if (state.strokes)
+    {
+        rasterizer->strokeRectangle(shape.bounds, cornerRadius, state.strokeWidth, state.strokeColour);
+        ++stats.drawCalls;
+    }
+}
+
+juce::Rectangle<float> SceneRenderer::getDotBounds(const Shape& shape) const
+{
+    // One pixel on screen, already in rotated document coordinates
+    const float size = 1.0f / viewScale;
+    return juce::Rectangle<float>(size, size).withCentre(getStrokeArea(shape).getCentre());
+}
+
+juce::Rectangle<float> SceneRenderer::getGreekingBar(const Shape& shape)
+{
+    // A bar roughly the height of the lowercase letters
+    return shape.bounds.withSizeKeepingCentre(shape.bounds.getWidth(), shape.bounds.getHeight() * 0.4f);
+}
+
+void SceneRenderer::addOutline(juce::Path& path, const Shape& shape, const ShapeState& state) const
+{
+    if (state.isDot)
+    {
+        path.addRectangle(getDotBounds(shape));
+        return;
+    }
+
+    if (state.isGreeked)
+    {
+        path.addRectangle(getGreekingBar(shape));
+        return;
+    }
+
+    switch (shape.type)
+    {
+        case Tool::Rectangle:
+        case Tool::Meter:
+        case Tool::Scope:
+        case Tool::Spectrum:
+            if (shape.style->cornerRadius > 0.0f)
+                path.addRoundedRectangle(shape.bounds, shape.style->cornerRadius);
+            else
+                path.addRectangle(shape.bounds);
+            break;
+        case Tool::Ellipse:
+            path.addEllipse(shape.bounds);
+            break;
+        case Tool::Line:
+            path.startNewSubPath(shape.lineStart);
+            path.lineTo(shape.lineEnd);
+            break;
+        default:
+            break;
+    }
+}
+
+bool SceneRenderer::canOutlineStroke(const Shape& shape)
+{
+    switch (shape.type)
+    {
+        case Tool::Rectangle:
+        case Tool::Meter:
+        case Tool::Scope:
+        case Tool::Spectrum:
+            return true;
+        case Tool::Line:
+            return shape.lineStart != shape.lineEnd;
+        default:
+            return false;
+    }
+}
+
+void SceneRenderer::addStrokeOutline(juce::Path& path, const Shape& shape, float strokeWidth)
+{
+    if (shape.type == Tool::Line)
+        addLineStroke(path, shape.lineStart, shape.lineEnd, strokeWidth);
+    else
+        addRectangleStroke(path, shape.bounds, shape.style->cornerRadius, strokeWidth);
+}
+
+bool SceneRenderer::matchesBatch(const ShapeState& state) const
+{
+    const auto& batchState = batch.state;
+
+    if (state.fills != batchState.fills || state.strokes != batchState.strokes)
+        return false;
+
+    // Shapes sharing a style entry have the same colours, only the stroke
+    // width can still differ since lines widen thin strokes
+    if (state.style != nullptr && state.style == batchState.style)
+        return !state.strokes || state.strokeWidth == batchState.strokeWidth;
+
+    if (batchState.fills && state.fillColour != batchState.fillColour)
+        return false;
+
+    if (batchState.strokes && (state.strokeColour != batchState.strokeColour || state.strokeWidth != batchState.strokeWidth))
+        return false;
+
+    return true;
+}
+
+bool SceneRenderer::overlapsBatchStrokes(const Shape& shape) const
+{
+    // Fills and strokes of one colour each commute among themselves, only a
+    // fill landing on an earlier stroke changes the result
+    if (!batch.state.fills || !batch.state.strokes)
+        return false;
+
+    auto fillArea = getFillArea(shape);
+
+    for (int i = 0; i < batch.numShapes; ++i)
+        if (fillArea.intersects(batch.strokeAreas[i]))
+            return true;
+
+    return false;
+}
+
+void SceneRenderer::addToBatch(const Shape& shape, const ShapeState& state)
+{
+    if (batch.numShapes == 0)
+    {
+        // Released in reverse order by flushBatch()
+        batch.fillPath = &arena.acquirePath();
+        batch.strokePath = &arena.acquirePath();
+        batch.strokeOutline = &arena.acquirePath();
+        batch.outline = &arena.acquirePath();
+        batch.firstShape = &shape;
+        batch.state = state;
+        batch.strokeAreas = arena.allocateArray<juce::Rectangle<float>>(maxBatchSize);
+    }
+
+    // The outline goes into both paths; rotated shapes are transformed on the
+    // way in, which leaves the stroke unchanged since rotations keep lengths.
+    // Dots are placed in rotated coordinates already. One scratch outline is
+    // reused for every shape in the batch.
+    auto* outline = batch.outline;
+    outline->clear();
+    addOutline(*outline, shape, state);
+
+    const auto rotation = shape.rotation != 0.0f && !state.isDot
+        ? juce::AffineTransform::rotation(shape.rotation, shape.rotationCenter.x, shape.rotationCenter.y)
+        : juce::AffineTransform();
+
+    if (state.fills)
+        batch.fillPath->addPath(*outline, rotation);
+
+    if (state.strokes && canOutlineStroke(shape))
+    {
+        outline->clear();
+        addStrokeOutline(*outline, shape, state.strokeWidth);
+        batch.strokeOutline->addPath(*outline, rotation);
+    }
+    else if (state.strokes)
+    {
+        batch.strokePath->addPath(*outline, rotation);
+    }
+
+    batch.strokeAreas[batch.numShapes++] = getStrokeArea(shape);
+}
+
+void SceneRenderer::flushBatch()
+{
+    if (batch.numShapes == 0)
+        return;
+
+    if (batch.numShapes == 1)
+    {
+        // A run of one gains nothing from the merged path, and the direct
+        // fillRect/fillEllipse calls are cheaper than filling a path
+        drawShape(*batch.firstShape, batch.state);
+    }
+    else
+    {
+        UIDESIGNER_TRACE_SCOPE("flushBatch");
+
+        if (batch.state.fills)
+        {
+            g.setColour(batch.state.fillColour);
+            g.fillPath(*batch.fillPath);
+            ++stats.drawCalls;
+        }
+
+        if (batch.state.strokes)
+        {
+            g.setColour(batch.state.strokeColour);
+
+            if (!batch.strokeOutline->isEmpty())
+            {
+                g.fillPath(*batch.strokeOutline);
+                ++stats.drawCalls;
+            }
+
+            if (!batch.strokePath->isEmpty())
+            {
+                g.strokePath(*batch.strokePath, juce::PathStrokeType(batch.state.strokeWidth,
+                                                                     juce::PathStrokeType::mitered,
+                                                                     juce::PathStrokeType::square));
+                ++stats.drawCalls;
+            }
+        }
+
+        stats.shapesBatched += batch.numShapes;
+    }
+
+    arena.releasePath(*batch.outline);
+    arena.releasePath(*batch.strokeOutline);
+    arena.releasePath(*batch.strokePath);
+    arena.releasePath(*batch.fillPath);
+    batch = Batch();
+}
+
+// Same dash walk as juce::PathStrokeType::createDashedStroke, but it writes the
+// dash centre lines into a caller-supplied path so that its storage can be reused
+static void createDashCentreLines(juce::Path& destPath, const juce::Path& sourcePath,
+                                  const float* dashLengths, int numDashLengths)
+{
+    juce::PathFlatteningIterator it(sourcePath);
+
+    bool first = true;
+    int dashNum = 0;
+    float pos = 0.0f, lineLen = 0.0f, lineEndPos = 0.0f;
+    float dx = 0.0f, dy = 0.0f;
+
+    for (;;)
+    {
+        const bool isSolid = ((dashNum & 1) == 0);
+        const float dashLen = dashLengths[dashNum++ % numDashLengths];
+
+        jassert(dashLen > 0.0f);
+        pos += dashLen;
+
+        while (pos > lineEndPos)
+        {
+            if (!it.next())
+            {
+                if (isSolid && !first)
+                    destPath.lineTo(it.x2, it.y2);
+                return;
+            }
+
+            if (isSolid && !first)
+                destPath.lineTo(it.x1, it.y1);
+            else
+                destPath.startNewSubPath(it.x1, it.y1);
+
+            dx = it.x2 - it.x1;
+            dy = it.y2 - it.y1;
+            lineLen = std::hypot(dx, dy);
+            lineEndPos += lineLen;
+            first = it.closesSubPath;
+        }
+
+        const float alpha = (pos - (lineEndPos - lineLen)) / lineLen;
+
+        if (isSolid)
+            destPath.lineTo(it.x1 + dx * alpha, it.y1 + dy * alpha);
+        else
+            destPath.startNewSubPath(it.x1 + dx * alpha, it.y1 + dy * alpha);
+    }
+}
+
+template<typename PathFunction>
+void SceneRenderer::drawStrokedPath(const Style& style, PathFunction&& pathFunc)
+{
+    // Get the path from the lambda, in storage owned by the frame arena
+    FrameArena::ScopedPath path(arena);
+    pathFunc(path);
+
+    strokePath(path, style, juce::PathStrokeType::mitered, juce::PathStrokeType::square);
+}
+
+void SceneRenderer::strokePath(const juce::Path& path, const Style& style,
+                               juce::PathStrokeType::JointStyle jointStyle,
+                               juce::PathStrokeType::EndCapStyle endCapStyle)
+{
+    UIDESIGNER_TRACE_SCOPE("drawStrokedPath");
+
+    g.setColour(style.strokeColour);
+    ++stats.drawCalls;
+
+    if (style.strokePattern == StrokePattern::Solid)
+    {
+        juce::PathStrokeType strokeType(
+            style.strokeWidth,
+            jointStyle,
+            endCapStyle
+        );
+        g.strokePath(path, strokeType);
+    }
+    else
+    {
+        float dashLengths[6];
+        int numDashLengths;
+
+        // Scale dash lengths based on stroke width to maintain visible pattern
+        float scale = juce::jmax(1.0f, style.strokeWidth * 0.5f);
+        scale = 1.0f;
+
+        switch (style.strokePattern)
+        {
+            case StrokePattern::Dashed:
+                dashLengths[0] = 12.0f * scale;  // Dash length
+                dashLengths[1] = 6.0f * scale;   // Gap length
+                numDashLengths = 2;
+                break;
+
+            case StrokePattern::Dotted:
+                dashLengths[0] = 2.0f * scale;   // Dot length
+                dashLengths[1] = 4.0f * scale;   // Gap length
+                numDashLengths = 2;
+                break;
+
+            case StrokePattern::DashDot:
+                dashLengths[0] = 12.0f * scale;  // Dash length
+                dashLengths[1] = 6.0f * scale;   // Gap length
+                dashLengths[2] = 2.0f * scale;   // Dot length
+                dashLengths[3] = 6.0f * scale;   // Gap length
+                numDashLengths = 4;
+                break;
+
+            default:
+                numDashLengths = 0;
+                break;
+        }
+
+        juce::PathStrokeType strokeType(
+            style.strokeWidth * 0.5f,
+            jointStyle,
+            juce::PathStrokeType::butt   // End cap style
+        );
+
+        // Dash centre lines, then their outline (what createDashedStroke returns),
+        // both built in arena paths instead of fresh juce::Path objects
+        FrameArena::ScopedPath dashes(arena);
+        createDashCentreLines(dashes, path, dashLengths, numDashLengths);
+
+        FrameArena::ScopedPath dashedPath(arena);
+        strokeType.createStrokedPath(dashedPath, dashes);
+        g.strokePath(dashedPath, strokeType);
+    }
+}
+
+//==================================================================
+
+DocumentSnapshot::DocumentSnapshot(juce::Array<Shape> shapesToDraw, SymbolLibrary symbolLibrary)
+    : DocumentSnapshot(std::move(shapesToDraw), std::make_shared<const SymbolLibrary>(std::move(symbolLibrary)))
+{
+}
+
+DocumentSnapshot::DocumentSnapshot(juce::Array<Shape> shapesToDraw, std::shared_ptr<const SymbolLibrary> symbolLibrary)
+    : DocumentSnapshot(createChunks(std::move(shapesToDraw)), std::move(symbolLibrary))
+{
+}
+
+DocumentSnapshot::DocumentSnapshot(std::vector<std::shared_ptr<const Chunk>> shapeChunks,
+                                   std::shared_ptr<const SymbolLibrary> symbolLibrary)
+    : chunks(std::move(shapeChunks)),
+      numShapes(countShapes(chunks)),
+      symbols(std::move(symbolLibrary))
+{
+    jassert(symbols != nullptr);
+}
+
+std::vector<std::shared_ptr<const DocumentSnapshot::Chunk>> DocumentSnapshot::createChunks(juce::Array<Shape>&& shapes)
+{
+    std::vector<std::shared_ptr<const Chunk>> newChunks;
+    newChunks.reserve((size_t) ((shapes.size() + chunkSize - 1) / chunkSize));
+
+    for (int begin = 0; begin < shapes.size(); begin += chunkSize)
+    {
+        const int end = juce::jmin(shapes.size(), begin + chunkSize);
+        Chunk chunk;
+        chunk.ensureStorageAllocated(end - begin);
+
+        for (int i = begin; i < end; ++i)
+            chunk.add(std::move(shapes.getReference(i)));
+
+        newChunks.push_back(std::make_shared<const Chunk>(std::move(chunk)));
+    }
+
+    return newChunks;
+}
+
+int DocumentSnapshot::countShapes(const std::vector<std::shared_ptr<const Chunk>>& shapeChunks)
+{
+    int count = 0;
+
+    for (auto& chunk : shapeChunks)
+    {
+        // Shapes are found by index / chunkSize
+        jassert(count % chunkSize == 0);
+        count += chunk->size();
+    }
+
+    return count;
+}
+
+void DocumentSnapshot::renderRange(juce::Graphics& g, float viewScale, FrameArena& arena, int begin, int end,
+                                   const RasterTarget* target) const
+{
+    begin = juce::jlimit(0, numShapes, begin);
+    end = juce::jlimit(begin, numShapes, end);
+
+    auto** drawList = arena.allocateArray<const Shape*>((size_t) (end - begin));
+
+    for (int i = begin; i < end; ++i)
+        drawList[i - begin] = &getShape(i);
+
+    SceneRenderer renderer(g, arena, viewScale, symbols.get(), target);
+    renderer.drawShapes(drawList, end - begin);
+}
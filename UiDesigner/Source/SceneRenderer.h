@@ -0,0 +1,244 @@
+/*
+  ==============================================================================
+
+    SceneRenderer.h
+    Created: 18 Oct 2026 11:04:12am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// SceneRenderer.h
+#pragma once
+#include <JuceHeader.h>
+#include "ImageLibrary.h"
+#include "MainComponent.h"
+#include "RectRasterizer.h"
+#include "SymbolLibrary.h"
+
+// Draws shapes into a Graphics context for one paint call.
+//
+// drawShapes() walks the shapes in z-order and merges runs of consecutive
+// shapes that share the same opaque fill and solid stroke into one fill path
+// and one stroke path, so a grid of identical rectangles costs two Graphics
+// calls instead of two per shape. Shapes that can't be merged (text, dashed
+// strokes, translucent colours) end the current run and are drawn on their own.
+//
+// Solid strokes along rectangles and straight lines are filled from their
+// outline, which is worked out directly. Graphics::strokePath() would build
+// a new path and run juce::PathStrokeType, both of which allocate.
+//
+// viewScale is the number of pixels per document unit. When zoomed far out,
+// shapes smaller than a pixel are drawn as single-pixel dots, small text as
+// greeking bars and dashed strokes as solid ones, since none of that detail
+// would be visible anyway.
+//
+// Before drawing, a pass from front to back collects the opaque, axis-aligned
+// filled rectangles in the clip area and skips every shape whose visible part
+// lies within one of them, e.g. everything under a full-size panel.
+//
+// Given a raster target, unrotated rectangles with solid strokes are filled
+// and stroked straight into the target's pixels by a RectRasterizer instead
+// of going through the Graphics context.
+//
+// Image shapes are drawn from the ImageLibrary level closest to their size on
+// screen, or as a placeholder until the file has been decoded.
+//
+// Symbol instances are looked up in the library given to the constructor and
+// drawn from the symbol's cached image, or from its shapes when zoomed in too
+// far for the image.
+//
+// All temporaries come from the frame arena, so the renderer itself is cheap
+// to create on the stack in paint().
+class SceneRenderer
+{
+public:
+    using Shape = MainComponent::Shape;
+    using Style = MainComponent::Style;
+    using Tool = MainComponent::Tool;
+    using StrokePattern = MainComponent::StrokePattern;
+
+    struct Statistics
+    {
+        int shapesDrawn = 0;
+        int shapesCulled = 0;
+        int shapesOccluded = 0;   // hidden under an opaque rectangle in front
+        int shapesBatched = 0;    // drawn as part of a merged path
+        int shapesSimplified = 0; // drawn as a dot or greeking bar
+        int drawCalls = 0;        // fills and strokes issued to the Graphics context
+    };
+
+    // target must be the image g draws into, see RasterTarget
+    SceneRenderer(juce::Graphics& g, FrameArena& arena, float viewScale = 1.0f,
+                  const SymbolLibrary* symbolLibrary = nullptr, const RasterTarget* target = nullptr);
+
+    // Draws the shapes in the given order, skipping those outside the clip region
+    void drawShapes(const Shape* const* shapes, int numShapes);
+
+    // Draws a single shape with its rotation, without batching
+    void drawShape(const Shape& shape);
+
+    void drawRectangle(const juce::Rectangle<float>& bounds, const Style& style);
+    void drawEllipse(const juce::Rectangle<float>& bounds, const Style& style);
+    void drawLine(juce::Point<float> lineStart, juce::Point<float> lineEnd, const Style& style);
+    // Strokes a curve with round joins and caps, see StrokeSimplifier
+    void drawFreehand(const juce::Path& curve, const Style& style);
+
+    // The same for a curve that's drawn piece by piece: each piece's outline
+    // is added to one path, which is filled instead of stroking the curve.
+    // Only solid strokes can be split up like that, dashes would restart.
+    static bool canAddFreehandOutline(const Style& style) { return style.strokePattern == StrokePattern::Solid; }
+    static void addFreehandOutline(juce::Path& outline, const juce::Path& curve, const Style& style);
+    void fillFreehandOutline(const juce::Path& outline, const Style& style);
+
+    // Adds the outline of a solid, mitered stroke along the edge of a
+    // rectangle or rounded rectangle: the two edges half the stroke width
+    // out and in, the inner one running the other way round so it cuts a
+    // hole. Filling it matches strokePath() on the rectangle's own outline.
+    static void addRectangleStroke(juce::Path& path, juce::Rectangle<float> area, float cornerRadius, float strokeWidth);
+
+    const Statistics& getStatistics() const { return stats; }
+
+private:
+    // How a shape ends up on screen at the current zoom level
+    struct ShapeState
+    {
+        bool fills = false;
+        bool strokes = false;
+        juce::Colour fillColour;
+        juce::Colour strokeColour;
+        float strokeWidth = 0.0f;
+        bool solidStroke = true;
+        bool isDot = false;         // smaller than a pixel
+        bool isGreeked = false;     // text too small to read
+        const Style* style = nullptr;   // shared style entry, see StyleHandle
+    };
+
+    struct Batch
+    {
+        juce::Path* fillPath = nullptr;
+        juce::Path* strokePath = nullptr;       // centre lines, for PathStrokeType
+        juce::Path* strokeOutline = nullptr;    // strokes already outlined, see addStrokeOutline()
+        juce::Path* outline = nullptr;          // scratch space for each shape added
+        const Shape* firstShape = nullptr;
+        ShapeState state;
+
+        // Areas covered by the strokes of the shapes in the batch. The merged
+        // strokes are drawn after the merged fill, so a later fill must not
+        // overlap an earlier stroke.
+        juce::Rectangle<float>* strokeAreas = nullptr;
+        int numShapes = 0;
+    };
+
+    enum class Visibility : juce::uint8
+    {
+        Visible,
+        Culled,     // outside the clip region
+        Occluded
+    };
+
+    static constexpr int maxBatchSize = 256;
+    static constexpr int maxOccluders = 16;
+
+    // Below these sizes on screen, shapes and text are simplified
+    static constexpr float minVisibleShapePixels = 1.0f;
+    static constexpr float minReadableTextPixels = 5.0f;
+    static constexpr float minVisibleDashGapPixels = 1.5f;
+
+    static bool shapeFills(const Shape& shape);
+    static bool shapeStrokes(const Shape& shape);
+    static float getStrokeWidth(const Shape& shape);
+    static juce::Rectangle<float> getFillArea(const Shape& shape);
+    static juce::Rectangle<float> getStrokeArea(const Shape& shape);
+
+    juce::Rectangle<float> getDrawnBounds(const Shape& shape) const;
+    juce::Rectangle<float> getOccludingArea(const Shape& shape) const;
+    void findVisibleShapes(const Shape* const* shapes, int numShapes, Visibility* visibility) const;
+
+    ShapeState getShapeState(const Shape& shape) const;
+    bool areDashesVisible(StrokePattern pattern) const;
+    static bool isBatchable(const Shape& shape, const ShapeState& state);
+    bool canRasterize(const Shape& shape, const ShapeState& state) const;
+    void rasterizeShape(const Shape& shape, const ShapeState& state);
+    juce::Rectangle<float> getDotBounds(const Shape& shape) const;
+    static juce::Rectangle<float> getGreekingBar(const Shape& shape);
+    void addOutline(juce::Path& path, const Shape& shape, const ShapeState& state) const;
+    static bool canOutlineStroke(const Shape& shape);
+    static void addStrokeOutline(juce::Path& path, const Shape& shape, float strokeWidth);
+    static void addLineStroke(juce::Path& path, juce::Point<float> lineStart, juce::Point<float> lineEnd, float strokeWidth);
+
+    void drawShape(const Shape& shape, const ShapeState& state);
+    void drawInstance(const Shape& instance);
+    void drawImage(const Shape& shape);
+    bool matchesBatch(const ShapeState& state) const;
+    bool overlapsBatchStrokes(const Shape& shape) const;
+    void addToBatch(const Shape& shape, const ShapeState& state);
+    void flushBatch();
+
+    // pathFunc fills in the path to stroke, which is cleared beforehand
+    template<typename PathFunction>
+    void drawStrokedPath(const Style& style, PathFunction&& pathFunc);
+    void strokePath(const juce::Path& path, const Style& style,
+                    juce::PathStrokeType::JointStyle jointStyle,
+                    juce::PathStrokeType::EndCapStyle endCapStyle);
+
+    juce::Graphics& g;
+    FrameArena& arena;
+    const float viewScale;
+    const SymbolLibrary* const symbols;
+    std::optional<RectRasterizer> rasterizer;
+    Batch batch;
+    Statistics stats;
+
+    JUCE_DECLARE_NON_COPYABLE(SceneRenderer)
+};
+
+// Immutable copy of the document, for rendering away from the message thread
+// and for handing to the processor, see DocumentHandoff.
+//
+// The shapes are kept in stacking order, in chunks of chunkSize that are
+// shared between snapshots. A snapshot taken after a few shapes changed
+// only copies the chunks they're in, and the symbols are shared until they
+// change.
+class DocumentSnapshot : public RenderSource
+{
+public:
+    using Shape = MainComponent::Shape;
+    using Chunk = juce::Array<Shape>;
+
+    static constexpr int chunkSize = 64;
+
+    DocumentSnapshot(juce::Array<Shape> shapesToDraw, SymbolLibrary symbolLibrary);
+    DocumentSnapshot(juce::Array<Shape> shapesToDraw, std::shared_ptr<const SymbolLibrary> symbolLibrary);
+
+    // Every chunk but the last must hold chunkSize shapes
+    DocumentSnapshot(std::vector<std::shared_ptr<const Chunk>> shapeChunks, std::shared_ptr<const SymbolLibrary> symbolLibrary);
+
+    int getNumItems() const override { return numShapes; }
+    void renderRange(juce::Graphics& g, float viewScale, FrameArena& arena, int begin, int end,
+                     const RasterTarget* target = nullptr) const override;
+
+    int getNumShapes() const { return numShapes; }
+    const Shape& getShape(int index) const { return chunks[(size_t) (index / chunkSize)]->getReference(index % chunkSize); }
+    const std::vector<std::shared_ptr<const Chunk>>& getChunks() const { return chunks; }
+
+    const SymbolLibrary& getSymbols() const { return *symbols; }
+    const std::shared_ptr<const SymbolLibrary>& getSharedSymbols() const { return symbols; }
+
+private:
+    const std::vector<std::shared_ptr<const Chunk>> chunks;
+    const int numShapes;
+    const std::shared_ptr<const SymbolLibrary> symbols;
+
+    static std::vector<std::shared_ptr<const Chunk>> createChunks(juce::Array<Shape>&& shapes);
+    static int countShapes(const std::vector<std::shared_ptr<const Chunk>>& chunks);
+
+    JUCE_DECLARE_NON_COPYABLE(DocumentSnapshot)
+};
@@ -1,11 +1,11 @@
-/*
-  ==============================================================================
-
-    Shape.cpp
-    Created: 12 Nov 2024 2:24:17pm
-    Author:  Martin S
-
-  ==============================================================================
-*/
-
-#include "Shape.h"
+/*
+  ==============================================================================
+
+    Shape.cpp
+    Created: 12 Nov 2024 2:24:17pm
+    Author:  Martin S
+
+  ==============================================================================
+*/
+
+#include "Shape.h"
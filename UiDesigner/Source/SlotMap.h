@@ -0,0 +1,171 @@
+/*
+  ==============================================================================
+
+    SlotMap.h
+    Created: 19 Oct 2026 12:04:31am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// SlotMap.h
+#pragma once
+#include <JuceHeader.h>
+
+// Handle to an element of a SlotMap. The generation changes whenever a slot
+// is freed, so a handle to an element that has since been removed finds
+// nothing instead of whatever was added in its place.
+struct SlotId
+{
+    static constexpr juce::uint32 invalidSlot = 0xffffffff;
+
+    juce::uint32 slot = invalidSlot;
+    juce::uint32 generation = 0;
+
+    bool isValid() const { return slot != invalidSlot; }
+
+    bool operator==(const SlotId& other) const { return slot == other.slot && generation == other.generation; }
+    bool operator!=(const SlotId& other) const { return !operator==(other); }
+};
+
+// Stores values densely in one array, for fast iteration, and hands out
+// stable SlotIds for them. Adding and removing are O(1): a removed value is
+// replaced by the last one, so the order of the dense array isn't kept, and
+// the slot is reused by a later add with the next generation.
+template<typename ValueType>
+class SlotMap
+{
+public:
+    SlotMap() = default;
+
+    SlotId add(ValueType value)
+    {
+        juce::uint32 slot;
+
+        if (firstFreeSlot != SlotId::invalidSlot)
+        {
+            slot = firstFreeSlot;
+            firstFreeSlot = slots[slot].denseIndex;
+        }
+        else
+        {
+            slot = (juce::uint32) slots.size();
+            slots.push_back({});
+        }
+
+        slots[slot].denseIndex = (juce::uint32) values.size();
+        values.push_back(std::move(value));
+        valueSlots.push_back(slot);
+
+        return { slot, slots[slot].generation };
+    }
+
+    void remove(SlotId id)
+    {
+        if (!contains(id))
+            return;
+
+        auto& removed = slots[id.slot];
+        const auto denseIndex = removed.denseIndex;
+        const auto lastIndex = (juce::uint32) values.size() - 1;
+
+        if (denseIndex != lastIndex)
+        {
+            values[denseIndex] = std::move(values[lastIndex]);
+            valueSlots[denseIndex] = valueSlots[lastIndex];
+            slots[valueSlots[denseIndex]].denseIndex = denseIndex;
+        }
+
+        values.pop_back();
+        valueSlots.pop_back();
+
+        ++removed.generation;
+        removed.denseIndex = firstFreeSlot;
+        firstFreeSlot = id.slot;
+    }
+
+    void clear()
+    {
+        // Bump every generation so no old handle survives
+        for (auto slot : valueSlots)
+        {
+            ++slots[slot].generation;
+            slots[slot].denseIndex = firstFreeSlot;
+            firstFreeSlot = slot;
+        }
+
+        values.clear();
+        valueSlots.clear();
+    }
+
+    bool contains(SlotId id) const
+    {
+        return id.slot < slots.size() && slots[id.slot].generation == id.generation
+               && slots[id.slot].denseIndex < values.size() && valueSlots[slots[id.slot].denseIndex] == id.slot;
+    }
+
+    ValueType& getReference(SlotId id)
+    {
+        jassert(contains(id));
+        return values[slots[id.slot].denseIndex];
+    }
+
+    const ValueType& getReference(SlotId id) const
+    {
+        jassert(contains(id));
+        return values[slots[id.slot].denseIndex];
+    }
+
+    // Dense access, in no particular order
+    int size() const { return (int) values.size(); }
+    bool isEmpty() const { return values.empty(); }
+    SlotId getId(int denseIndex) const { return { valueSlots[(size_t) denseIndex], slots[valueSlots[(size_t) denseIndex]].generation }; }
+
+    // The id of a value stored in this map, or an invalid id for any other object
+    SlotId getIdOf(const ValueType& value) const
+    {
+        const std::less<const ValueType*> isBefore;
+        const auto* first = values.data();
+
+        if (isBefore(&value, first) || !isBefore(&value, first + values.size()))
+            return {};
+
+        return getId((int) (&value - first));
+    }
+
+    // One more than the highest slot in use, for arrays indexed by slot
+    int getSlotCapacity() const { return (int) slots.size(); }
+
+    void ensureStorageAllocated(int numValues)
+    {
+        values.reserve((size_t) numValues);
+        valueSlots.reserve((size_t) numValues);
+        slots.reserve((size_t) numValues);
+    }
+
+    auto begin()        { return values.begin(); }
+    auto end()          { return values.end(); }
+    auto begin() const  { return values.begin(); }
+    auto end() const    { return values.end(); }
+
+private:
+    struct Slot
+    {
+        juce::uint32 denseIndex = 0;    // next free slot while the slot is free
+        juce::uint32 generation = 0;
+    };
+
+    std::vector<ValueType> values;
+    std::vector<juce::uint32> valueSlots;   // the slot of each value
+    std::vector<Slot> slots;
+    juce::uint32 firstFreeSlot = SlotId::invalidSlot;
+
+    JUCE_DECLARE_NON_COPYABLE(SlotMap)
+};
@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    SnapIndex.cpp
+    Created: 18 Oct 2026 10:36:02pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "SnapIndex.h"
+
+void SnapIndex::clear()
+{
+    xEdges.clear();
+    yEdges.clear();
+    indexedShapes.clear();
+}
+
+void SnapIndex::setIndexedBounds(SlotId shape, juce::Rectangle<float> bounds)
+{
+    if (shape.slot >= indexedShapes.size())
+        indexedShapes.resize(shape.slot + 1);
+
+    indexedShapes[shape.slot] = { shape, bounds };
+}
+
+void SnapIndex::addEdges(std::vector<Edge>& edges, SlotId shape, juce::Range<float> span, juce::Range<float> extent)
+{
+    edges.push_back({ span.getStart(), extent, Kind::Start, shape });
+    edges.push_back({ (span.getStart() + span.getEnd()) * 0.5f, extent, Kind::Centre, shape });
+    edges.push_back({ span.getEnd(), extent, Kind::End, shape });
+}
+
+void SnapIndex::addShape(SlotId shape, juce::Rectangle<float> bounds)
+{
+    addEdges(xEdges, shape, bounds.getHorizontalRange(), bounds.getVerticalRange());
+    addEdges(yEdges, shape, bounds.getVerticalRange(), bounds.getHorizontalRange());
+    setIndexedBounds(shape, bounds);
+}
+
+void SnapIndex::sort()
+{
+    auto byPosition = [](const Edge& a, const Edge& b) { return a.position < b.position; };
+    std::sort(xEdges.begin(), xEdges.end(), byPosition);
+    std::sort(yEdges.begin(), yEdges.end(), byPosition);
+}
+
+bool SnapIndex::removeSorted(std::vector<Edge>& edges, SlotId shape, float position)
+{
+    auto it = std::lower_bound(edges.begin(), edges.end(), position, isBefore);
+
+    for (; it != edges.end() && it->position == position; ++it)
+    {
+        if (it->shape == shape)
+        {
+            edges.erase(it);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void SnapIndex::insertSorted(std::vector<Edge>& edges, const Edge& edge)
+{
+    edges.insert(std::lower_bound(edges.begin(), edges.end(), edge.position, isBefore), edge);
+}
+
+bool SnapIndex::removeEdges(SlotId shape, juce::Rectangle<float> bounds)
+{
+    for (auto axis : { Axis::X, Axis::Y })
+    {
+        auto& edges = getEdges(axis);
+        const auto span = axis == Axis::X ? bounds.getHorizontalRange() : bounds.getVerticalRange();
+
+        if (!removeSorted(edges, shape, span.getStart())
+            || !removeSorted(edges, shape, (span.getStart() + span.getEnd()) * 0.5f)
+            || !removeSorted(edges, shape, span.getEnd()))
+            return false;
+    }
+
+    return true;
+}
+
+void SnapIndex::insertEdges(SlotId shape, juce::Rectangle<float> bounds)
+{
+    for (auto axis : { Axis::X, Axis::Y })
+    {
+        auto& edges = getEdges(axis);
+        const auto span = axis == Axis::X ? bounds.getHorizontalRange() : bounds.getVerticalRange();
+        const auto extent = axis == Axis::X ? bounds.getVerticalRange() : bounds.getHorizontalRange();
+
+        insertSorted(edges, { span.getStart(), extent, Kind::Start, shape });
+        insertSorted(edges, { (span.getStart() + span.getEnd()) * 0.5f, extent, Kind::Centre, shape });
+        insertSorted(edges, { span.getEnd(), extent, Kind::End, shape });
+    }
+}
+
+bool SnapIndex::updateShape(SlotId shape, juce::Rectangle<float> newBounds)
+{
+    // Edits mark a shape before and after changing it, the first call finds
+    // nothing to do
+    if (shape.slot < indexedShapes.size())
+    {
+        const auto& indexed = indexedShapes[shape.slot];
+
+        if (indexed.id == shape && indexed.bounds == newBounds)
+            return true;
+    }
+
+    // Erasing first keeps the sizes, and with them the capacities, unchanged.
+    // A slot still indexed under an earlier generation is cleared as well.
+    if (!removeSlot(shape.slot))
+        return false;
+
+    insertEdges(shape, newBounds);
+    setIndexedBounds(shape, newBounds);
+    return true;
+}
+
+bool SnapIndex::removeShape(SlotId shape)
+{
+    if (shape.slot >= indexedShapes.size() || indexedShapes[shape.slot].id != shape)
+        return true;
+
+    return removeSlot(shape.slot);
+}
+
+bool SnapIndex::removeShapes(const juce::Array<SlotId>& shapesToRemove)
+{
+    size_t numRemoved = 0;
+
+    for (auto shape : shapesToRemove)
+    {
+        if (shape.slot < indexedShapes.size() && indexedShapes[shape.slot].id == shape)
+        {
+            indexedShapes[shape.slot] = {};
+            numRemoved += 3;
+        }
+    }
+
+    // Entries of shapes that are no longer indexed under their id
+    const auto isRemoved = [this](const Edge& edge)
+    {
+        return edge.shape.slot >= indexedShapes.size() || indexedShapes[edge.shape.slot].id != edge.shape;
+    };
+
+    bool wereAllFound = true;
+
+    for (auto* edges : { &xEdges, &yEdges })
+    {
+        const auto oldSize = edges->size();
+        edges->erase(std::remove_if(edges->begin(), edges->end(), isRemoved), edges->end());
+        wereAllFound = wereAllFound && oldSize - edges->size() == numRemoved;
+    }
+
+    return wereAllFound;
+}
+
+bool SnapIndex::removeSlot(juce::uint32 slot)
+{
+    if (slot >= indexedShapes.size() || !indexedShapes[slot].id.isValid())
+        return true;
+
+    auto& indexed = indexedShapes[slot];
+    const bool wasFound = removeEdges(indexed.id, indexed.bounds);
+    indexed = {};
+    return wasFound;
+}
+
+const SnapIndex::Edge* SnapIndex::findNearest(Axis axis, float position, float maxDistance, SlotId excludedShape) const
+{
+    const auto& edges = getEdges(axis);
+    auto after = std::lower_bound(edges.begin(), edges.end(), position, isBefore);
+    auto before = after;
+
+    // Walks outwards from position, nearest entry first, so the first one
+    // that isn't excluded is the answer. Where many shapes line up, no more
+    // than maxScanned entries are looked at.
+    for (int scanned = 0; scanned < maxScanned; ++scanned)
+    {
+        const float distanceBefore = before != edges.begin() ? position - std::prev(before)->position : std::numeric_limits<float>::max();
+        const float distanceAfter = after != edges.end() ? after->position - position : std::numeric_limits<float>::max();
+
+        if (std::min(distanceBefore, distanceAfter) > maxDistance)
+            break;
+
+        const auto& edge = distanceAfter <= distanceBefore ? *after++ : *--before;
+
+        if (edge.shape != excludedShape)
+            return &edge;
+    }
+
+    return nullptr;
+}
+
+const SnapIndex::Edge* SnapIndex::findBefore(Axis axis, Kind kind, float position, juce::Range<float> extent, SlotId excludedShape) const
+{
+    const auto& edges = getEdges(axis);
+    auto it = std::upper_bound(edges.begin(), edges.end(), position,
+                               [](float value, const Edge& edge) { return value < edge.position; });
+
+    for (int scanned = 0; it != edges.begin() && scanned < maxScanned; ++scanned)
+    {
+        --it;
+
+        if (it->kind == kind && it->shape != excludedShape && it->extent.intersects(extent))
+            return &*it;
+    }
+
+    return nullptr;
+}
+
+const SnapIndex::Edge* SnapIndex::findAfter(Axis axis, Kind kind, float position, juce::Range<float> extent, SlotId excludedShape) const
+{
+    const auto& edges = getEdges(axis);
+    auto it = std::lower_bound(edges.begin(), edges.end(), position, isBefore);
+
+    for (int scanned = 0; it != edges.end() && scanned < maxScanned; ++it, ++scanned)
+        if (it->kind == kind && it->shape != excludedShape && it->extent.intersects(extent))
+            return &*it;
+
+    return nullptr;
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    SnapIndex.h
+    Created: 18 Oct 2026 10:36:02pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// SnapIndex.h
+#pragma once
+#include <JuceHeader.h>
+#include "SlotMap.h"
+
+// The edges and centres of all shapes, sorted by position, one list per axis.
+// Snapping while dragging looks up the nearest candidates with a binary
+// search instead of comparing against every shape.
+//
+// Shapes are identified by their SlotId in the document. Single edits update
+// the entries of one shape in place, the index remembers the bounds each shape
+// was added with to find them. Queries and updates don't allocate as long as
+// the number of shapes stays the same.
+class SnapIndex
+{
+public:
+    enum class Axis
+    {
+        X,
+        Y
+    };
+
+    enum class Kind
+    {
+        Start,      // left or top
+        Centre,
+        End         // right or bottom
+    };
+
+    struct Edge
+    {
+        float position;
+        juce::Range<float> extent;  // covered along the other axis
+        Kind kind;
+        SlotId shape;
+    };
+
+    SnapIndex() = default;
+
+    void clear();
+
+    // For building the index from scratch, call sort() after adding all shapes
+    void addShape(SlotId shape, juce::Rectangle<float> bounds);
+    void sort();
+
+    // Adds a shape or replaces its entries, keeping the lists sorted. Returns
+    // false if its entries weren't where they should be, the index then
+    // needs a rebuild.
+    bool updateShape(SlotId shape, juce::Rectangle<float> newBounds);
+
+    // Takes out the entries of a shape, if it has any
+    bool removeShape(SlotId shape);
+
+    // The same for several shapes, in one pass over the lists
+    bool removeShapes(const juce::Array<SlotId>& shapesToRemove);
+
+    // The edge nearest to position, no further away than maxDistance and
+    // among the first maxScanned entries from there. Returns nullptr if
+    // there is none.
+    const Edge* findNearest(Axis axis, float position, float maxDistance, SlotId excludedShape) const;
+
+    // The closest edges of the given kind before or after position whose extent
+    // overlaps the given one, looking at no more than maxScanned entries
+    const Edge* findBefore(Axis axis, Kind kind, float position, juce::Range<float> extent, SlotId excludedShape) const;
+    const Edge* findAfter(Axis axis, Kind kind, float position, juce::Range<float> extent, SlotId excludedShape) const;
+
+private:
+    static constexpr int maxScanned = 32;
+
+    // Indexed by slot, the id is invalid for slots without entries
+    struct IndexedShape
+    {
+        SlotId id;
+        juce::Rectangle<float> bounds;
+    };
+
+    std::vector<Edge>& getEdges(Axis axis) { return axis == Axis::X ? xEdges : yEdges; }
+    const std::vector<Edge>& getEdges(Axis axis) const { return axis == Axis::X ? xEdges : yEdges; }
+
+    static void addEdges(std::vector<Edge>& edges, SlotId shape, juce::Range<float> span, juce::Range<float> extent);
+    static bool removeSorted(std::vector<Edge>& edges, SlotId shape, float position);
+    static void insertSorted(std::vector<Edge>& edges, const Edge& edge);
+    bool removeSlot(juce::uint32 slot);
+    bool removeEdges(SlotId shape, juce::Rectangle<float> bounds);
+    void insertEdges(SlotId shape, juce::Rectangle<float> bounds);
+    void setIndexedBounds(SlotId shape, juce::Rectangle<float> bounds);
+    static bool isBefore(const Edge& edge, float position) { return edge.position < position; }
+
+    std::vector<Edge> xEdges;
+    std::vector<Edge> yEdges;
+    std::vector<IndexedShape> indexedShapes;
+
+    JUCE_DECLARE_NON_COPYABLE(SnapIndex)
+};
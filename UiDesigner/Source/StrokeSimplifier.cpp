@@ -0,0 +1,245 @@
+/*
+  ==============================================================================
+
+    StrokeSimplifier.cpp
+    Created: 19 Oct 2026 2:08:37am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "StrokeSimplifier.h"
+
+void StrokeSimplifier::begin(juce::Point<float> start, float newTolerance)
+{
+    tolerance = newTolerance;
+    keptPoints.clearQuick();
+    finishedCurve.clear();
+    numPendingSamples = 0;
+    numSamples = 1;
+
+    keepPoint(start);
+}
+
+bool StrokeSimplifier::addSample(juce::Point<float> sample)
+{
+    const auto lastSample = numPendingSamples > 0 ? pendingSamples[numPendingSamples - 1] : keptPoints.getLast();
+
+    // The mouse reports the same position again now and then
+    if (sample == lastSample)
+        return false;
+
+    ++numSamples;
+
+    if (numPendingSamples < maxPendingSamples && pendingSamplesFit(sample))
+    {
+        pendingSamples[numPendingSamples++] = sample;
+        return false;
+    }
+
+    keepPoint(lastSample);
+    pendingSamples[0] = sample;
+    numPendingSamples = 1;
+    return true;
+}
+
+juce::Array<juce::Point<float>> StrokeSimplifier::finish()
+{
+    if (numPendingSamples > 0)
+        keepPoint(pendingSamples[numPendingSamples - 1]);
+
+    numPendingSamples = 0;
+    return keptPoints;
+}
+
+void StrokeSimplifier::addFinishedCurve(juce::Path& path, int numPointsBefore) const
+{
+    const int numKept = keptPoints.size();
+
+    if (numPointsBefore >= numKept)
+        return;
+
+    // Picks up where the finished curve ended back then, see keepPoint()
+    path.startNewSubPath(numPointsBefore < 2 ? keptPoints.getFirst()
+                                             : (keptPoints.getReference(numPointsBefore - 2) + keptPoints.getReference(numPointsBefore - 1)) * 0.5f);
+
+    for (int i = juce::jmax(1, numPointsBefore); i < numKept; ++i)
+    {
+        const auto previous = keptPoints.getReference(i - 1);
+        const auto middle = (previous + keptPoints.getReference(i)) * 0.5f;
+
+        if (i == 1)
+            path.lineTo(middle);
+        else
+            path.quadraticTo(previous, middle);
+    }
+}
+
+void StrokeSimplifier::addUnfinishedCurve(juce::Path& path) const
+{
+    const int numKept = keptPoints.size();
+
+    if (numKept == 0)
+        return;
+
+    const auto last = keptPoints.getLast();
+    const auto end = numPendingSamples > 0 ? pendingSamples[numPendingSamples - 1] : last;
+
+    if (numKept == 1)
+    {
+        path.startNewSubPath(last);
+        path.lineTo(end);
+        return;
+    }
+
+    // Same as addCurve() would draw if the newest sample were the last point
+    path.startNewSubPath((keptPoints.getReference(numKept - 2) + last) * 0.5f);
+    path.quadraticTo(last, (last + end) * 0.5f);
+    path.lineTo(end);
+}
+
+juce::Rectangle<float> StrokeSimplifier::getUnfinishedArea() const
+{
+    const int numKept = keptPoints.size();
+
+    if (numKept == 0)
+        return {};
+
+    // The curve stays within its control points
+    auto area = juce::Rectangle<float>(keptPoints.getLast(), numKept > 1 ? keptPoints.getReference(numKept - 2)
+                                                                        : keptPoints.getLast());
+
+    for (int i = 0; i < numPendingSamples; ++i)
+        area = area.getUnion(juce::Rectangle<float>(pendingSamples[i], pendingSamples[i]));
+
+    return area;
+}
+
+void StrokeSimplifier::addCurve(juce::Path& path, const juce::Point<float>* points, int numPoints)
+{
+    if (numPoints == 0)
+        return;
+
+    path.startNewSubPath(points[0]);
+
+    if (numPoints == 1)
+    {
+        // A dot still needs a segment to be stroked
+        path.lineTo(points[0]);
+        return;
+    }
+
+    path.lineTo((points[0] + points[1]) * 0.5f);
+
+    for (int i = 1; i < numPoints - 1; ++i)
+        path.quadraticTo(points[i], (points[i] + points[i + 1]) * 0.5f);
+
+    path.lineTo(points[numPoints - 1]);
+}
+
+float StrokeSimplifier::getDistanceToSegment(juce::Point<float> point, juce::Point<float> start, juce::Point<float> end)
+{
+    juce::Point<float> nearest;
+    return juce::Line<float>(start, end).getDistanceFromPoint(point, nearest);
+}
+
+bool StrokeSimplifier::pendingSamplesFit(juce::Point<float> end) const
+{
+    const auto start = keptPoints.getLast();
+
+    for (int i = 0; i < numPendingSamples; ++i)
+        if (getDistanceToSegment(pendingSamples[i], start, end) > tolerance)
+            return false;
+
+    return true;
+}
+
+void StrokeSimplifier::keepPoint(juce::Point<float> point)
+{
+    keptPoints.add(point);
+
+    // Extends the finished curve the same way addCurve() builds it
+    const int numKept = keptPoints.size();
+
+    if (numKept == 1)
+    {
+        finishedCurve.startNewSubPath(point);
+        return;
+    }
+
+    const auto previous = keptPoints.getReference(numKept - 2);
+    const auto middle = (previous + point) * 0.5f;
+
+    if (numKept == 2)
+        finishedCurve.lineTo(middle);
+    else
+        finishedCurve.quadraticTo(previous, middle);
+}
+
+#if JUCE_UNIT_TESTS
+
+class StrokeSimplifierTests : public juce::UnitTest
+{
+public:
+    StrokeSimplifierTests() : juce::UnitTest("StrokeSimplifier", "UiDesigner") {}
+
+    void runTest() override
+    {
+        beginTest("Sweep");
+
+        // Two slow turns of a wobbly loop, sampled far more densely than the
+        // tolerance needs, like a mouse dragged slowly
+        constexpr int numSamples = 5000;
+        constexpr float tolerance = 0.75f;
+
+        juce::Array<juce::Point<float>> samples;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const float t = (float) i / (float) numSamples;
+            const float angle = t * 4.0f * juce::MathConstants<float>::pi;
+            const float radius = 200.0f + 40.0f * std::sin(t * 30.0f);
+            samples.add({ 400.0f + radius * std::cos(angle), 300.0f + radius * std::sin(angle) });
+        }
+
+        StrokeSimplifier simplifier;
+        simplifier.begin(samples.getFirst(), tolerance);
+
+        for (int i = 1; i < samples.size(); ++i)
+            simplifier.addSample(samples.getReference(i));
+
+        const auto points = simplifier.finish();
+
+        expectEquals(simplifier.getNumSamples(), numSamples);
+        expect(points.size() >= 2 && points.size() <= 120, "Kept " + juce::String(points.size()) + " points");
+        expect(points.getFirst() == samples.getFirst() && points.getLast() == samples.getLast());
+
+        // Samples are consumed in order, so each one lies between the two
+        // kept points around it
+        int segment = 0;
+        float worstDistance = 0.0f;
+
+        for (auto& sample : samples)
+        {
+            while (segment + 1 < points.size() - 1 && sample == points.getReference(segment + 1))
+                ++segment;
+
+            juce::Point<float> nearest;
+            const auto line = juce::Line<float>(points.getReference(segment), points.getReference(segment + 1));
+            worstDistance = juce::jmax(worstDistance, line.getDistanceFromPoint(sample, nearest));
+        }
+
+        expectLessOrEqual(worstDistance, tolerance);
+    }
+};
+
+static StrokeSimplifierTests strokeSimplifierTests;
+
+#endif
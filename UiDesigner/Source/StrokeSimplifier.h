@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    StrokeSimplifier.h
+    Created: 19 Oct 2026 2:08:37am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// StrokeSimplifier.h
+#pragma once
+#include <JuceHeader.h>
+
+// Reduces the mouse samples of a freehand stroke to the few points needed to
+// draw it, while the stroke is being drawn.
+//
+// This is a one-pass Ramer-Douglas-Peucker: the samples since the last kept
+// point stay pending as long as they all lie within the tolerance of the
+// segment from that point to the newest sample. When one doesn't, the sample
+// before the newest is kept and the test starts over from there. It keeps a
+// few more points than the recursive version, but each sample is only looked
+// at while pending, and no more than maxPendingSamples are pending at a time.
+//
+// The kept points are drawn as a smooth curve, see addCurve(). Its finished
+// part only grows at the end, so it's built up as points are kept instead of
+// from scratch for every mouse event.
+class StrokeSimplifier
+{
+public:
+    StrokeSimplifier() = default;
+
+    // tolerance is the largest distance, in document units, that the kept
+    // points may stray from the samples
+    void begin(juce::Point<float> start, float tolerance);
+
+    // Returns true if the sample made the previous one a kept point
+    bool addSample(juce::Point<float> sample);
+
+    // Keeps the last sample as well and returns all kept points
+    juce::Array<juce::Point<float>> finish();
+
+    int getNumSamples() const { return numSamples; }
+    const juce::Array<juce::Point<float>>& getKeptPoints() const { return keptPoints; }
+
+    // The curve through the kept points up to the middle of the last segment,
+    // which is all that later samples can't change
+    const juce::Path& getFinishedCurve() const { return finishedCurve; }
+
+    // The part of the finished curve that was added after the first
+    // numPointsBefore points had been kept
+    void addFinishedCurve(juce::Path& path, int numPointsBefore) const;
+
+    // Adds the rest of the curve, from the end of the finished curve to the
+    // newest sample
+    void addUnfinishedCurve(juce::Path& path) const;
+
+    // Area that addUnfinishedCurve() covers
+    juce::Rectangle<float> getUnfinishedArea() const;
+
+    // A smooth curve through the points: straight to the middle of the first
+    // segment, then quadratic curves from middle to middle with the points in
+    // between as control points, and straight on to the last point
+    static void addCurve(juce::Path& path, const juce::Point<float>* points, int numPoints);
+
+private:
+    static constexpr int maxPendingSamples = 64;
+
+    static float getDistanceToSegment(juce::Point<float> point, juce::Point<float> start, juce::Point<float> end);
+    bool pendingSamplesFit(juce::Point<float> end) const;
+    void keepPoint(juce::Point<float> point);
+
+    float tolerance = 0.5f;
+    juce::Array<juce::Point<float>> keptPoints;
+    juce::Point<float> pendingSamples[maxPendingSamples];
+    int numPendingSamples = 0;
+    int numSamples = 0;
+    juce::Path finishedCurve;
+
+    JUCE_DECLARE_NON_COPYABLE(StrokeSimplifier)
+};
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    StyleTable.cpp
+    Created: 18 Oct 2026 5:18:44pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "StyleTable.h"
+#include "FontCache.h"
+
+bool MainComponent::Style::operator==(const Style& other) const
+{
+    return fillColour == other.fillColour
+        && strokeColour == other.strokeColour
+        && strokeWidth == other.strokeWidth
+        && strokePattern == other.strokePattern
+        && hasFill == other.hasFill
+        && cornerRadius == other.cornerRadius
+        && fontSize == other.fontSize
+        && fontFamily == other.fontFamily
+        && textStretchEnabled == other.textStretchEnabled;
+}
+
+const juce::Font& MainComponent::InternedStyle::getFont() const
+{
+    std::call_once(fontLookup, [this] { font = FontCache::getInstance()->getFont(style.fontFamily, style.fontSize); });
+    return font;
+}
+
+MainComponent::StyleHandle::StyleHandle()
+{
+    // Default constructed shapes are common, so the default style is only
+    // looked up once
+    static const auto defaultStyle = StyleTable::getInstance().intern(Style());
+    entry = defaultStyle;
+}
+
+MainComponent::StyleHandle::StyleHandle(const Style& newStyle)
+    : entry(StyleTable::getInstance().intern(newStyle))
+{
+}
+
+//==================================================================
+
+StyleTable& StyleTable::getInstance()
+{
+    static StyleTable instance;
+    return instance;
+}
+
+std::shared_ptr<const StyleTable::InternedStyle> StyleTable::find(size_t hash, const Style& style) const
+{
+    auto range = styles.equal_range(hash);
+
+    for (auto entry = range.first; entry != range.second; ++entry)
+        if (auto existing = entry->second.lock())
+            if (existing->style == style)
+                return existing;
+
+    return nullptr;
+}
+
+std::shared_ptr<const StyleTable::InternedStyle> StyleTable::intern(const Style& style)
+{
+    const auto hash = getHash(style);
+    const juce::ScopedLock sl(lock);
+
+    if (auto existing = find(hash, style))
+        return existing;
+
+    auto newStyle = std::make_shared<const InternedStyle>(style);
+    styles.emplace(hash, newStyle);
+
+    if (styles.size() >= nextCleanupSize)
+    {
+        removeUnusedStyles();
+        nextCleanupSize = juce::jmax((size_t) 64, styles.size() * 2);
+    }
+
+    return newStyle;
+}
+
+int StyleTable::getNumStyles() const
+{
+    const juce::ScopedLock sl(lock);
+    return (int) styles.size();
+}
+
+size_t StyleTable::getHash(const Style& style)
+{
+    size_t hash = std::hash<juce::uint32>()(style.fillColour.getARGB());
+
+    auto combine = [&hash](size_t value)
+    {
+        hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+    };
+
+    combine(std::hash<juce::uint32>()(style.strokeColour.getARGB()));
+    combine(std::hash<float>()(style.strokeWidth));
+    combine((size_t) style.strokePattern);
+    combine((size_t) style.hasFill);
+    combine(std::hash<float>()(style.cornerRadius));
+    combine(std::hash<float>()(style.fontSize));
+    combine((size_t) style.fontFamily.hash());
+    combine((size_t) style.textStretchEnabled);
+    return hash;
+}
+
+void StyleTable::removeUnusedStyles()
+{
+    for (auto entry = styles.begin(); entry != styles.end();)
+    {
+        if (entry->second.expired())
+            entry = styles.erase(entry);
+        else
+            ++entry;
+    }
+}
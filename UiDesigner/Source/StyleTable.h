@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    StyleTable.h
+    Created: 18 Oct 2026 5:18:44pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// StyleTable.h
+#pragma once
+#include <JuceHeader.h>
+#include "MainComponent.h"
+
+// Process-wide set of the styles in use, behind MainComponent::StyleHandle.
+// Each distinct style is stored once and shared by every shape that uses it.
+// The table only holds weak references, so a style goes away with the last
+// shape using it. Interning locks, since snapshots edit styles on render
+// threads too.
+//
+// An entry gets its font from the FontCache the first time text is drawn in
+// it. Interning itself never loads a typeface, so restoring a document on the
+// host's thread doesn't wait for the fonts it uses.
+class StyleTable
+{
+public:
+    using Style = MainComponent::Style;
+    using InternedStyle = MainComponent::InternedStyle;
+
+    static StyleTable& getInstance();
+
+    // Returns the shared entry equal to style, adding one if there is none
+    std::shared_ptr<const InternedStyle> intern(const Style& style);
+
+    int getNumStyles() const;
+
+private:
+    StyleTable() = default;
+
+    static size_t getHash(const Style& style);
+    std::shared_ptr<const InternedStyle> find(size_t hash, const Style& style) const;
+    void removeUnusedStyles();
+
+    juce::CriticalSection lock;
+    std::unordered_multimap<size_t, std::weak_ptr<const InternedStyle>> styles;
+    size_t nextCleanupSize = 64;
+
+    JUCE_DECLARE_NON_COPYABLE(StyleTable)
+};
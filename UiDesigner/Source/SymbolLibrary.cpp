@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    SymbolLibrary.cpp
+    Created: 18 Oct 2026 4:41:09pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "SymbolLibrary.h"
+#include "SceneRenderer.h"
+#include "TraceRecorder.h"
+
+static juce::Rectangle<float> getShapesDrawnArea(const juce::Array<MainComponent::Shape>& shapes)
+{
+    juce::Rectangle<float> area;
+
+    for (auto& shape : shapes)
+        area = area.isEmpty() ? shape.getDrawnBounds() : area.getUnion(shape.getDrawnBounds());
+
+    return area;
+}
+
+SymbolLibrary::Symbol::Symbol(juce::Array<Shape> masterShapes, juce::Rectangle<float> symbolFrame)
+    : shapes(std::move(masterShapes)),
+      frame(symbolFrame),
+      drawnArea(getShapesDrawnArea(shapes)),
+      hasImageShapes(std::any_of(shapes.begin(), shapes.end(),
+                                 [](const Shape& shape) { return shape.type == MainComponent::Tool::Image; }))
+{
+}
+
+SymbolLibrary::Symbol::CachedImage SymbolLibrary::Symbol::getImage(float pixelsPerUnit,
+                                                                   std::optional<juce::Colour> fillOverride) const
+{
+    // Power-of-two steps, so zooming doesn't re-render on every frame and an
+    // image is never drawn more than halved
+    const float scale = std::exp2(std::ceil(std::log2(juce::jmax(1.0f / 64.0f, pixelsPerUnit))));
+    const int width = (int) std::ceil(drawnArea.getWidth() * scale);
+    const int height = (int) std::ceil(drawnArea.getHeight() * scale);
+
+    if (width > maxImageSize || height > maxImageSize || width <= 0 || height <= 0)
+        return {};
+
+    const std::pair<float, juce::uint32> key { scale, fillOverride ? fillOverride->getARGB() : 0 };
+    juce::uint32 imageGeneration;
+
+    {
+        const juce::ScopedLock sl(cacheLock);
+
+        // A cached placeholder would outlive the decode, so until every image is
+        // in the instances are drawn from the shapes. The images are only looked
+        // up again after the library has decoded something, which may also have
+        // brought back levels the cached images were drawn from.
+        if (hasImageShapes)
+        {
+            auto* library = ImageLibrary::getInstance();
+            const auto generation = library->getGeneration();
+
+            if (generation != checkedImageGeneration)
+            {
+                imageCache.clear();
+                hasLoadingImages = std::any_of(shapes.begin(), shapes.end(), [library](const Shape& shape)
+                {
+                    return shape.type == MainComponent::Tool::Image
+                           && library->getStatus(shape.imageFile) == ImageLibrary::Status::Loading;
+                });
+                checkedImageGeneration = generation;
+            }
+
+            if (hasLoadingImages)
+                return {};
+        }
+
+        if (auto cached = imageCache.find(key); cached != imageCache.end())
+            return { cached->second, scale };
+
+        imageGeneration = checkedImageGeneration;
+    }
+
+    // Rendered without holding the lock, so other threads drawing this symbol
+    // at a scale that's already cached aren't held up. Two threads may both
+    // render a missing image, the second one to finish replaces the first.
+    UIDESIGNER_TRACE_SCOPE("Symbol::renderImage");
+
+    juce::Image image(juce::Image::ARGB, width, height, true, juce::SoftwareImageType());
+    {
+        const auto filledShapes = fillOverride ? getShapesWithFill(*fillOverride) : nullptr;
+        const auto& masterShapes = filledShapes != nullptr ? *filledShapes : shapes;
+
+        juce::Graphics g(image);
+        g.addTransform(juce::AffineTransform::translation(-drawnArea.getPosition()).scaled(scale));
+
+        FrameArena arena(4096);
+        auto** drawList = arena.allocateArray<const Shape*>((size_t) masterShapes.size());
+
+        for (int i = 0; i < masterShapes.size(); ++i)
+            drawList[i] = &masterShapes.getReference(i);
+
+        SceneRenderer renderer(g, arena, scale);
+        renderer.drawShapes(drawList, masterShapes.size());
+    }
+
+    const juce::ScopedLock sl(cacheLock);
+
+    // Images that finished decoding in the meantime may not be in this one
+    if (imageGeneration == checkedImageGeneration)
+    {
+        if ((int) imageCache.size() >= maxCachedImages)
+            imageCache.clear();
+
+        imageCache[key] = image;
+    }
+
+    return { image, scale };
+}
+
+std::shared_ptr<const juce::Array<SymbolLibrary::Shape>> SymbolLibrary::Symbol::getShapesWithFill(juce::Colour fillColour) const
+{
+    {
+        const juce::ScopedLock sl(cacheLock);
+
+        if (auto cached = filledShapesCache.find(fillColour.getARGB()); cached != filledShapesCache.end())
+            return cached->second;
+    }
+
+    // Interning the edited styles takes the style table's lock, so this is
+    // done outside of cacheLock
+    auto result = std::make_shared<juce::Array<Shape>>(shapes);
+
+    for (auto& shape : *result)
+        if (shape.style->hasFill && !MainComponent::isOpenPath(shape.type) && shape.type != MainComponent::Tool::Text)
+            shape.style.edit([&](MainComponent::Style& style) { style.fillColour = fillColour; });
+
+    const juce::ScopedLock sl(cacheLock);
+
+    if ((int) filledShapesCache.size() >= maxCachedFills)
+        filledShapesCache.clear();
+
+    return filledShapesCache.try_emplace(fillColour.getARGB(), std::move(result)).first->second;
+}
+
+//==================================================================
+
+SymbolLibrary::SymbolLibrary()
+{
+    MainComponent::Style style;
+    style.fillColour = juce::Colours::white;
+    style.strokeColour = juce::Colours::black;
+    style.hasFill = false;   // no fill override
+
+    instancePrototype.type = MainComponent::Tool::Instance;
+    instancePrototype.style = style;
+}
+
+int SymbolLibrary::addSymbol(juce::Array<Shape> masterShapes)
+{
+    const int symbolId = nextSymbolId++;
+    const auto frame = getShapesDrawnArea(masterShapes);
+    symbols[symbolId] = std::make_shared<const Symbol>(std::move(masterShapes), frame);
+    return symbolId;
+}
+
+void SymbolLibrary::updateSymbol(int symbolId, juce::Array<Shape> masterShapes)
+{
+    auto existing = symbols.find(symbolId);
+
+    if (existing == symbols.end())
+        return;
+
+    // Snapshots may still be drawing the old master, so it's replaced rather than changed
+    existing->second = std::make_shared<const Symbol>(std::move(masterShapes), existing->second->frame);
+}
+
+const SymbolLibrary::Symbol* SymbolLibrary::getSymbol(int symbolId) const
+{
+    auto found = symbols.find(symbolId);
+    return found != symbols.end() ? found->second.get() : nullptr;
+}
+
+juce::Array<int> SymbolLibrary::getSymbolIds() const
+{
+    juce::Array<int> ids;
+
+    for (auto& [symbolId, symbol] : symbols)
+        ids.add(symbolId);
+
+    return ids;
+}
+
+void SymbolLibrary::restoreSymbol(int symbolId, juce::Array<Shape> masterShapes, juce::Rectangle<float> frame)
+{
+    symbols[symbolId] = std::make_shared<const Symbol>(std::move(masterShapes), frame);
+    nextSymbolId = juce::jmax(nextSymbolId, symbolId + 1);
+}
+
+SymbolLibrary::Shape SymbolLibrary::createInstance(int symbolId) const
+{
+    auto instance = instancePrototype;
+    instance.symbolId = symbolId;
+
+    if (auto* symbol = getSymbol(symbolId))
+        instance.bounds = symbol->frame;
+
+    instance.initializeRotationCenter();
+    return instance;
+}
+
+juce::AffineTransform SymbolLibrary::getInstanceTransform(const Shape& instance, const Symbol& symbol)
+{
+    const auto& frame = symbol.frame;
+
+    auto transform = juce::AffineTransform::translation(-frame.getPosition())
+                         .scaled(instance.bounds.getWidth() / juce::jmax(0.001f, frame.getWidth()),
+                                 instance.bounds.getHeight() / juce::jmax(0.001f, frame.getHeight()))
+                         .translated(instance.bounds.getPosition());
+
+    if (instance.rotation != 0.0f)
+        transform = transform.followedBy(juce::AffineTransform::rotation(instance.rotation,
+                                                                         instance.rotationCenter.x,
+                                                                         instance.rotationCenter.y));
+    return transform;
+}
+
+juce::Rectangle<float> SymbolLibrary::getDrawnBounds(const Shape& instance) const
+{
+    if (auto* symbol = getSymbol(instance.symbolId))
+        return symbol->drawnArea.transformedBy(getInstanceTransform(instance, *symbol)).expanded(1.0f);
+
+    return instance.getDrawnBounds();
+}
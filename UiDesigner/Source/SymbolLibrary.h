@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+    SymbolLibrary.h
+    Created: 18 Oct 2026 4:41:09pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// SymbolLibrary.h
+#pragma once
+#include <JuceHeader.h>
+#include "MainComponent.h"
+
+// Reusable groups of shapes, e.g. a knob that appears a hundred times.
+//
+// A symbol holds the master shapes. Each use of it in the document is an
+// instance: a Shape of type Tool::Instance that only stores its placement
+// (bounds and rotation), the symbol id and an optional fill colour override.
+// Instances are drawn from a bitmap of the master cached per zoom level, so
+// a hundred knobs cost a hundred image blits.
+//
+// Symbols are immutable. Editing the master replaces the symbol under the
+// same id, which every instance picks up without being touched. Copies of the
+// library are cheap and share the symbols, so a document snapshot just keeps
+// its own copy.
+class SymbolLibrary
+{
+public:
+    using Shape = MainComponent::Shape;
+
+    class Symbol
+    {
+    public:
+        Symbol(juce::Array<Shape> masterShapes, juce::Rectangle<float> frame);
+
+        const juce::Array<Shape> shapes;
+
+        // The master's own area, which instance bounds are mapped from. It
+        // doesn't change when the master is edited.
+        const juce::Rectangle<float> frame;
+
+        // Everything the shapes paint, strokes included
+        const juce::Rectangle<float> drawnArea;
+
+        struct CachedImage
+        {
+            juce::Image image;
+            float scale = 0.0f;     // image pixels per symbol unit
+        };
+
+        // Returns the master rendered at no less than pixelsPerUnit, or an
+        // invalid image if that would be too large to be worth caching.
+        // Safe to call from any thread.
+        CachedImage getImage(float pixelsPerUnit, std::optional<juce::Colour> fillOverride) const;
+
+        // Master shapes with an instance's fill colour applied, kept for the
+        // colours used last. Safe to call from any thread.
+        std::shared_ptr<const juce::Array<Shape>> getShapesWithFill(juce::Colour fillColour) const;
+
+    private:
+        static constexpr int maxImageSize = 1024;
+        static constexpr int maxCachedImages = 8;
+        static constexpr int maxCachedFills = 8;
+
+        // Whether any master shape is an image, and if so whether one of them
+        // was still loading as of the ImageLibrary generation checked last
+        const bool hasImageShapes;
+
+        mutable juce::CriticalSection cacheLock;
+        mutable std::map<std::pair<float, juce::uint32>, juce::Image> imageCache;
+        mutable std::map<juce::uint32, std::shared_ptr<const juce::Array<Shape>>> filledShapesCache;
+        mutable juce::uint32 checkedImageGeneration = 0;
+        mutable bool hasLoadingImages = false;
+
+        JUCE_DECLARE_NON_COPYABLE(Symbol)
+    };
+
+    SymbolLibrary();
+
+    // Turns the shapes into a new symbol and returns its id
+    int addSymbol(juce::Array<Shape> masterShapes);
+
+    // Replaces the master of a symbol. Existing instances keep their bounds.
+    void updateSymbol(int symbolId, juce::Array<Shape> masterShapes);
+
+    // Returns nullptr for unknown ids
+    const Symbol* getSymbol(int symbolId) const;
+    juce::Array<int> getSymbolIds() const;
+
+    // Puts back a symbol with the id and frame it was saved with
+    void restoreSymbol(int symbolId, juce::Array<Shape> masterShapes, juce::Rectangle<float> frame);
+
+    // A new instance covering the master's own area
+    Shape createInstance(int symbolId) const;
+
+    // Symbol coordinates to document coordinates for an instance
+    static juce::AffineTransform getInstanceTransform(const Shape& instance, const Symbol& symbol);
+
+    // Area touched when painting an instance, like Shape::getDrawnBounds()
+    juce::Rectangle<float> getDrawnBounds(const Shape& instance) const;
+
+private:
+    std::map<int, std::shared_ptr<const Symbol>> symbols;
+    int nextSymbolId = 1;
+
+    // Instances are copied from this one, so they share its string and style
+    // data instead of each allocating their own
+    Shape instancePrototype;
+};
@@ -0,0 +1,330 @@
+/*
+  ==============================================================================
+
+    TileCache.cpp
+    Created: 18 Oct 2026 1:47:26pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "TileCache.h"
+#include "TraceRecorder.h"
+
+class TileCache::RenderJob : public juce::ThreadPoolJob
+{
+public:
+    RenderJob(TileCache& cache, const TileKey& tileKey, juce::uint64 jobEpoch,
+              std::shared_ptr<const RenderSource> documentSource)
+        : juce::ThreadPoolJob("Tile"),
+          key(tileKey),
+          owner(cache),
+          epoch(jobEpoch),
+          source(std::move(documentSource))
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        UIDESIGNER_TRACE_SCOPE("renderTile");
+
+        auto image = createTileImage(key);
+        {
+            const RasterTarget target { image, getTileTransform(key) };
+
+            juce::Graphics g(image);
+            g.fillAll(juce::Colours::white);
+            g.addTransform(target.documentToImage);
+            source->render(g, key.scale, arena, &target);
+        }
+
+        const juce::ScopedLock sl(owner.finishedLock);
+        owner.finishedTiles.push_back({ key, epoch, image });
+        return jobHasFinished;
+    }
+
+    const TileKey key;
+
+private:
+    TileCache& owner;
+    const juce::uint64 epoch;
+    const std::shared_ptr<const RenderSource> source;
+    FrameArena arena;
+};
+
+TileCache::TileCache()
+    : threadPool(juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1))
+{
+}
+
+TileCache::~TileCache()
+{
+    // Jobs push their results into this object, so they have to be gone first
+    threadPool.removeAllJobs(true, 10000);
+}
+
+void TileCache::draw(juce::Graphics& g, juce::Rectangle<int> area, float viewScale,
+                     juce::Point<int> viewOffset, RenderClient& client)
+{
+    UIDESIGNER_TRACE_SCOPE("TileCache::draw");
+
+    ++frameCounter;
+    stats = {};
+
+    if (viewScale != lastViewScale)
+    {
+        // Zooming continuously would otherwise pile up jobs for zoom levels
+        // that are already gone
+        cancelJobsForOtherScales(viewScale);
+        lastViewScale = viewScale;
+    }
+
+    const float pixelScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+
+    auto floorDiv = [](int value) { return (int) std::floor((double) value / tileSize); };
+
+    auto scaledArea = area - viewOffset;
+    const int firstX = floorDiv(scaledArea.getX());
+    const int lastX = floorDiv(scaledArea.getRight() - 1);
+    const int firstY = floorDiv(scaledArea.getY());
+    const int lastY = floorDiv(scaledArea.getBottom() - 1);
+
+    std::shared_ptr<const RenderSource> snapshot;
+
+    for (int y = firstY; y <= lastY; ++y)
+    {
+        for (int x = firstX; x <= lastX; ++x)
+        {
+            const TileKey key { viewScale, pixelScale, x, y };
+            auto& tile = tiles[key];
+            tile.lastUsedFrame = frameCounter;
+            ++stats.tilesVisible;
+
+            // New and edited tiles are rendered in the background. One job
+            // per tile at a time: during a drag, the next one starts from the
+            // latest document once the previous one is in.
+            if ((!tile.image.isValid() || tile.isDirty()) && !tile.isQueued())
+                queueTile(key, tile, snapshot, client);
+
+            if (tile.image.isValid())
+            {
+                if (tile.isDirty())
+                    ++stats.tilesStale;
+
+                drawTile(g, key, tile.image, viewScale, viewOffset);
+            }
+            else
+            {
+                ++stats.tilesQueued;
+                drawPlaceholder(g, key, viewScale, viewOffset);
+            }
+        }
+    }
+
+    evictTiles();
+    stats.tilesCached = (int) tiles.size();
+}
+
+void TileCache::invalidate(juce::Rectangle<float> documentArea)
+{
+    if (documentArea.isEmpty())
+        return;
+
+    for (auto& [key, tile] : tiles)
+    {
+        // One extra pixel for anti-aliasing and the dots drawn for tiny shapes
+        if (getDocumentArea(key).expanded(1.0f / key.scale).intersects(documentArea))
+            tile.editEpoch = nextEpoch++;
+    }
+}
+
+void TileCache::clear()
+{
+    // Jobs that are already running can't be stopped, their results are
+    // dropped since no tile is waiting for them any more
+    threadPool.removeAllJobs(false, 0);
+    tiles.clear();
+}
+
+void TileCache::queueTile(const TileKey& key, Tile& tile, std::shared_ptr<const RenderSource>& snapshot,
+                          RenderClient& client)
+{
+    // Fetched at most once per frame, and only if a tile needs it
+    if (snapshot == nullptr)
+        snapshot = client.getDocumentSnapshot();
+
+    tile.queuedEpoch = nextEpoch++;
+    threadPool.addJob(new RenderJob(*this, key, tile.queuedEpoch, snapshot), true);
+}
+
+bool TileCache::collectFinishedTiles()
+{
+    std::vector<FinishedTile> finished;
+    {
+        const juce::ScopedLock sl(finishedLock);
+        finished.swap(finishedTiles);
+    }
+
+    bool anyTaken = false;
+
+    for (auto& result : finished)
+    {
+        auto it = tiles.find(result.key);
+
+        // Evicted in the meantime
+        if (it == tiles.end())
+            continue;
+
+        auto& tile = it->second;
+
+        // From a job the tile no longer waits for: cancelled, or queued for
+        // an earlier tile with the same key that has since been cleared away
+        if (result.epoch != tile.queuedEpoch)
+            continue;
+
+        tile.queuedEpoch = 0;
+
+        // A result from before the latest edit still beats an older image.
+        // The tile stays dirty and is queued again when it's next drawn.
+        if (result.epoch > tile.imageEpoch)
+        {
+            tile.image = result.image;
+            tile.imageEpoch = result.epoch;
+            anyTaken = true;
+        }
+    }
+
+    return anyTaken;
+}
+
+juce::Rectangle<float> TileCache::getDocumentArea(const TileKey& key)
+{
+    return juce::Rectangle<float>((float) (key.x * tileSize), (float) (key.y * tileSize),
+                                  (float) tileSize, (float) tileSize) / key.scale;
+}
+
+juce::Image TileCache::createTileImage(const TileKey& key)
+{
+    // Software images can be drawn into from any thread
+    const int size = juce::roundToInt(tileSize * key.pixelScale);
+    return juce::Image(juce::Image::RGB, size, size, false, juce::SoftwareImageType());
+}
+
+juce::AffineTransform TileCache::getTileTransform(const TileKey& key)
+{
+    // Document coordinates to pixels in the tile image
+    return juce::AffineTransform::scale(key.scale)
+               .translated((float) (-key.x * tileSize), (float) (-key.y * tileSize))
+               .scaled(key.pixelScale);
+}
+
+void TileCache::drawTile(juce::Graphics& g, const TileKey& key, const juce::Image& image,
+                         float viewScale, juce::Point<int> viewOffset)
+{
+    // At the tile's own zoom level this is a whole-pixel translation, which
+    // the renderer turns into a plain blit
+    auto transform = juce::AffineTransform::scale(1.0f / key.pixelScale)
+                         .translated((float) (key.x * tileSize), (float) (key.y * tileSize))
+                         .scaled(viewScale / key.scale)
+                         .translated(viewOffset.toFloat());
+
+    g.drawImageTransformed(image, transform);
+}
+
+void TileCache::drawPlaceholder(juce::Graphics& g, const TileKey& key, float viewScale, juce::Point<int> viewOffset)
+{
+    const auto documentArea = getDocumentArea(key);
+    const auto screenArea = juce::Rectangle<int>(key.x * tileSize, key.y * tileSize, tileSize, tileSize) + viewOffset;
+
+    auto isUsable = [&](const TileKey& otherKey, const Tile& tile)
+    {
+        return tile.image.isValid() && !tile.isDirty()
+            && (otherKey.scale != key.scale || otherKey.pixelScale != key.pixelScale)
+            && getDocumentArea(otherKey).intersects(documentArea);
+    };
+
+    // Use the closest zoom level that has clean tiles for this area
+    float bestScale = 0.0f;
+    float bestDistance = std::numeric_limits<float>::max();
+
+    for (auto& [otherKey, tile] : tiles)
+    {
+        if (!isUsable(otherKey, tile))
+            continue;
+
+        const float distance = std::abs(std::log(otherKey.scale / key.scale));
+        if (distance < bestDistance)
+        {
+            bestDistance = distance;
+            bestScale = otherKey.scale;
+        }
+    }
+
+    if (bestScale == 0.0f)
+    {
+        g.setColour(juce::Colour(0xfff4f4f4));
+        g.fillRect(screenArea);
+        return;
+    }
+
+    juce::Graphics::ScopedSaveState stateSave(g);
+    g.reduceClipRegion(screenArea);
+    g.fillAll(juce::Colours::white);
+
+    for (auto& [otherKey, tile] : tiles)
+        if (otherKey.scale == bestScale && isUsable(otherKey, tile))
+            drawTile(g, otherKey, tile.image, viewScale, viewOffset);
+}
+
+void TileCache::cancelJobsForOtherScales(float scale)
+{
+    struct OtherScales : public juce::ThreadPool::JobSelector
+    {
+        explicit OtherScales(float s) : scaleToKeep(s) {}
+
+        bool isJobSuitable(juce::ThreadPoolJob* job) override
+        {
+            return static_cast<RenderJob*>(job)->key.scale != scaleToKeep;
+        }
+
+        float scaleToKeep;
+    };
+
+    // Jobs that are already running finish normally, the rest are dropped
+    OtherScales selector(scale);
+    threadPool.removeAllJobs(false, 0, &selector);
+
+    for (auto& [key, tile] : tiles)
+        if (key.scale != scale)
+            tile.queuedEpoch = 0;
+}
+
+void TileCache::evictTiles()
+{
+    if ((int) tiles.size() <= maxCachedTiles)
+        return;
+
+    // Least recently used first, never anything visible in this frame
+    std::vector<std::pair<juce::int64, TileKey>> candidates;
+    for (auto& [key, tile] : tiles)
+        if (tile.lastUsedFrame != frameCounter && !tile.isQueued())
+            candidates.push_back({ tile.lastUsedFrame, key });
+
+    std::sort(candidates.begin(), candidates.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    for (auto& candidate : candidates)
+    {
+        if ((int) tiles.size() <= maxCachedTiles)
+            break;
+
+        tiles.erase(candidate.second);
+    }
+}
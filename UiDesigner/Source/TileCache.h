@@ -0,0 +1,127 @@
+/*
+  ==============================================================================
+
+    TileCache.h
+    Created: 18 Oct 2026 1:47:26pm
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// TileCache.h
+#pragma once
+#include <JuceHeader.h>
+#include "RenderSource.h"
+
+// Cache of rendered 256 x 256 tiles of the canvas, keyed by zoom level and
+// tile coordinates. The tile grid is fixed in scaled document space, so
+// panning by whole pixels only moves tiles around: cached tiles are blitted
+// and only newly exposed ones need rendering.
+//
+// Tiles are rendered on background threads from a document snapshot. While
+// a new tile is rendering, a scaled tile from another zoom level stands in
+// for it. A tile touched by an edit keeps showing its old image until the
+// new one is in, so an edit never makes the message thread walk the document.
+//
+// Every job is stamped from one counter that only ever goes up, and a result
+// is only taken if it's the tile's current job and newer than the image shown.
+// Results from before clear(), or for tiles that were evicted or had their
+// job cancelled in the meantime, never match a tile again.
+class TileCache
+{
+public:
+    static constexpr int tileSize = 256;
+
+    struct Statistics
+    {
+        int tilesVisible = 0;
+        int tilesStale = 0;          // shown from before an edit until re-rendered
+        int tilesQueued = 0;         // waiting for a background thread
+        int tilesCached = 0;
+    };
+
+    TileCache();
+    ~TileCache();
+
+    // Fills area (component coordinates) with the document as seen through the
+    // view, where screen = document * viewScale + viewOffset
+    void draw(juce::Graphics& g, juce::Rectangle<int> area, float viewScale,
+              juce::Point<int> viewOffset, RenderClient& client);
+
+    // Marks all tiles overlapping the area, given in document coordinates, as stale
+    void invalidate(juce::Rectangle<float> documentArea);
+    void clear();
+
+    // Moves tiles finished by the background threads into the cache. Returns
+    // true if anything arrived, in which case the owner should repaint.
+    bool collectFinishedTiles();
+
+    Statistics getStatistics() const { return stats; }
+
+private:
+    struct TileKey
+    {
+        float scale;
+        float pixelScale;
+        int x;
+        int y;
+
+        bool operator<(const TileKey& other) const
+        {
+            return std::tie(scale, pixelScale, x, y) < std::tie(other.scale, other.pixelScale, other.x, other.y);
+        }
+    };
+
+    // Epochs come from nextEpoch, 0 means none
+    struct Tile
+    {
+        juce::Image image;
+        juce::uint64 imageEpoch = 0;    // of the job that rendered image
+        juce::uint64 editEpoch = 0;     // when the tile was last invalidated
+        juce::uint64 queuedEpoch = 0;   // of the job in flight
+        juce::int64 lastUsedFrame = 0;
+
+        bool isQueued() const { return queuedEpoch != 0; }
+        bool isDirty() const { return imageEpoch < editEpoch; }
+    };
+
+    struct FinishedTile
+    {
+        TileKey key;
+        juce::uint64 epoch;
+        juce::Image image;
+    };
+
+    class RenderJob;
+
+    static constexpr int maxCachedTiles = 256;
+
+    static juce::Rectangle<float> getDocumentArea(const TileKey& key);
+    static juce::Image createTileImage(const TileKey& key);
+    static juce::AffineTransform getTileTransform(const TileKey& key);
+
+    static void drawTile(juce::Graphics& g, const TileKey& key, const juce::Image& image, float viewScale, juce::Point<int> viewOffset);
+    void drawPlaceholder(juce::Graphics& g, const TileKey& key, float viewScale, juce::Point<int> viewOffset);
+    void queueTile(const TileKey& key, Tile& tile, std::shared_ptr<const RenderSource>& snapshot, RenderClient& client);
+    void cancelJobsForOtherScales(float scale);
+    void evictTiles();
+
+    std::map<TileKey, Tile> tiles;
+    juce::uint64 nextEpoch = 1;
+    juce::int64 frameCounter = 0;
+    float lastViewScale = 0.0f;
+    Statistics stats;
+
+    juce::ThreadPool threadPool;
+    juce::CriticalSection finishedLock;
+    std::vector<FinishedTile> finishedTiles;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TileCache)
+};
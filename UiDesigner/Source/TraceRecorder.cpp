@@ -0,0 +1,227 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.cpp
+    Created: 18 Oct 2026 11:02:17am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include "TraceRecorder.h"
+
+// Only the owning thread writes into a buffer, readers check the write
+// counter before and after copying to detect entries that were overwritten.
+// The registry lock guards everything but the events and the counter.
+struct TraceRecorder::ThreadBuffer
+{
+    struct Event
+    {
+        const char* name = nullptr;
+        juce::int64 startTicks = 0;
+        juce::int64 endTicks = 0;
+    };
+
+    static constexpr juce::uint64 capacity = 1 << 14;
+
+    Event events[capacity];
+    std::atomic<juce::uint64> numWritten { 0 };
+    int traceThreadId = 0;
+    juce::String threadName;
+    bool isInUse = true;    // false once the thread has exited
+    ThreadBuffer* next = nullptr;
+};
+
+namespace
+{
+    using ThreadBuffer = TraceRecorder::ThreadBuffer;
+
+    // Buffers live until shutdown. When a thread exits its buffer is handed
+    // to the next new thread, so pool threads coming and going don't add a
+    // buffer each.
+    struct BufferRegistry
+    {
+        ~BufferRegistry()
+        {
+            auto* buffer = head;
+            while (buffer != nullptr)
+            {
+                auto* next = buffer->next;
+                delete buffer;
+                buffer = next;
+            }
+        }
+
+        juce::CriticalSection lock;
+        ThreadBuffer* head = nullptr;
+        int nextThreadId = 1;
+    };
+
+    BufferRegistry& getRegistry()
+    {
+        static BufferRegistry registry;
+        return registry;
+    }
+
+    ThreadBuffer* registerThisThread()
+    {
+        auto& registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+
+        ThreadBuffer* buffer = nullptr;
+
+        for (auto* existing = registry.head; existing != nullptr && buffer == nullptr; existing = existing->next)
+            if (!existing->isInUse)
+                buffer = existing;
+
+        if (buffer == nullptr)
+        {
+            buffer = new ThreadBuffer();
+            buffer->next = registry.head;
+            registry.head = buffer;
+        }
+        else
+        {
+            // The spans of the thread that exited go with it
+            buffer->numWritten.store(0);
+        }
+
+        buffer->isInUse = true;
+        buffer->traceThreadId = registry.nextThreadId++;
+
+        if (juce::MessageManager::existsAndIsCurrentThread())
+            buffer->threadName = "Message thread";
+        else if (auto* thread = juce::Thread::getCurrentThread())
+            buffer->threadName = thread->getThreadName();
+        else
+            buffer->threadName = "Thread " + juce::String(buffer->traceThreadId);
+
+        return buffer;
+    }
+
+    void releaseThisThread(ThreadBuffer& buffer)
+    {
+        auto& registry = getRegistry();
+        const juce::ScopedLock sl(registry.lock);
+        buffer.isInUse = false;
+    }
+
+    // Gives the buffer back when the thread exits
+    struct ThreadRegistration
+    {
+        ~ThreadRegistration()
+        {
+            if (buffer != nullptr)
+                releaseThisThread(*buffer);
+        }
+
+        ThreadBuffer* buffer = nullptr;
+    };
+
+    std::atomic<juce::int64> recordingStartTicks { 0 };
+
+    double ticksToMicroseconds(juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e6;
+    }
+}
+
+std::atomic<bool> TraceRecorder::enabled { false };
+
+TraceRecorder::ThreadBuffer& TraceRecorder::getBufferForThisThread()
+{
+    static thread_local ThreadRegistration registration;
+
+    if (registration.buffer == nullptr)
+        registration.buffer = registerThisThread();
+
+    return *registration.buffer;
+}
+
+void TraceRecorder::setEnabled(bool shouldBeEnabled)
+{
+    if (shouldBeEnabled && !enabled.load())
+        recordingStartTicks = juce::Time::getHighResolutionTicks();
+
+    enabled = shouldBeEnabled;
+}
+
+void TraceRecorder::record(ThreadBuffer& buffer, const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept
+{
+    auto index = buffer.numWritten.load(std::memory_order_relaxed);
+
+    auto& event = buffer.events[index & (ThreadBuffer::capacity - 1)];
+    event.name = name;
+    event.startTicks = startTicks;
+    event.endTicks = endTicks;
+
+    buffer.numWritten.store(index + 1, std::memory_order_release);
+}
+
+juce::String TraceRecorder::createChromeTraceJson()
+{
+    juce::MemoryOutputStream json;
+    json << "{\"traceEvents\":[\n";
+
+    bool first = true;
+    auto writeSeparator = [&]
+    {
+        if (!first)
+            json << ",\n";
+        first = false;
+    };
+
+    auto startTicks = recordingStartTicks.load();
+    juce::Array<ThreadBuffer::Event> events;
+
+    // Keeps buffers from being handed to new threads while they're copied
+    auto& registry = getRegistry();
+    const juce::ScopedLock sl(registry.lock);
+
+    for (auto* buffer = registry.head; buffer != nullptr; buffer = buffer->next)
+    {
+        writeSeparator();
+        json << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->traceThreadId
+             << ",\"args\":{\"name\":" << juce::JSON::toString(buffer->threadName) << "}}";
+
+        auto endIndex = buffer->numWritten.load(std::memory_order_acquire);
+        auto beginIndex = endIndex > ThreadBuffer::capacity ? endIndex - ThreadBuffer::capacity : 0;
+
+        events.clearQuick();
+        for (auto i = beginIndex; i < endIndex; ++i)
+            events.add(buffer->events[i & (ThreadBuffer::capacity - 1)]);
+
+        // Anything the writer lapped while we were copying is unreliable, and
+        // so is the slot it may be writing right now, the one before the oldest
+        auto endIndexAfterCopy = buffer->numWritten.load(std::memory_order_acquire);
+        auto firstValidIndex = endIndexAfterCopy >= ThreadBuffer::capacity ? endIndexAfterCopy - ThreadBuffer::capacity + 1 : 0;
+
+        for (auto i = std::max(beginIndex, firstValidIndex); i < endIndex; ++i)
+        {
+            auto& event = events.getReference((int) (i - beginIndex));
+
+            if (event.startTicks < startTicks)
+                continue;
+
+            writeSeparator();
+            json << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->traceThreadId
+                 << ",\"ts\":" << juce::String(ticksToMicroseconds(event.startTicks - startTicks), 3)
+                 << ",\"dur\":" << juce::String(ticksToMicroseconds(event.endTicks - event.startTicks), 3) << "}";
+        }
+    }
+
+    json << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return json.toString();
+}
+
+bool TraceRecorder::writeChromeTrace(const juce::File& file)
+{
+    return file.replaceWithText(createChromeTraceJson());
+}
@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    TraceRecorder.h
+    Created: 18 Oct 2026 11:02:17am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+// TraceRecorder.h
+#pragma once
+#include <JuceHeader.h>
+
+// Records timed spans into a lock-free ring buffer per thread, which can be
+// dumped as Chrome trace-event JSON (chrome://tracing or ui.perfetto.dev).
+// While recording is off a span costs one relaxed atomic load.
+class TraceRecorder
+{
+public:
+    static void setEnabled(bool shouldBeEnabled);
+    static bool isEnabled() noexcept { return enabled.load(std::memory_order_relaxed); }
+
+    // Builds the JSON for all spans recorded since recording was last enabled.
+    // Spans that get overwritten while the dump is running are dropped.
+    static juce::String createChromeTraceJson();
+    static bool writeChromeTrace(const juce::File& file);
+
+    // One per thread, defined in TraceRecorder.cpp
+    struct ThreadBuffer;
+
+    // Times the enclosing scope. The name must be a string literal, only the
+    // pointer is stored.
+    //
+    // The first span a thread starts while recording registers its buffer,
+    // which locks and may allocate. Recording the span at the end of the
+    // scope never does either.
+    class ScopedSpan
+    {
+    public:
+        explicit ScopedSpan(const char* spanName)
+            : name(spanName),
+              buffer(isEnabled() ? &getBufferForThisThread() : nullptr),
+              startTicks(buffer != nullptr ? juce::Time::getHighResolutionTicks() : 0)
+        {
+        }
+
+        ~ScopedSpan() noexcept
+        {
+            if (buffer != nullptr)
+                record(*buffer, name, startTicks, juce::Time::getHighResolutionTicks());
+        }
+
+    private:
+        const char* name;
+        ThreadBuffer* buffer;
+        juce::int64 startTicks;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedSpan)
+    };
+
+private:
+    static ThreadBuffer& getBufferForThisThread();
+    static void record(ThreadBuffer& buffer, const char* name, juce::int64 startTicks, juce::int64 endTicks) noexcept;
+
+    static std::atomic<bool> enabled;
+};
+
+#define UIDESIGNER_TRACE_SCOPE(name) TraceRecorder::ScopedSpan JUCE_JOIN_MACRO(traceSpan_, __LINE__)(name)
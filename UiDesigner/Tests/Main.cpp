@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 20 Oct 2026 9:41:10am
+    Author:  Martin S
+
+    You may use this code under the terms of the GPL v3 (see
+    www.gnu.org/licenses) or also the licensed attached to this project.
+
+    THIS CODE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+    EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+    DISCLAIMED.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+// Runs the UiDesigner unit tests. They're only compiled with JUCE_UNIT_TESTS,
+// which UiDesignerTests.jucer defines and the plugin project doesn't. The
+// processor and editor are built into the app as plain classes, without a
+// plugin wrapper, so the editor can be opened the way a host would.
+//
+// Returns non-zero if any test failed, so a build can be gated on it. Only
+// the Debug configuration exists, since allocations are only counted there.
+int main(int argc, char* argv[])
+{
+    juce::ignoreUnused(argc, argv);
+
+    // The canvas tests create components, which need the message manager
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTestsInCategory("UiDesigner");
+
+    int numFailures = 0;
+
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        numFailures += runner.getResult(i)->failures;
+
+    return numFailures > 0 ? 1 : 0;
+}